@@ -0,0 +1,174 @@
+#include <math.h>
+#include "ajd_parse.h"
+
+#define IS_DIGIT(c) ((c) >= '0' && (c) <= '9')
+#define IS_BLANK(c) ((c) == ' ' || (c) == '\t' || (c) == '\r' || (c) == '\n')
+
+/* read exactly n digits at *pp, advancing *pp */
+static inline int
+read_digits(const char **pp, const char *e, int n, long *v){
+  const char *p = *pp;
+  long x = 0;
+  if (e - p < n) return 0;
+  while (n--){
+    if (!IS_DIGIT(*p)) return 0;
+    x = x * 10 + (*p++ - '0');
+  }
+  *pp = p;
+  *v = x;
+  return 1;
+}
+
+static inline int
+leap_year(long y){
+  return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+static inline int
+days_in_month(long y, int m){
+  static const int mdays[12] =
+    {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  return (m == 2 && leap_year(y)) ? 29 : mdays[m - 1];
+}
+
+long
+ajd_civil_to_jdn(long year, int month, int day){
+  long a = (14 - month) / 12;
+  long y = year + 4800 - a;
+  long m = month + 12 * a - 3;
+  return day + (153 * m + 2) / 5 + 365 * y +
+    y / 4 - y / 100 + y / 400 - 32045;
+}
+
+void
+ajd_jdn_to_civil(long jdn, long *year, int *month, int *day){
+  long a = jdn + 32044;
+  long b = (4 * a + 3) / 146097;
+  long c = a - 146097 * b / 4;
+  long d = (4 * c + 3) / 1461;
+  long e = c - 1461 * d / 4;
+  long m = (5 * e + 2) / 153;
+  *day = (int)(e - (153 * m + 2) / 5 + 1);
+  *month = (int)(m + 3 - 12 * (m / 10));
+  *year = 100 * b + d - 4800 + m / 10;
+}
+
+int
+ajd_parse(const char *s, size_t len, double *ajd){
+  const char *p = s;
+  const char *e = s + len;
+  long year, month, day;
+  long hour = 0, minute = 0, second = 0;
+  long zh = 0, zm = 0;
+  double frac = 0.0;
+  double secs;
+  int zsign = 0;
+  int extended;
+
+  while (p < e && IS_BLANK(*p)) p++;
+  while (e > p && IS_BLANK(e[-1])) e--;
+  if (p == e) return AJD_PARSE_EMPTY;
+  /* date */
+  if (!read_digits(&p, e, 4, &year)) return AJD_PARSE_DATE;
+  extended = (p < e && *p == '-');
+  if (extended) p++;
+  if (!read_digits(&p, e, 2, &month)) return AJD_PARSE_DATE;
+  if (extended && (p == e || *p++ != '-')) return AJD_PARSE_DATE;
+  if (!read_digits(&p, e, 2, &day)) return AJD_PARSE_DATE;
+  if (month < 1 || month > 12) return AJD_PARSE_DATE;
+  if (day < 1 || day > days_in_month(year, (int)month)) return AJD_PARSE_DATE;
+  /* time */
+  if (p < e){
+    if (*p != 'T' && *p != 't' && *p != ' ') return AJD_PARSE_TRAILING;
+    p++;
+    if (!read_digits(&p, e, 2, &hour)) return AJD_PARSE_TIME;
+    /* a ':' must have its two digits after it */
+    if (p < e && *p == ':'){
+      if (++p == e || !IS_DIGIT(*p)) return AJD_PARSE_TIME;
+    }
+    else if (extended && p < e && IS_DIGIT(*p)) return AJD_PARSE_TIME;
+    if (p < e && IS_DIGIT(*p)){
+      if (!read_digits(&p, e, 2, &minute)) return AJD_PARSE_TIME;
+      if (p < e && *p == ':' && (++p == e || !IS_DIGIT(*p)))
+        return AJD_PARSE_TIME;
+      if (p < e && IS_DIGIT(*p)){
+        if (!read_digits(&p, e, 2, &second)) return AJD_PARSE_TIME;
+        if (p < e && (*p == '.' || *p == ',')){
+          double scale = 0.1;
+          p++;
+          if (p == e || !IS_DIGIT(*p)) return AJD_PARSE_TIME;
+          while (p < e && IS_DIGIT(*p)){
+            frac += (*p++ - '0') * scale;
+            scale *= 0.1;
+          }
+        }
+      }
+    }
+    if (hour > 24 || minute > 59 || second > 60) return AJD_PARSE_TIME;
+    if (hour == 24 && (minute || second || frac > 0.0)) return AJD_PARSE_TIME;
+    /* zone */
+    if (p < e){
+      if (*p == 'Z' || *p == 'z'){
+        p++;
+      }
+      else if (*p == '+' || *p == '-'){
+        zsign = (*p++ == '-') ? -1 : 1;
+        if (!read_digits(&p, e, 2, &zh)) return AJD_PARSE_ZONE;
+        if (p < e && *p == ':'){
+          p++;
+          if (!read_digits(&p, e, 2, &zm)) return AJD_PARSE_ZONE;
+        }
+        else if (p < e && !read_digits(&p, e, 2, &zm)) return AJD_PARSE_ZONE;
+        if (zh > 18 || zm > 59) return AJD_PARSE_ZONE;
+      }
+      if (p != e) return AJD_PARSE_TRAILING;
+    }
+  }
+  secs =
+  hour * 3600.0 + minute * 60.0 + second + frac -
+  zsign * (zh * 3600.0 + zm * 60.0);
+  *ajd =
+  ajd_civil_to_jdn(year, (int)month, (int)day) - 0.5 + secs / 86400.0;
+  return AJD_PARSE_OK;
+}
+
+size_t
+ajd_count_lines(const char *buf, size_t len){
+  const char *p = buf;
+  const char *e = buf + len;
+  size_t n = 0;
+  int blank = 1;
+  for (; p < e; p++){
+    if (*p == '\n'){
+      n += !blank;
+      blank = 1;
+    }
+    else if (!IS_BLANK(*p)) blank = 0;
+  }
+  return n + !blank;
+}
+
+size_t
+ajd_parse_lines(const char *buf, size_t len,
+                double *out, size_t max, size_t *nbad){
+  const char *p = buf;
+  const char *e = buf + len;
+  size_t n = 0;
+  size_t bad = 0;
+  while (p < e && n < max){
+    const char *q = p;
+    int rc;
+    while (q < e && *q != '\n') q++;
+    rc = ajd_parse(p, (size_t)(q - p), &out[n]);
+    if (rc != AJD_PARSE_EMPTY){
+      if (rc != AJD_PARSE_OK){
+        out[n] = NAN;
+        bad++;
+      }
+      n++;
+    }
+    p = q + 1;
+  }
+  if (nbad) *nbad = bad;
+  return n;
+}
@@ -0,0 +1,62 @@
+/*
+ * ajd_parse.h
+ *
+ * Native ISO-8601 timestamp parser yielding
+ * Astronomical Julian Day Numbers as doubles.
+ * No Ruby dependency.
+ *
+ * Accepted forms (leading/trailing blanks ignored):
+ *  yyyy-mm-dd
+ *  yyyy-mm-ddThh:mm[:ss[.fff]][Z|+hh[:mm]|-hh[:mm]]
+ *  yyyymmddThhmm[ss[.fff]][Z|+hh[mm]|-hh[mm]]
+ * A single space may be used in place of 'T'.
+ * Without a zone designator the time is taken as UT.
+ */
+#ifndef CALC_SUN_AJD_PARSE_H
+#define CALC_SUN_AJD_PARSE_H
+
+#include <stddef.h>
+
+/* return codes of ajd_parse() */
+enum {
+  AJD_PARSE_OK,
+  AJD_PARSE_EMPTY,      /* nothing but blanks */
+  AJD_PARSE_DATE,       /* malformed or out of range date */
+  AJD_PARSE_TIME,       /* malformed or out of range time */
+  AJD_PARSE_ZONE,       /* malformed or out of range zone */
+  AJD_PARSE_TRAILING    /* unexpected characters after the timestamp */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Julian Day Number at noon of a proleptic Gregorian date */
+long ajd_civil_to_jdn(long year, int month, int day);
+/* proleptic Gregorian date of a Julian Day Number */
+void ajd_jdn_to_civil(long jdn, long *year, int *month, int *day);
+
+/*
+ * parse len bytes of s into *ajd.
+ * returns AJD_PARSE_OK or one of the error codes above.
+ */
+int ajd_parse(const char *s, size_t len, double *ajd);
+
+/*
+ * parse a newline delimited buffer, one timestamp per line.
+ * Blank lines are skipped, CR before LF is ignored.
+ * At most max values are written to out; lines that fail
+ * to parse are written as NaN and counted in *nbad if given.
+ * returns the number of values written.
+ */
+size_t ajd_parse_lines(const char *buf, size_t len,
+                       double *out, size_t max, size_t *nbad);
+
+/* number of non-blank lines in buf, an upper bound for ajd_parse_lines */
+size_t ajd_count_lines(const char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
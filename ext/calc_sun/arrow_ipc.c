@@ -0,0 +1,406 @@
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arrow_ipc.h"
+
+/* JDN of 1970-01-01 and the ajd of its midnight */
+#define UNIX_JDN 2440588L
+#define UNIX_AJD 2440587.5
+/* values converted a stack chunk at a time */
+#define ARROW_CHUNK 512
+
+/* Message.fbs and Schema.fbs enum values */
+enum { MSG_SCHEMA = 1, MSG_RECORD_BATCH = 3 };
+enum { TYPE_INT = 2, TYPE_FLOAT = 3, TYPE_UTF8 = 5, TYPE_DATE = 8,
+       TYPE_TIMESTAMP = 10 };
+#define METADATA_V5 4
+#define PRECISION_DOUBLE 2
+#define DATE_DAY 0
+#define TIME_MILLISECOND 1
+
+/*
+ * a flatbuffer laid out front to back: every table is
+ * written before the strings, vectors and tables it points
+ * to, so each offset is patched in forward once they are.
+ */
+typedef struct {
+  unsigned char *p;
+  size_t len, cap;
+  int nomem;
+} fb_t;
+
+typedef struct {
+  int size;            /* 0 absent, else 1, 2, 4 or 8 bytes */
+  uint64_t v;          /* offsets are patched in later */
+} fb_slot;
+
+static size_t
+fb_zero(fb_t *b, size_t n){
+  size_t at = b->len;
+  if (b->len + n > b->cap && !b->nomem){
+    size_t cap = b->cap ? 2 * b->cap : 512;
+    unsigned char *p;
+    while (cap < b->len + n) cap *= 2;
+    if (!(p = realloc(b->p, cap)))
+      b->nomem = 1;
+    else{
+      b->p = p;
+      b->cap = cap;
+    }
+  }
+  if (!b->nomem) memset(b->p + at, 0, n);
+  b->len += n;
+  return at;
+}
+
+static void
+fb_align(fb_t *b, size_t a){
+  if (b->len % a) fb_zero(b, a - b->len % a);
+}
+
+/* flatbuffers are little endian whatever the host */
+static void
+fb_put(fb_t *b, size_t at, uint64_t v, int size){
+  int i;
+  if (b->nomem) return;
+  for (i = 0; i < size; i++, v >>= 8)
+    b->p[at + (size_t)i] = (unsigned char)v;
+}
+
+/* points the offset at at to target, which lies past it */
+static void
+fb_off(fb_t *b, size_t at, size_t target){
+  fb_put(b, at, (uint64_t)(target - at), 4);
+}
+
+/* a table of n slots, its vtable just before it */
+static size_t
+fb_table(fb_t *b, int n, const fb_slot *s, size_t *pos){
+  size_t vt, start;
+  int i;
+  fb_align(b, 2);
+  vt = fb_zero(b, 4 + 2 * (size_t)n);
+  fb_align(b, 8);
+  start = fb_zero(b, 4);
+  for (i = 0; i < n; i++){
+    pos[i] = 0;
+    if (!s[i].size) continue;
+    fb_align(b, (size_t)s[i].size);
+    pos[i] = fb_zero(b, (size_t)s[i].size);
+    fb_put(b, pos[i], s[i].v, s[i].size);
+  }
+  fb_put(b, vt, 4 + 2 * (uint64_t)n, 2);
+  fb_put(b, vt + 2, b->len - start, 2);
+  for (i = 0; i < n; i++)
+    fb_put(b, vt + 4 + 2 * (size_t)i, pos[i] ? pos[i] - start : 0, 2);
+  fb_put(b, start, start - vt, 4);
+  return start;
+}
+
+/* a vector of n elements of size bytes each, aligned to align */
+static size_t
+fb_vector(fb_t *b, size_t n, size_t size, size_t align){
+  size_t at;
+  while (b->len % 4 || (b->len + 4) % align) fb_zero(b, 1);
+  at = fb_zero(b, 4 + n * size);
+  fb_put(b, at, n, 4);
+  return at;
+}
+
+static size_t
+fb_string(fb_t *b, const char *s){
+  size_t n = strlen(s), at;
+  fb_align(b, 4);
+  at = fb_zero(b, 4 + n + 1);
+  fb_put(b, at, n, 4);
+  if (!b->nomem) memcpy(b->p + at + 4, s, n);
+  return at;
+}
+
+static int
+host_big_endian(void){
+  const uint16_t one = 1;
+  return *(const unsigned char *)&one == 0;
+}
+
+/* the Message table; *header receives where to point its header */
+static void
+fb_message(fb_t *b, int type, uint64_t body, size_t *header){
+  fb_slot s[4] = {{2, METADATA_V5}, {1, 0}, {4, 0}, {8, 0}};
+  size_t pos[4], msg;
+  s[1].v = (uint64_t)type;
+  s[3].v = body;
+  fb_zero(b, 4);
+  msg = fb_table(b, 4, s, pos);
+  fb_off(b, 0, msg);
+  *header = pos[2];
+}
+
+static int
+put(FILE *f, const void *p, size_t n){
+  errno = 0;
+  if (n && fwrite(p, 1, n, f) != n){
+    if (!errno) errno = EIO;
+    return -1;
+  }
+  return 0;
+}
+
+static int
+put_pad(FILE *f, size_t n){
+  static const unsigned char zeros[8];
+  return put(f, zeros, (8 - n % 8) % 8);
+}
+
+/* the continuation marker, length and metadata, padded to 8 */
+static int
+put_message(FILE *f, fb_t *b){
+  unsigned char pre[8] = {0xff, 0xff, 0xff, 0xff};
+  size_t len = b->len + (8 - b->len % 8) % 8;
+  int i;
+  if (b->nomem){
+    free(b->p);
+    errno = ENOMEM;
+    return -1;
+  }
+  for (i = 0; i < 4; i++) pre[4 + i] = (unsigned char)(len >> (8 * i));
+  i = put(f, pre, 8) || put(f, b->p, b->len) || put_pad(f, b->len) ? -1 : 0;
+  free(b->p);
+  return i;
+}
+
+/* the Type union member of a field, with its tag */
+static size_t
+fb_type(fb_t *b, const arrow_field *fld, int *tag){
+  fb_slot s[2] = {{0, 0}, {0, 0}};
+  size_t pos[2], at;
+  switch (fld->type){
+  case ARROW_FLOAT64:
+    *tag = TYPE_FLOAT;
+    s[0].size = 2;
+    s[0].v = PRECISION_DOUBLE;
+    return fb_table(b, 1, s, pos);
+  case ARROW_INT8:
+    *tag = TYPE_INT;
+    s[0].size = 4;
+    s[0].v = 8;
+    s[1].size = 1;
+    s[1].v = 1;
+    return fb_table(b, 2, s, pos);
+  case ARROW_UTF8:
+    *tag = TYPE_UTF8;
+    return fb_table(b, 0, s, pos);
+  case ARROW_DATE32:
+    *tag = TYPE_DATE;
+    s[0].size = 2;
+    s[0].v = DATE_DAY;
+    return fb_table(b, 1, s, pos);
+  default:
+    *tag = TYPE_TIMESTAMP;
+    s[0].size = 2;
+    s[0].v = TIME_MILLISECOND;
+    s[1].size = fld->timezone ? 4 : 0;
+    at = fb_table(b, 2, s, pos);
+    if (fld->timezone) fb_off(b, pos[1], fb_string(b, fld->timezone));
+    return at;
+  }
+}
+
+int
+arrow_write_schema(FILE *f, const arrow_field *fields, int nfields){
+  fb_t b = {NULL, 0, 0, 0};
+  fb_slot s[2] = {{2, 0}, {4, 0}};
+  size_t header, pos[2], vec;
+  int i;
+  s[0].v = (uint64_t)host_big_endian();
+  fb_message(&b, MSG_SCHEMA, 0, &header);
+  fb_off(&b, header, fb_table(&b, 2, s, pos));
+  vec = fb_vector(&b, (size_t)nfields, 4, 4);
+  fb_off(&b, pos[1], vec);
+  for (i = 0; i < nfields; i++){
+    /* name, nullable, type tag, type, dictionary, children */
+    fb_slot fs[6] = {{4, 0}, {1, 1}, {1, 0}, {4, 0}, {0, 0}, {4, 0}};
+    size_t fpos[6], fld, type;
+    int tag;
+    fld = fb_table(&b, 6, fs, fpos);
+    fb_off(&b, vec + 4 + 4 * (size_t)i, fld);
+    fb_off(&b, fpos[0], fb_string(&b, fields[i].name));
+    type = fb_type(&b, &fields[i], &tag);
+    fb_put(&b, fpos[2], (uint64_t)tag, 1);
+    fb_off(&b, fpos[3], type);
+    fb_off(&b, fpos[5], fb_vector(&b, 0, 4, 4));
+  }
+  return put_message(f, &b);
+}
+
+/* is row i of a column null */
+static int
+is_null(const arrow_field *fld, const void *col, long i){
+  switch (fld->type){
+  case ARROW_INT8:
+    return 0;
+  case ARROW_UTF8:
+    return ((const char *const *)col)[i] == NULL;
+  default:
+    return isnan(((const double *)col)[i]);
+  }
+}
+
+static size_t
+value_bytes(int type){
+  switch (type){
+  case ARROW_INT8: return 1;
+  case ARROW_UTF8:
+  case ARROW_DATE32: return 4;
+  default: return 8;
+  }
+}
+
+typedef struct {
+  long nulls;
+  size_t chars;        /* ARROW_UTF8 data bytes */
+} col_stat;
+
+static int
+put_validity(FILE *f, const arrow_field *fld, const void *col, long n){
+  unsigned char bits[ARROW_CHUNK / 8];
+  long i, k;
+  for (i = 0; i < n; i += ARROW_CHUNK){
+    long m = n - i < ARROW_CHUNK ? n - i : ARROW_CHUNK;
+    memset(bits, 0, sizeof bits);
+    for (k = 0; k < m; k++)
+      if (!is_null(fld, col, i + k)) bits[k / 8] |= (unsigned char)(1 << (k % 8));
+    if (put(f, bits, (size_t)(m + 7) / 8)) return -1;
+  }
+  return put_pad(f, (size_t)(n + 7) / 8);
+}
+
+/* the value buffers of a column, each padded to 8 bytes */
+static int
+put_values(FILE *f, const arrow_field *fld, const void *col, long n){
+  union {
+    int32_t i32[ARROW_CHUNK];
+    int64_t i64[ARROW_CHUNK];
+  } u;
+  long i, k;
+  size_t total = 0;
+  if (fld->type == ARROW_FLOAT64 || fld->type == ARROW_INT8)
+    return put(f, col, (size_t)n * value_bytes(fld->type)) ||
+      put_pad(f, (size_t)n * value_bytes(fld->type));
+  if (fld->type == ARROW_UTF8){
+    const char *const *s = col;
+    for (i = 0; i <= n; i += ARROW_CHUNK){
+      long m = n + 1 - i < ARROW_CHUNK ? n + 1 - i : ARROW_CHUNK;
+      for (k = 0; k < m; k++){
+        u.i32[k] = (int32_t)total;
+        if (i + k < n && s[i + k]) total += strlen(s[i + k]);
+      }
+      if (put(f, u.i32, (size_t)m * 4)) return -1;
+    }
+    if (put_pad(f, (size_t)(n + 1) * 4)) return -1;
+    for (i = 0; i < n; i++)
+      if (s[i] && put(f, s[i], strlen(s[i]))) return -1;
+    return put_pad(f, total);
+  }
+  for (i = 0; i < n; i += ARROW_CHUNK){
+    const double *ajd = (const double *)col + i;
+    long m = n - i < ARROW_CHUNK ? n - i : ARROW_CHUNK;
+    for (k = 0; k < m; k++){
+      if (fld->type == ARROW_DATE32)
+        u.i32[k] = isnan(ajd[k]) ? 0 : (int32_t)((long)floor(ajd[k] + 0.5) - UNIX_JDN);
+      else
+        u.i64[k] = isnan(ajd[k]) ? 0 : llround((ajd[k] - UNIX_AJD) * 86400000.0);
+    }
+    if (put(f, &u, (size_t)m * value_bytes(fld->type))) return -1;
+  }
+  return put_pad(f, (size_t)n * value_bytes(fld->type));
+}
+
+#define PAD8(n) (((n) + 7) & ~(uint64_t)7)
+
+/* the lengths of the buffers of column c, returns how many */
+static int
+buffer_lengths(const arrow_field *fld, const col_stat *st, long n,
+               uint64_t len[3]){
+  len[0] = st->nulls ? ((uint64_t)n + 7) / 8 : 0;
+  if (fld->type != ARROW_UTF8){
+    len[1] = (uint64_t)n * value_bytes(fld->type);
+    return 2;
+  }
+  len[1] = ((uint64_t)n + 1) * 4;
+  len[2] = st->chars;
+  return 3;
+}
+
+static int
+put_body(FILE *f, const arrow_field *fields, int nfields, long nrows,
+         const void *const *cols, const col_stat *st){
+  int c;
+  for (c = 0; c < nfields; c++){
+    if (st[c].nulls && put_validity(f, &fields[c], cols[c], nrows)) return -1;
+    if (put_values(f, &fields[c], cols[c], nrows)) return -1;
+  }
+  return 0;
+}
+
+int
+arrow_write_batch(FILE *f, const arrow_field *fields, int nfields,
+                  long nrows, const void *const *cols){
+  fb_t b = {NULL, 0, 0, 0};
+  fb_slot s[3] = {{8, 0}, {4, 0}, {4, 0}};
+  size_t header, pos[3], nodes, bufs, nb = 0;
+  uint64_t len[3], body = 0;
+  col_stat *st = calloc((size_t)nfields + 1, sizeof *st);
+  long i;
+  int c, k, n, r;
+  if (!st){
+    errno = ENOMEM;
+    return -1;
+  }
+  for (c = 0; c < nfields; c++){
+    for (i = 0; i < nrows; i++){
+      if (is_null(&fields[c], cols[c], i))
+        st[c].nulls++;
+      else if (fields[c].type == ARROW_UTF8)
+        st[c].chars += strlen(((const char *const *)cols[c])[i]);
+    }
+    if (st[c].chars > INT32_MAX){
+      free(st);
+      errno = EOVERFLOW;
+      return -1;
+    }
+    n = buffer_lengths(&fields[c], &st[c], nrows, len);
+    for (k = 0; k < n; k++) body += PAD8(len[k]);
+    nb += (size_t)n;
+  }
+  s[0].v = (uint64_t)nrows;
+  fb_message(&b, MSG_RECORD_BATCH, body, &header);
+  fb_off(&b, header, fb_table(&b, 3, s, pos));
+  nodes = fb_vector(&b, (size_t)nfields, 16, 8);
+  fb_off(&b, pos[1], nodes);
+  bufs = fb_vector(&b, nb, 16, 8);
+  fb_off(&b, pos[2], bufs);
+  /* FieldNode {length, null_count}, Buffer {offset, length} */
+  for (c = 0, nb = 0, body = 0; c < nfields; c++){
+    fb_put(&b, nodes + 4 + 16 * (size_t)c, (uint64_t)nrows, 8);
+    fb_put(&b, nodes + 12 + 16 * (size_t)c, (uint64_t)st[c].nulls, 8);
+    n = buffer_lengths(&fields[c], &st[c], nrows, len);
+    for (k = 0; k < n; k++, nb++){
+      fb_put(&b, bufs + 4 + 16 * nb, body, 8);
+      fb_put(&b, bufs + 12 + 16 * nb, len[k], 8);
+      body += PAD8(len[k]);
+    }
+  }
+  r = put_message(f, &b) || put_body(f, fields, nfields, nrows, cols, st) ? -1 : 0;
+  free(st);
+  return r;
+}
+
+int
+arrow_write_end(FILE *f){
+  static const unsigned char eos[8] = {0xff, 0xff, 0xff, 0xff, 0, 0, 0, 0};
+  return put(f, eos, 8);
+}
@@ -0,0 +1,58 @@
+/*
+ * arrow_ipc.h
+ *
+ * Writes Apache Arrow IPC streams (columnar format 1.0,
+ * metadata V5) of flat tables: one schema message, record
+ * batches, and the end of stream marker. Values are in the
+ * host's byte order, which the schema records.
+ * Self-contained, the flatbuffers metadata is laid out by
+ * hand. No Ruby dependency.
+ *
+ * Columns are handed over as the arrays the rest of the
+ * library computes: doubles, ajds for times and dates,
+ * signed chars and C strings. NaN ajds and doubles are
+ * written as nulls.
+ */
+#ifndef CALC_SUN_ARROW_IPC_H
+#define CALC_SUN_ARROW_IPC_H
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+  ARROW_FLOAT64,       /* const double *, NaN null */
+  ARROW_INT8,          /* const signed char * */
+  ARROW_UTF8,          /* const char *const *, NULL null */
+  ARROW_DATE32,        /* const double * ajds, their UT civil date */
+  ARROW_TIMESTAMP      /* const double * ajds, milliseconds */
+};
+
+typedef struct {
+  const char *name;
+  int type;            /* ARROW_ above */
+  /*
+   * ARROW_TIMESTAMP: "UTC" or a zone name for instants,
+   * NULL for wall clock times read as ajds of no zone
+   */
+  const char *timezone;
+} arrow_field;
+
+/* the schema message. returns 0, or -1 with errno set */
+int arrow_write_schema(FILE *f, const arrow_field *fields, int nfields);
+/*
+ * one record batch of nrows rows, cols[i] the array of
+ * fields[i]. returns 0, or -1 with errno set.
+ */
+int arrow_write_batch(FILE *f, const arrow_field *fields, int nfields,
+                      long nrows, const void *const *cols);
+/* the end of stream marker. returns 0, or -1 with errno set */
+int arrow_write_end(FILE *f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,206 @@
+/*
+ * arrow_rb.h
+ *
+ * Ruby glue for CalcSun#alt_az_arrow and #rise_set_arrow,
+ * which compute a series in record batches and write them
+ * as an Apache Arrow IPC stream, outside the GVL.
+ * Included by calc_sun.c after select_engine() and
+ * precompute_rb.h.
+ */
+#ifndef CALC_SUN_ARROW_RB_H
+#define CALC_SUN_ARROW_RB_H
+
+#include <ruby/thread.h>
+#include "arrow_ipc.h"
+
+/* rows per record batch unless given */
+#define ARROW_RB_ROWS 65536
+
+typedef struct {
+  FILE *f;
+  int engine, daily;
+  double d0, step, lat, lon;
+  long count, rows;
+  long done;           /* rows written, arrow_nogvl() goes on from there */
+  int begun, r, err;
+  volatile int stop;   /* set by arrow_ubf() */
+} arrow_job;
+
+static const arrow_field alt_az_fields[] = {
+  {"time", ARROW_TIMESTAMP, "UTC"},
+  {"altitude", ARROW_FLOAT64, NULL},
+  {"azimuth", ARROW_FLOAT64, NULL},
+  {"status", ARROW_INT8, NULL}
+};
+
+static const arrow_field rise_set_fields[] = {
+  {"date", ARROW_DATE32, NULL},
+  {"rise", ARROW_TIMESTAMP, "UTC"},
+  {"transit", ARROW_TIMESTAMP, "UTC"},
+  {"set", ARROW_TIMESTAMP, "UTC"},
+  {"status", ARROW_INT8, NULL}
+};
+
+/* 0 day, 1 civil, 2 nautical, 3 astronomical twilight, 4 night */
+static signed char
+sky_status(double alt){
+  return alt >= -0.8333 ? 0 : alt >= -6.0 ? 1 : alt >= -12.0 ? 2 :
+    alt >= -18.0 ? 3 : 4;
+}
+
+static void
+arrow_ubf(void *arg){
+  ((arrow_job *)arg)->stop = 1;
+}
+
+static void *
+arrow_nogvl(void *arg){
+  arrow_job *j = arg;
+  long rows = j->rows < j->count ? j->rows : j->count, i, k;
+  int nfields = j->daily ? 5 : 4;
+  const arrow_field *fields = j->daily ? rise_set_fields : alt_az_fields;
+  double *d = malloc((7 * (size_t)rows + 1) * sizeof *d);
+  double *lat = d + rows, *lon = lat + rows, *v = lon + rows, *ajd = v + 3 * rows;
+  signed char *st = malloc((size_t)rows + 1);
+  const void *cols[5];
+  if (!d || !st){
+    j->r = -1;
+    j->err = ENOMEM;
+    free(d);
+    free(st);
+    return NULL;
+  }
+  cols[0] = ajd;
+  cols[1] = v;
+  cols[2] = v + rows;
+  cols[3] = j->daily ? (const void *)(v + 2 * rows) : st;
+  cols[4] = st;
+  if (!j->begun){
+    j->begun = 1;
+    j->r = arrow_write_schema(j->f, fields, nfields);
+  }
+  for (; j->done < j->count && !j->r && !j->stop; j->done += rows){
+    long m = j->count - j->done < rows ? j->count - j->done : rows;
+    i = j->done;
+    for (k = 0; k < m; k++){
+      d[k] = j->daily ? j->d0 + (double)(i + k) : j->d0 + (double)(i + k) * j->step;
+      lat[k] = j->lat;
+      lon[k] = j->lon;
+      ajd[k] = d[k] + DJ00;
+    }
+    if (j->daily){
+      /* status 0 rises and sets, 1 stays up, 2 stays down */
+      j->r = engine_rise_set_status(j->engine, (size_t)m, d, lat, lon, v,
+                                    v + rows, v + 2 * rows, st);
+    }
+    else{
+      j->r = engine_alt_az(j->engine, (size_t)m, d, lat, lon, v, v + rows);
+      for (k = 0; k < m && !j->r; k++) st[k] = sky_status(v[k]);
+    }
+    if (!j->r) j->r = arrow_write_batch(j->f, fields, nfields, m, cols);
+  }
+  if (!j->r && !j->stop) j->r = arrow_write_end(j->f);
+  if (j->r) j->err = errno;
+  free(d);
+  free(st);
+  return NULL;
+}
+
+static VALUE
+arrow_check_ints(VALUE unused){
+  rb_thread_check_ints();
+  return Qnil;
+}
+
+/* writes j to path without the GVL, returns the rows written */
+static VALUE
+arrow_run(VALUE vpath, arrow_job *j, VALUE vrows){
+  FILE *f;
+  int state;
+  j->rows = NIL_P(vrows) ? ARROW_RB_ROWS : NUM2LONG(vrows);
+  if (j->rows < 1) rb_raise(rb_eArgError, "rows must be positive");
+  vpath = rb_get_path(vpath);
+  if (!(f = fopen(RSTRING_PTR(vpath), "wb"))) rb_sys_fail_str(vpath);
+  j->f = f;
+  for (;;){
+    rb_thread_call_without_gvl(arrow_nogvl, j, arrow_ubf, j);
+    if (!j->stop) break;
+    /* a signal handled by a trap goes on where it stopped */
+    rb_protect(arrow_check_ints, Qnil, &state);
+    if (state){
+      fclose(f);
+      rb_jump_tag(state);
+    }
+    j->stop = 0;
+  }
+  if (fclose(f) != 0 && !j->r){
+    j->r = -1;
+    j->err = errno;
+  }
+  if (j->r) rb_syserr_fail_str(j->err, vpath);
+  return LONG2NUM(j->count);
+}
+/*
+ * call-seq:
+ *  alt_az_arrow(path, ajd, step, count, lat, lon, degrees,
+ *               rows = 65536)
+ *
+ * writes the position of the Sun at count times from ajd,
+ * step days apart, at local Latitude and Longitude as an
+ * Apache Arrow IPC stream to path, in record batches of
+ * rows rows, from the engine alt_az_within(..., degrees)
+ * picks. columns are time (timestamp[ms], UTC), altitude
+ * and azimuth (float64, degrees, no refraction) and status
+ * (int8): 0 day, 1 civil, 2 nautical and 3 astronomical
+ * twilight, 4 night.
+ * returns the number of rows written.
+ *
+ */
+static VALUE func_alt_az_arrow(int argc, VALUE *argv, VALUE self){
+  VALUE vpath, vajd, vstep, vcount, vlat, vlon, vdeg, vrows;
+  arrow_job j;
+  rb_scan_args(argc, argv, "71", &vpath, &vajd, &vstep, &vcount, &vlat,
+               &vlon, &vdeg, &vrows);
+  memset(&j, 0, sizeof j);
+  j.engine = select_engine(ENGINE_POSITION, vdeg)->engine;
+  j.d0 = get_days(vajd);
+  j.step = NUM2DBL(vstep);
+  j.count = NUM2LONG(vcount);
+  j.lat = NUM2DBL(vlat);
+  j.lon = NUM2DBL(vlon);
+  if (j.count < 0) rb_raise(rb_eArgError, "negative count");
+  return arrow_run(vpath, &j, vrows);
+}
+/*
+ * call-seq:
+ *  rise_set_arrow(path, ajds, lat, lon, seconds, rows = 65536)
+ *
+ * given a Range of Astronomical Julian Day Numbers, writes
+ * rise, transit and set for each of its days at local
+ * Latitude and Longitude as an Apache Arrow IPC stream to
+ * path, in record batches of rows rows, from the engine
+ * rise_set_within(..., seconds) picks. columns are date
+ * (date32), rise, transit and set (timestamp[ms], UTC,
+ * rise and set null where the Sun does not rise or set,
+ * transit given every day) and status (int8): 0 rises
+ * and sets, 1 stays up, 2 stays down.
+ * returns the number of rows written.
+ *
+ */
+static VALUE func_rise_set_arrow(int argc, VALUE *argv, VALUE self){
+  VALUE vpath, vrange, vlat, vlon, vsec, vrows;
+  arrow_job j;
+  long day0, day1;
+  rb_scan_args(argc, argv, "51", &vpath, &vrange, &vlat, &vlon, &vsec, &vrows);
+  memset(&j, 0, sizeof j);
+  j.engine = select_engine(ENGINE_RISE_SET, vsec)->engine;
+  get_day_range(vrange, &day0, &day1);
+  j.daily = 1;
+  j.d0 = (double)day0;
+  j.count = day1 - day0 + 1;
+  j.lat = NUM2DBL(vlat);
+  j.lon = NUM2DBL(vlon);
+  return arrow_run(vpath, &j, vrows);
+}
+
+#endif
@@ -0,0 +1,171 @@
+/*
+ * buffer_rb.h
+ *
+ * Ruby glue for CalcSun::Buffer, a read only table of
+ * doubles in one native block, rows of one quantity each.
+ * It exports itself through Ruby's MemoryView protocol,
+ * format "d", two dimensions [rows, samples], so Fiddle,
+ * Numo::NArray and other extensions read the columns in
+ * place, no Float made per sample. Included by calc_sun.c.
+ */
+#ifndef CALC_SUN_BUFFER_RB_H
+#define CALC_SUN_BUFFER_RB_H
+
+#ifdef HAVE_RUBY_MEMORY_VIEW_H
+# include <ruby/memory_view.h>
+#endif
+
+typedef struct {
+  ssize_t shape[2];
+  ssize_t strides[2];
+  double data[1];
+} calc_buffer;
+
+static VALUE cBuffer;
+
+static size_t
+buffer_memsize(const void *p){
+  const calc_buffer *b = p;
+  return p ? sizeof *b + (size_t)(b->shape[0] * b->shape[1]) * sizeof(double) : 0;
+}
+
+static const rb_data_type_t buffer_type = {
+  "CalcSun::Buffer",
+  {0, RUBY_TYPED_DEFAULT_FREE, buffer_memsize,},
+  0, 0,
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+  RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_FROZEN_SHAREABLE,
+#else
+  RUBY_TYPED_FREE_IMMEDIATELY,
+#endif
+};
+
+static const calc_buffer *
+get_buffer(VALUE vbuf){
+  return rb_check_typeddata(vbuf, &buffer_type);
+}
+/* a rows by n buffer; *data is row major, row r at r * n */
+static VALUE
+buffer_new(long rows, long n, double **data){
+  calc_buffer *b = ruby_xmalloc(sizeof *b + (size_t)(rows * n) * sizeof(double));
+  b->shape[0] = rows;
+  b->shape[1] = n;
+  b->strides[0] = n * (ssize_t)sizeof(double);
+  b->strides[1] = sizeof(double);
+  *data = b->data;
+  return rb_obj_freeze(TypedData_Wrap_Struct(cBuffer, &buffer_type, b));
+}
+
+#ifdef HAVE_RUBY_MEMORY_VIEW_H
+static bool
+buffer_get_view(VALUE obj, rb_memory_view_t *view, int flags){
+  const calc_buffer *b = get_buffer(obj);
+  if (flags & RUBY_MEMORY_VIEW_WRITABLE) return false;
+  view->obj = obj;
+  view->data = (void *)b->data;
+  view->byte_size = b->shape[0] * b->strides[0];
+  view->readonly = true;
+  view->format = "d";
+  view->item_size = sizeof(double);
+  view->item_desc.components = NULL;
+  view->item_desc.length = 0;
+  view->ndim = 2;
+  view->shape = b->shape;
+  view->strides = b->strides;
+  view->sub_offsets = NULL;
+  view->private_data = NULL;
+  return true;
+}
+
+static bool
+buffer_release_view(VALUE obj, rb_memory_view_t *view){
+  return true;
+}
+
+static bool
+buffer_view_available_p(VALUE obj){
+  return true;
+}
+
+static const rb_memory_view_entry_t buffer_view_entry = {
+  buffer_get_view,
+  buffer_release_view,
+  buffer_view_available_p,
+};
+#endif
+/*
+ * call-seq:
+ *  shape
+ *
+ * [rows, samples].
+ *
+ */
+static VALUE buffer_shape(VALUE self){
+  const calc_buffer *b = get_buffer(self);
+  return rb_assoc_new(SSIZET2NUM(b->shape[0]), SSIZET2NUM(b->shape[1]));
+}
+/*
+ * call-seq:
+ *  bytesize
+ *
+ * the size of the native block in bytes.
+ *
+ */
+static VALUE buffer_bytesize(VALUE self){
+  const calc_buffer *b = get_buffer(self);
+  return SSIZET2NUM(b->shape[0] * b->strides[0]);
+}
+/*
+ * call-seq:
+ *  [](row, i)
+ *
+ * sample i of row as a Float, NaN where the row's method
+ * would give nil.
+ *
+ */
+static VALUE buffer_aref(VALUE self, VALUE vrow, VALUE vi){
+  const calc_buffer *b = get_buffer(self);
+  long r = NUM2LONG(vrow), i = NUM2LONG(vi);
+  if (r < 0) r += b->shape[0];
+  if (i < 0) i += b->shape[1];
+  if (r < 0 || r >= b->shape[0] || i < 0 || i >= b->shape[1])
+    rb_raise(rb_eIndexError, "index [%ld, %ld] outside %ldx%ld",
+             NUM2LONG(vrow), NUM2LONG(vi), (long)b->shape[0], (long)b->shape[1]);
+  return DBL2NUM(b->data[r * b->shape[1] + i]);
+}
+/*
+ * call-seq:
+ *  to_a
+ *
+ * the rows as Arrays of Floats, nil for NaN, as the
+ * Array form of the method that made the buffer.
+ *
+ */
+static VALUE buffer_to_a(VALUE self){
+  const calc_buffer *b = get_buffer(self);
+  VALUE vrows = rb_ary_new2(b->shape[0]);
+  long r, i;
+  for (r = 0; r < b->shape[0]; r++){
+    const double *row = b->data + r * b->shape[1];
+    VALUE vrow = rb_ary_new2(b->shape[1]);
+    for (i = 0; i < b->shape[1]; i++)
+      rb_ary_push(vrow, isnan(row[i]) ? Qnil : DBL2NUM(row[i]));
+    rb_ary_push(vrows, vrow);
+  }
+  return vrows;
+}
+
+static void
+init_buffer(VALUE cCalcSun){
+  cBuffer = rb_define_class_under(cCalcSun, "Buffer", rb_cObject);
+  rb_undef_alloc_func(cBuffer);
+#ifdef HAVE_RUBY_MEMORY_VIEW_H
+  rb_memory_view_register(cBuffer, &buffer_view_entry);
+#endif
+  rb_define_method(cBuffer, "[]", buffer_aref, 2);
+  rb_define_method(cBuffer, "bytesize", buffer_bytesize, 0);
+  rb_define_method(cBuffer, "shape", buffer_shape, 0);
+  rb_define_method(cBuffer, "to_a", buffer_to_a, 0);
+}
+
+#endif
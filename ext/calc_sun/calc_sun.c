@@ -1,42 +1,234 @@
 #include <ruby.h>
+#ifdef HAVE_RUBY_RACTOR_H
+# include <ruby/ractor.h>
+#endif
 #include <math.h>
 #include <time.h>
 #include "spa.h"
-/* if PI's not defined, define it */
-#ifndef PI
-#define PI 3.1415926535897932384626433832795028841971L
-#endif
+#include "ajd_parse.h"
+#include "delta_t.h"
+#include "sidereal.h"
+#include "solar.h"
+#include "solar_f32.h"
+#include "solar_f64.h"
+#include "fast_trig.h"
+#include "spa_geo.h"
+#include "spa_rts.h"
+#include "sunriset.h"
+#include "engine.h"
 #ifndef DBL2NUM
 # define DBL2NUM(dbl) rb_float_new(dbl)
 #endif
-# define PI2 PI * 2.0
-# define R2D 57.295779513082320876798154814105L
-# define D2R 0.017453292519943295769236907684886L
-# define M2PI M_PI * 2.0
-# define INV24 1.0 / 24.0
-# define INV360 1.0 / 360.0
-# define DJ00 2451545.0L
-# define RND12 1000000000000.0L
-/* macro for normalizing
-* angles into 0-2pie range
+/* two part Julian Day,
+* ajd = jd + fr kept apart so
+* days from J2000 keep full precision
+*/
+typedef struct {
+  double jd;
+  double fr;
+} jd2_t;
+
+static ID id_ajd;
+/* Unix epoch to two part Julian Day */
+static jd2_t
+jd2_from_epoch(long long sec, long nsec){
+  jd2_t j;
+  long long n = sec + 43200;
+  long long q = n / 86400;
+  long long r = n % 86400;
+  if (r < 0){
+    r += 86400;
+    q--;
+  }
+  j.jd = 2440587.0 + (double)q;
+  j.fr = (r + nsec * 1e-9) / 86400.0;
+  return j;
+}
+/* read an ajd argument given as
+* Float or Integer ajd, [jd, day_fraction],
+* Time, or Date/DateTime
 */
+static jd2_t
+get_jd2(VALUE vajd){
+  jd2_t j;
+  switch (TYPE(vajd)){
+  case T_FLOAT:
+  case T_FIXNUM:
+  case T_BIGNUM:
+    break;
+  case T_ARRAY:
+    if (RARRAY_LEN(vajd) != 2)
+      rb_raise(rb_eArgError, "expected [jd, day_fraction]");
+    j.jd = NUM2DBL(rb_ary_entry(vajd, 0));
+    j.fr = NUM2DBL(rb_ary_entry(vajd, 1));
+    return j;
+  default:
+    if (rb_obj_is_kind_of(vajd, rb_cTime)){
+      struct timespec ts = rb_time_timespec(vajd);
+      return jd2_from_epoch((long long)ts.tv_sec, ts.tv_nsec);
+    }
+    if (rb_respond_to(vajd, id_ajd))
+      vajd = rb_funcall(vajd, id_ajd, 0);
+  }
+  j.jd = NUM2DBL(vajd);
+  j.fr = 0.0;
+  return j;
+}
+/* ajd of any accepted argument */
+static inline double
+get_ajd(VALUE vajd){
+  jd2_t j = get_jd2(vajd);
+  return j.jd + j.fr;
+}
+/* days from J2000 of any accepted argument */
 static inline double
-anp(double angle){
-  double w = fmod(angle, M2PI);
-  if (w < 0) w += M2PI;
-  return w;
+get_days(VALUE vajd){
+  jd2_t j = get_jd2(vajd);
+  return (j.jd - DJ00) + j.fr;
 }
+/* batch sidereal glue reads ajds like every other method */
+#define SIDEREAL_RB_DAYS(v) get_days(v)
+#include "sidereal_rb.h"
+
+static ID id_precision;
+static VALUE sym_raw, sym_round12, sym_legacy, sym_full;
+static VALUE sym_position, sym_rise_set;
+static VALUE sym_rising, sym_setting;
+/* precision mode from its Symbol */
+static int
+prec_mode(VALUE vprec){
+  if (vprec == sym_legacy || NIL_P(vprec)) return SOLAR_LEGACY;
+  if (vprec == sym_raw) return SOLAR_RAW;
+  if (vprec == sym_round12) return SOLAR_ROUND12;
+  rb_raise(rb_eArgError, "precision must be :raw, :round12 or :legacy");
+  return SOLAR_LEGACY;
+}
+/* precision mode of a CalcSun instance */
+static inline int
+get_mode(VALUE self){
+  return prec_mode(rb_attr_get(self, id_precision));
+}
+/* Float of v rounded as the precision mode asks */
+static inline VALUE
+prec_num(double v, int mode){
+  if (mode == SOLAR_ROUND12) v = solar_round12(v);
+  return DBL2NUM(v);
+}
+/* fills n doubles from an Array of length n or one Numeric */
+static void
+fill_f64(double *dst, VALUE v, long n, const char *what){
+  long i;
+  if (RB_TYPE_P(v, T_ARRAY)){
+    if (RARRAY_LEN(v) != n)
+      rb_raise(rb_eArgError, "%s differ in length", what);
+    for (i = 0; i < n; i++)
+      dst[i] = NUM2DBL(rb_ary_entry(v, i));
+  }
+  else{
+    double f = NUM2DBL(v);
+    for (i = 0; i < n; i++)
+      dst[i] = f;
+  }
+}
+/* ENGINE_POSITION or ENGINE_RISE_SET for a Symbol */
+static int
+get_quantity(VALUE vq){
+  if (vq == sym_position) return ENGINE_POSITION;
+  if (vq == sym_rise_set) return ENGINE_RISE_SET;
+  rb_raise(rb_eArgError, "quantity must be :position or :rise_set");
+  return -1;
+}
+/* the cheapest engine for quantity within tolerance, or raises */
+static const engine_entry *
+select_engine(int quantity, VALUE vtol){
+  double tol = NUM2DBL(vtol);
+  const engine_entry *e = engine_select(quantity, tol);
+  if (!e)
+    rb_raise(rb_eArgError, "no engine within %g %s", tol,
+             quantity == ENGINE_POSITION ? "degrees" : "seconds");
+  return e;
+}
+/* first and last day (floor(d)) of a Range of ajds */
+static void
+get_day_range(VALUE vrange, long *day0, long *day1){
+  VALUE vbeg, vend;
+  int excl;
+  double dend;
+  if (!rb_range_values(vrange, &vbeg, &vend, &excl))
+    rb_raise(rb_eTypeError, "ajds must be a Range");
+  *day0 = (long)floor(get_days(vbeg));
+  dend = get_days(vend);
+  *day1 = (long)floor(dend);
+  if (excl && dend == (double)*day1) (*day1)--;
+  if (*day1 < *day0) rb_raise(rb_eArgError, "empty range of ajds");
+}
+/* CalcSun::Zone reads ajds and precision like the rest */
+#include "zone_rb.h"
+/* CalcSun::RiseSurface */
+#include "surface_rb.h"
+/* CalcSun::Buffer, batch results for MemoryView */
+#include "buffer_rb.h"
+/* CalcSun::SharedCache, rise and set across processes */
+#include "shm_rb.h"
+/* CalcSun::ProfileStore, yearly profiles in a mapped file */
+#include "profile_rb.h"
+/* CalcSun#precompute_async and CalcSun::Precompute */
+#include "precompute_rb.h"
+/* the *_batch methods, inputs read in place */
+#include "column_rb.h"
+/* the *_arrow methods, Arrow IPC streams */
+#include "arrow_rb.h"
+/* sun_intervals, spans above an altitude */
+#include "window_rb.h"
+/* times of an azimuth, an altitude, the peak */
+#include "inverse_rb.h"
 
 /*
  * call-seq:
- *  initialize()
+ *  initialize(precision = :legacy)
  *
  * Create CalcSun class instance Ruby object.
  *
+ * precision selects how results are rounded:
+ * :raw gives unrounded doubles and is fastest,
+ * :round12 rounds final results to 12 decimal places
+ * in double precision and
+ * :legacy rounds every step of the chain through
+ * single precision as earlier versions did.
+ * Only :legacy rounds inside the chain.
+ *
  */
-static VALUE t_init(VALUE self){
+static VALUE t_init(int argc, VALUE *argv, VALUE self){
+  VALUE vprec;
+  rb_scan_args(argc, argv, "01", &vprec);
+  if (NIL_P(vprec)) vprec = sym_legacy;
+  prec_mode(vprec);
+  rb_ivar_set(self, id_precision, vprec);
   return self;
 }
+/*
+ * call-seq:
+ *  precision
+ *
+ * returns the precision mode Symbol.
+ *
+ */
+static VALUE func_get_precision(VALUE self){
+  VALUE vprec = rb_attr_get(self, id_precision);
+  return NIL_P(vprec) ? sym_legacy : vprec;
+}
+/*
+ * call-seq:
+ *  precision = :raw, :round12 or :legacy
+ *
+ * set the precision mode.
+ *
+ */
+static VALUE func_set_precision(VALUE self, VALUE vprec){
+  prec_mode(vprec);
+  rb_ivar_set(self, id_precision, vprec);
+  return vprec;
+}
 /*
  * call-seq:
  *  set_datetime('yyyy-mm-ddT00:00:00+/-zoneoffset')
@@ -64,7 +256,7 @@ static VALUE func_set_datetime(VALUE self, VALUE vdatetime){
  */
 static VALUE func_ajd_2_datetime(VALUE self, VALUE vajd){
   VALUE cDateTime = rb_const_get(rb_cObject, rb_intern("DateTime"));
-  double ajd = NUM2DBL(vajd) + 0.5;
+  double ajd = get_ajd(vajd) + 0.5;
   VALUE vfajd = DBL2NUM(ajd);
   VALUE vdatetime = rb_funcall(cDateTime, rb_intern("jd"), 1, vfajd);
   return vdatetime;
@@ -73,26 +265,171 @@ static VALUE func_ajd_2_datetime(VALUE self, VALUE vajd){
  * call-seq:
  *  ajd(date)
  *
- * given Date or DateTime object
+ * given Date, DateTime or Time object
  * convert  to Astronomical Julian Day Number.
  *
  */
 static VALUE func_get_ajd(VALUE self, VALUE vdatetime){
-  double ajd = NUM2DBL(rb_funcall(vdatetime, rb_intern("ajd"), 0));
+  double ajd = get_ajd(vdatetime);
   return DBL2NUM(ajd);
 }
 /*
  * call-seq:
  *  jd(date)
  *
- * given Date or DateTime object
+ * given Date, DateTime or Time object
  * convert to JD number.
  *
  */
 static VALUE func_get_jd(VALUE self, VALUE vdatetime){
-  double jd = NUM2DBL(rb_funcall(vdatetime, rb_intern("jd"), 0));
+  double jd;
+  if (rb_obj_is_kind_of(vdatetime, rb_cTime))
+    jd = floor(get_ajd(vdatetime) + 0.5);
+  else
+    jd = NUM2DBL(rb_funcall(vdatetime, rb_intern("jd"), 0));
   return DBL2NUM(jd);
 }
+/*
+ * call-seq:
+ *  epoch2jd(seconds)
+ *
+ * given seconds since the Unix epoch
+ * returns a two part Julian Day [jd, day_fraction]
+ * that every method taking an ajd accepts
+ * in place of a Float.
+ * The split keeps sub-millisecond precision.
+ *
+ */
+static VALUE func_epoch_2_jd(VALUE self, VALUE vsec){
+  jd2_t j;
+  if (FIXNUM_P(vsec) || RB_TYPE_P(vsec, T_BIGNUM)){
+    j = jd2_from_epoch(NUM2LL(vsec), 0);
+  }
+  else{
+    double sec = NUM2DBL(vsec);
+    double whole = floor(sec);
+    j = jd2_from_epoch((long long)whole, (long)((sec - whole) * 1e9));
+  }
+  return rb_assoc_new(DBL2NUM(j.jd), DBL2NUM(j.fr));
+}
+/*
+ * call-seq:
+ *  delta_t(ajd)
+ * or
+ *  delta_t([ajd, ...])
+ *
+ * given an Astronomical Julian Day Number (UT),
+ * returns Delta T (TT - UT1) in seconds, from a loaded
+ * IERS table where it covers ajd and the built in
+ * model otherwise. An Array gives an Array.
+ *
+ */
+static VALUE func_delta_t(VALUE self, VALUE vajd){
+  long i, n;
+  double *ajd;
+  VALUE vtmp, vary;
+  if (!RB_TYPE_P(vajd, T_ARRAY))
+    return DBL2NUM(delta_t_ajd(get_ajd(vajd)));
+  n = RARRAY_LEN(vajd);
+  ajd = ALLOCV_N(double, vtmp, 2 * n + 1);
+  for (i = 0; i < n; i++)
+    ajd[i] = get_ajd(rb_ary_entry(vajd, i));
+  delta_t_batch(ajd, ajd + n, (size_t)n);
+  vary = rb_ary_new2(n);
+  for (i = 0; i < n; i++)
+    rb_ary_push(vary, DBL2NUM(ajd[n + i]));
+  ALLOCV_END(vtmp);
+  return vary;
+}
+/*
+ * call-seq:
+ *  dut1(ajd)
+ *
+ * given an Astronomical Julian Day Number (UTC),
+ * returns UT1 - UTC in seconds from a loaded IERS table,
+ * 0.0 where none covers ajd.
+ *
+ */
+static VALUE func_dut1(VALUE self, VALUE vajd){
+  return DBL2NUM(delta_t_dut1(get_ajd(vajd)));
+}
+/*
+ * call-seq:
+ *  CalcSun.load_iers(path)
+ *
+ * loads daily UT1 - UTC from an IERS finals file
+ * (finals2000A.all and the like) for delta_t and dut1.
+ * the one table serves every Ractor.
+ * returns the number of days loaded.
+ *
+ */
+static VALUE func_load_iers(VALUE klass, VALUE vpath){
+  const char *path;
+  long n;
+  FilePathValue(vpath);
+  path = StringValueCStr(vpath);
+  n = delta_t_load_iers(path);
+  if (n < 0) rb_sys_fail(path);
+  if (n == 0) rb_raise(rb_eArgError, "no UT1-UTC values in %s", path);
+  return LONG2NUM(n);
+}
+/*
+ * call-seq:
+ *  CalcSun.unload_iers
+ *
+ * drops a loaded IERS table, delta_t falls back to the
+ * built in model and dut1 to 0.0.
+ *
+ */
+static VALUE func_unload_iers(VALUE klass){
+  delta_t_unload_iers();
+  return Qnil;
+}
+/*
+ * call-seq:
+ *  parse_ajd('yyyy-mm-ddThh:mm:ss+/-zoneoffset')
+ * or
+ *  parse_ajd('20010203T040506+0700')
+ *
+ * given an ISO-8601 date time string
+ * convert to Astronomical Julian Day Number
+ * without creating a DateTime object.
+ * Raises ArgumentError on malformed input.
+ *
+ */
+static VALUE func_parse_ajd(VALUE self, VALUE vstr){
+  double ajd;
+  StringValue(vstr);
+  if (ajd_parse(RSTRING_PTR(vstr), RSTRING_LEN(vstr), &ajd) != AJD_PARSE_OK)
+    rb_raise(rb_eArgError, "invalid date: %.*s",
+      (int)RSTRING_LEN(vstr), RSTRING_PTR(vstr));
+  return DBL2NUM(ajd);
+}
+/*
+ * call-seq:
+ *  parse_ajd_lines(buffer)
+ *
+ * given a newline delimited String of ISO-8601
+ * date times, one per line,
+ * returns an Array of Astronomical Julian Day Numbers.
+ * Blank lines are skipped and lines that do not parse
+ * give nil.
+ *
+ */
+static VALUE func_parse_ajd_lines(VALUE self, VALUE vbuf){
+  size_t i, n, max;
+  double *ajds;
+  VALUE vtmp, vary;
+  StringValue(vbuf);
+  max = ajd_count_lines(RSTRING_PTR(vbuf), RSTRING_LEN(vbuf));
+  ajds = ALLOCV_N(double, vtmp, max ? max : 1);
+  n = ajd_parse_lines(RSTRING_PTR(vbuf), RSTRING_LEN(vbuf), ajds, max, NULL);
+  vary = rb_ary_new2(n);
+  for (i = 0; i < n; i++)
+    rb_ary_push(vary, isnan(ajds[i]) ? Qnil : DBL2NUM(ajds[i]));
+  ALLOCV_END(vtmp);
+  return vary;
+}
 
 /*
  * call-seq:
@@ -104,15 +441,8 @@ static VALUE func_get_jd(VALUE self, VALUE vdatetime){
  *
  */
 static VALUE func_mean_anomaly(VALUE self, VALUE vajd){
-  double ajd = NUM2DBL(vajd);
-  double t = (ajd - DJ00) / 36525;
-  double vma =
-  fmod((              357.52910918     +
-    t * (           35999.05029113889  +
-    t * (     1.0 / -6507.592190889371 +
-    t * (  1.0 / 26470588.235294115    +
-    t * (1.0 / -313315926.8929504))))) * D2R, M2PI);
-  return DBL2NUM(roundf(vma * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_mean_anomaly(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -124,12 +454,8 @@ static VALUE func_mean_anomaly(VALUE self, VALUE vajd){
  *
  */
 static VALUE func_eccentricity(VALUE self, VALUE vajd){
-  double jd = NUM2DBL(vajd);
-  double d = jd - DJ00;
-  double ve =
-  0.016709 -
-  1.151e-9 * d;
-  return DBL2NUM(roundf(ve * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_eccentricity(get_days(vajd), mode), mode);
 }
 
 /*
@@ -143,23 +469,8 @@ static VALUE func_eccentricity(VALUE self, VALUE vajd){
 */
 
 static VALUE func_equation_of_center(VALUE self, VALUE vajd){
-  double mas =
-  NUM2DBL(func_mean_anomaly(self, vajd));
-  double eoe =
-  NUM2DBL(func_eccentricity(self, vajd));
-  double sin1a = sin(1.0 * mas) * 1.0 / 4.0;
-  double sin1b = sin(1.0 * mas) * 5.0 / 96.0;
-  double sin2a = sin(2.0 * mas) * 11.0 / 24.0;
-  double sin2b = sin(2.0 * mas) * 5.0 / 4.0;
-  double sin3a = sin(3.0 * mas) * 13.0 / 12.0;
-  double sin3b = sin(3.0 * mas) * 43.0 / 64.0;
-  double sin4 = sin(4.0 * mas) * 103.0 / 96.0;
-  double sin5 = sin(5.0 * mas) * 1097.0 / 960.0;
-  double ad3 = sin3a - sin1a;
-  double ad4 = sin4 - sin2a;
-  double ad5 = sin5 + sin1b - sin3b;
-  double veoc = eoe * (sin1a * 8.0 + eoe * (sin2b + eoe * (ad3 + eoe * (ad4 + eoe * ad5))));
-  return DBL2NUM(roundf(veoc * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_equation_of_center(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -171,12 +482,8 @@ static VALUE func_equation_of_center(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_true_anomaly(VALUE self, VALUE vajd){
-  double vma =
-  NUM2DBL(func_mean_anomaly(self, vajd));
-  double veoc =
-  NUM2DBL(func_equation_of_center(self, vajd));
-  double vta = vma + veoc;
-  return DBL2NUM(roundf(vta * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_true_anomaly(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -188,14 +495,8 @@ static VALUE func_true_anomaly(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_mean_longitude(VALUE self, VALUE vajd){
-  double jd = NUM2DBL(vajd);
-  double d = jd - DJ00;
-  double vml =
-  fmod(
-    (280.4664567 +
-     0.9856473601037645 * d
-    ) * D2R, M2PI);
-  return DBL2NUM(roundf(vml * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_mean_longitude(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -207,13 +508,8 @@ static VALUE func_mean_longitude(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_eccentric_anomaly(VALUE self, VALUE vajd){
-  double ve =
-  NUM2DBL(func_eccentricity(self, vajd));
-  double vml =
-  NUM2DBL(func_mean_longitude(self, vajd));
-  double vea =
-  vml + ve * sin(vml) * (1.0 + ve * cos(vml));
-  return DBL2NUM(roundf(vea * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_eccentric_anomaly(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -225,11 +521,8 @@ static VALUE func_eccentric_anomaly(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_obliquity_of_ecliptic(VALUE self, VALUE vajd){
-  double jd = NUM2DBL(vajd);
-  double d = jd - DJ00;
-  double vooe =
-  (23.439291 - 3.563E-7 * d) * D2R;
-  return DBL2NUM(roundf(vooe * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_obliquity_of_ecliptic(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -242,10 +535,8 @@ static VALUE func_obliquity_of_ecliptic(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_longitude_of_perihelion(VALUE self, VALUE vajd){
-  double vml = NUM2DBL(func_mean_longitude(self, vajd));
-  double vma = NUM2DBL(func_mean_anomaly(self, vajd));
-  double vlop = anp(vml - vma);
-  return DBL2NUM(roundf(vlop * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_longitude_of_perihelion(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -258,12 +549,8 @@ static VALUE func_longitude_of_perihelion(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_xv(VALUE self, VALUE vajd){
-  double vea =
-  NUM2DBL(func_eccentric_anomaly(self, vajd));
-  double ve =
-  NUM2DBL(func_eccentricity(self, vajd));
-  double vxv = cos(vea) - ve;
-  return DBL2NUM(roundf(vxv * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_xv(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -276,13 +563,8 @@ static VALUE func_xv(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_yv(VALUE self, VALUE vajd){
-  double vea =
-  NUM2DBL(func_eccentric_anomaly(self, vajd));
-  double ve =
-  NUM2DBL(func_eccentricity(self, vajd));
-  double vyv =
-  sqrt(1.0 - ve * ve) * sin(vea);
-  return DBL2NUM(roundf(vyv * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_yv(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -294,10 +576,8 @@ static VALUE func_yv(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_true_anomaly1(VALUE self, VALUE vajd){
-  double xv = NUM2DBL(func_xv(self, vajd));
-  double yv = NUM2DBL(func_yv(self, vajd));
-  double vta = anp(atan2(yv, xv));
-  return DBL2NUM(roundf(vta * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_true_anomaly1(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -309,12 +589,8 @@ static VALUE func_true_anomaly1(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_true_longitude(VALUE self, VALUE vajd){
-  double vml =
-  NUM2DBL(func_mean_longitude(self, vajd));
-  double veoc =
-  NUM2DBL(func_equation_of_center(self, vajd));
-  double vtl = anp(vml + veoc);
-  return DBL2NUM(roundf(vtl * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_true_longitude(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -326,19 +602,8 @@ static VALUE func_true_longitude(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_mean_sidetime(VALUE self, VALUE vajd){
-  double ajd = NUM2DBL(vajd);
-  long double sidereal;
-  long double t;
-  t = (ajd - 2451545.0) / 36525.0;
-  /* calc mean angle */
-  sidereal =
-  280.46061837 +
-  (360.98564736629 * (ajd - 2451545.0)) +
-  (0.000387933 * t * t) -
-  (t * t * t / 38710000.0);
-  sidereal = anp(sidereal * D2R) * R2D;
-  /* change to hours */
-  return DBL2NUM(fmod(roundf((sidereal / 15.0) * RND12) / RND12, 24.0));
+  int mode = get_mode(self);
+  return prec_num(solar_mean_sidetime(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -350,19 +615,8 @@ static VALUE func_mean_sidetime(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_gmsa0(VALUE self, VALUE vajd){
-  double msa0;
-  double ajd0 = NUM2DBL(vajd);
-  double ajdt = fmod(ajd0, 1.0);
-  if (ajdt <= 0.5){
-    ajd0 -= 0.5;
-    ajd0 = floor(ajd0) + 0.5;
-  }
-  else{
-    ajd0 = floor(ajd0) + 0.5;
-  }
-  msa0 =
-  NUM2DBL(func_mean_sidetime(self, DBL2NUM(ajd0))) * 15;
-  return DBL2NUM(roundf(msa0 * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_gmsa0(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -374,12 +628,8 @@ static VALUE func_gmsa0(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_gmsa(VALUE self, VALUE vajd){
-  double ajd = NUM2DBL(vajd) - 0.5;
-  double ajdt = fmod(ajd, 1.0);
-  double vtr = ajdt * 24.0 * 1.00273790935 * 15 * D2R;
-  double msar0 = NUM2DBL(func_gmsa0(self, vajd)) * D2R;
-  double msa = anp(msar0 + vtr) * R2D;
-  return DBL2NUM(roundf(msa * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_gmsa(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -391,9 +641,8 @@ static VALUE func_gmsa(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_gmst0(VALUE self, VALUE vajd){
-  double era0 =
-  NUM2DBL(func_gmsa0(self, vajd)) / 15.0;
-  return DBL2NUM(roundf(era0 * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_gmst0(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -405,8 +654,8 @@ static VALUE func_gmst0(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_gmst(VALUE self, VALUE vajd){
-  double vmst = NUM2DBL(func_gmsa(self, vajd)) / 15.0;
-  return DBL2NUM(roundf(vmst * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_gmst(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -418,13 +667,8 @@ static VALUE func_gmst(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_rv(VALUE self, VALUE vajd){
-  double vxv =
-  NUM2DBL(func_xv(self, vajd));
-  double vyv =
-  NUM2DBL(func_yv(self, vajd));
-  double vrv =
-  sqrt(vxv * vxv + vyv * vyv);
-  return DBL2NUM(roundf(vrv * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_rv(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -436,12 +680,8 @@ static VALUE func_rv(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_ecliptic_x(VALUE self, VALUE vajd){
-  double vrv =
-  NUM2DBL(func_rv(self, vajd));
-  double vtl =
-  NUM2DBL(func_true_longitude(self, vajd));
-  double vex = vrv * cos(vtl);
-  return DBL2NUM(roundf(vex * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_ecliptic_x(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -453,12 +693,8 @@ static VALUE func_ecliptic_x(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_ecliptic_y(VALUE self, VALUE vajd){
-  double vrv =
-  NUM2DBL(func_rv(self, vajd));
-  double vtl =
-  NUM2DBL(func_true_longitude(self, vajd));
-  double vey = vrv * sin(vtl);
-  return DBL2NUM(roundf(vey * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_ecliptic_y(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -470,15 +706,8 @@ static VALUE func_ecliptic_y(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_right_ascension(VALUE self, VALUE vajd){
-  double vey =
-  NUM2DBL(func_ecliptic_y(self, vajd));
-  double vooe =
-  NUM2DBL(func_obliquity_of_ecliptic(self, vajd));
-  double vex =
-  NUM2DBL(func_ecliptic_x(self, vajd));
-  double vra =
-  fmod(atan2(vey * cos(vooe), vex) + M2PI, M2PI);
-  return DBL2NUM(fmod(roundf((vra * R2D / 15.0) * RND12) / RND12, 24.0));
+  int mode = get_mode(self);
+  return prec_num(solar_right_ascension(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -490,12 +719,8 @@ static VALUE func_right_ascension(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_gha(VALUE self, VALUE vajd){
-  double gmsa =
-  NUM2DBL(func_mean_sidetime(self, vajd)) * 15 * D2R;
-  double ra =
-  NUM2DBL(func_right_ascension(self, vajd)) * 15 * D2R;
-  double gha = anp(gmsa - ra);
-  return DBL2NUM(roundf(gha * R2D * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_gha(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -507,16 +732,8 @@ static VALUE func_gha(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_declination(VALUE self, VALUE vajd){
-  double vex =
-  NUM2DBL(func_ecliptic_x(self, vajd));
-  double vey =
-  NUM2DBL(func_ecliptic_y(self, vajd));
-  double vooe =
-  NUM2DBL(func_obliquity_of_ecliptic(self, vajd));
-  double ver = sqrt(vex * vex + vey * vey);
-  double vz = vey * sin(vooe);
-  double vdec = atan2(vz, ver);
-  return DBL2NUM(roundf((vdec * R2D) * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_declination(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -529,9 +746,8 @@ static VALUE func_declination(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_local_sidetime(VALUE self, VALUE vajd, VALUE vlon){
-  double vst = NUM2DBL(func_mean_sidetime(self, vajd));
-  double vlst = vst + NUM2DBL(vlon) / 15.0 ;
-  return DBL2NUM(fmod(roundf(vlst * RND12) / RND12, 24.0));
+  int mode = get_mode(self);
+  return prec_num(solar_local_sidetime(get_days(vajd), NUM2DBL(vlon), mode), mode);
 }
 /*
  * call-seq:
@@ -544,26 +760,8 @@ static VALUE func_local_sidetime(VALUE self, VALUE vajd, VALUE vlon){
  *
 */
 static VALUE func_dlt(VALUE self, VALUE vajd, VALUE vlat){
-  double jd = floor(NUM2DBL(vajd));
-  double vsin_alt = sin(-0.8333 * D2R);
-  double vlat_r = NUM2DBL(vlat) * D2R;
-  double vcos_lat = cos(vlat_r);
-  double vsin_lat = sin(vlat_r);
-  VALUE vjd = DBL2NUM(jd);
-  double vooe =
-  NUM2DBL(func_obliquity_of_ecliptic(self, vjd));
-  double vtl =
-  NUM2DBL(func_true_longitude(self, vjd));
-  double vsin_dec = sin(vooe) * sin(vtl);
-  double vcos_dec =
-  sqrt( 1.0 - vsin_dec * vsin_dec );
-  double vdl =
-  acos(
-    (vsin_alt - vsin_dec * vsin_lat) /
-    (vcos_dec * vcos_lat));
-  double vdla = vdl * R2D;
-  double vdlt = vdla / 15.0 * 2.0;
-  return DBL2NUM(roundf(vdlt * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_dlt(get_days(vajd), NUM2DBL(vlat), mode), mode);
 }
 /*
  * call-seq:
@@ -576,10 +774,8 @@ static VALUE func_dlt(VALUE self, VALUE vajd, VALUE vlat){
  *
 */
 static VALUE func_diurnal_arc(VALUE self, VALUE vajd, VALUE vlat){
-  double jd = floor(NUM2DBL(vajd));
-  double dlt = NUM2DBL(func_dlt(self, DBL2NUM(jd), vlat));
-  double da = dlt / 2.0;
-  return DBL2NUM(roundf(da * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_diurnal_arc(get_days(vajd), NUM2DBL(vlat), mode), mode);
 }
 /*
  * call-seq:
@@ -592,12 +788,8 @@ static VALUE func_diurnal_arc(VALUE self, VALUE vajd, VALUE vlat){
  *
 */
 static VALUE func_t_south(VALUE self, VALUE vajd, VALUE vlon){
-  double jd = floor(NUM2DBL(vajd));
-  double lst = NUM2DBL(func_local_sidetime(self, DBL2NUM(jd), vlon));
-  double ra = NUM2DBL(func_right_ascension(self, DBL2NUM(jd)));
-  double vx = lst - ra;
-  double vt = vx - 24.0 * floor(vx * INV24 + 0.5);
-  return DBL2NUM(fmod(roundf((12.0 - vt) * RND12) / RND12, 24.0));
+  int mode = get_mode(self);
+  return prec_num(solar_t_south(get_days(vajd), NUM2DBL(vlon), mode), mode);
 }
 /*
  * call-seq:
@@ -610,9 +802,8 @@ static VALUE func_t_south(VALUE self, VALUE vajd, VALUE vlon){
  *
 */
 static VALUE func_t_rise(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
-  double ts = NUM2DBL(func_t_south(self, vajd, vlon));
-  double da = NUM2DBL(func_diurnal_arc(self, vajd, vlat));
-  return DBL2NUM(fmod(roundf((ts - da) * RND12) / RND12, 24.0));
+  int mode = get_mode(self);
+  return prec_num(solar_t_rise(get_days(vajd), NUM2DBL(vlat), NUM2DBL(vlon), mode), mode);
 }
 /*
  * call-seq:
@@ -625,8 +816,8 @@ static VALUE func_t_rise(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
  *
 */
 static VALUE func_t_mid_day(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
-  double ts = NUM2DBL(func_t_south(self, vajd, vlon));
-  return DBL2NUM(fmod(roundf(ts * RND12) / RND12, 24.0));
+  int mode = get_mode(self);
+  return prec_num(solar_t_mid_day(get_days(vajd), NUM2DBL(vlat), NUM2DBL(vlon), mode), mode);
 }
 /*
  * call-seq:
@@ -639,9 +830,8 @@ static VALUE func_t_mid_day(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
  *
 */
 static VALUE func_t_set(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
-  double ts = NUM2DBL(func_t_south(self, vajd, vlon));
-  double da = NUM2DBL(func_diurnal_arc(self, vajd, vlat));
-  return DBL2NUM(roundf(fmod((ts + da), 24.0) * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_t_set(get_days(vajd), NUM2DBL(vlat), NUM2DBL(vlon), mode), mode);
 }
 /*
  * call-seq:
@@ -653,11 +843,7 @@ static VALUE func_t_set(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
  *
 */
 static VALUE func_rise(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
-  double rt = NUM2DBL(func_t_rise(self, vajd, vlat, vlon));
-  double ajd = NUM2DBL(vajd);
-  double rtajd = floor(ajd) - 0.5 + rt / 24.0;
-  VALUE vrt = DBL2NUM(rtajd);
-  return func_ajd_2_datetime(self, vrt);
+  return func_ajd_2_datetime(self, DBL2NUM(rts_jd(self, vajd, vlat, vlon, 0)));
 }
 /*
  * call-seq:
@@ -669,10 +855,7 @@ static VALUE func_rise(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
  *
 */
 static VALUE func_rise_jd(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
-  double rt = NUM2DBL(func_t_rise(self, vajd, vlat, vlon));
-  double ajd = NUM2DBL(vajd);
-  double rtajd = floor(ajd) - 0.5 + rt / 24.0;
-  return DBL2NUM(rtajd);
+  return DBL2NUM(rts_jd(self, vajd, vlat, vlon, 0));
 }
 /*
  * call-seq:
@@ -685,11 +868,7 @@ static VALUE func_rise_jd(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
  *
 */
 static VALUE func_noon(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
-  double nt = NUM2DBL(func_t_south(self, vajd, vlon));
-  double ajd = NUM2DBL(vajd);
-  double ntajd = floor(ajd) - 0.5 + nt / 24.0;
-  VALUE vnt = DBL2NUM(ntajd);
-  return func_ajd_2_datetime(self, vnt);
+  return func_ajd_2_datetime(self, DBL2NUM(rts_jd(self, vajd, vlat, vlon, 1)));
 }
 /*
  * call-seq:
@@ -702,10 +881,7 @@ static VALUE func_noon(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
  *
 */
 static VALUE func_noon_jd(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
-  double nt = NUM2DBL(func_t_south(self, vajd, vlon));
-  double ajd = NUM2DBL(vajd);
-  double ntajd = floor(ajd) - 0.5 + nt / 24.0;
-  return DBL2NUM(ntajd);
+  return DBL2NUM(rts_jd(self, vajd, vlat, vlon, 1));
 }
 /*
  * call-seq:
@@ -717,17 +893,7 @@ static VALUE func_noon_jd(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
  *
 */
 static VALUE func_set(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
-  VALUE vst;
-  double stajd;
-  double st = NUM2DBL(func_t_set(self, vajd, vlat, vlon));
-  double nt = NUM2DBL(func_t_mid_day(self, vajd, vlat, vlon));
-  double ajd = NUM2DBL(vajd);
-  if (st < nt){
-    st += 24.0;
-  }
-  stajd = floor(ajd) - 0.5 + st / 24.0;
-  vst = DBL2NUM(stajd);
-  return func_ajd_2_datetime(self, vst);
+  return func_ajd_2_datetime(self, DBL2NUM(rts_jd(self, vajd, vlat, vlon, 2)));
 }
 /*
  * call-seq:
@@ -739,15 +905,7 @@ static VALUE func_set(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
  *
 */
 static VALUE func_set_jd(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
-  double stajd;
-  double st = NUM2DBL(func_t_set(self, vajd, vlat, vlon));
-  double nt = NUM2DBL(func_t_mid_day(self, vajd, vlat, vlon));
-  double ajd = NUM2DBL(vajd);
-  if (st < nt){
-    st += 24.0;
-  }
-  stajd = floor(ajd) - 0.5 + st / 24.0;
-  return DBL2NUM(stajd);
+  return DBL2NUM(rts_jd(self, vajd, vlat, vlon, 2));
 }
 /*
 * macro for days since JD 2000
@@ -764,8 +922,7 @@ static VALUE func_set_jd(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
  *
 */
 static VALUE func_jd_from_2000(VALUE self, VALUE vajd){
-  double ajd = NUM2DBL(vajd);
-  double days = ajd - 2451545.0;
+  double days = get_days(vajd);
   return INT2NUM(days);
 }
 /*
@@ -780,10 +937,8 @@ static VALUE func_jd_from_2000(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_days_from_2000(VALUE self, VALUE vajd, VALUE vlon){
-  double jd = NUM2DBL(vajd);
-  double lon = NUM2DBL(vlon);
-  double days = jd - DJ00 - lon / 360;
-  return DBL2NUM(roundf(days * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_days_from_2000(get_days(vajd), NUM2DBL(vlon), mode), mode);
 }
 /*
  * call-seq:
@@ -795,15 +950,8 @@ static VALUE func_days_from_2000(VALUE self, VALUE vajd, VALUE vlon){
  *
 */
 static VALUE func_eot(VALUE self, VALUE vajd){
-  double ma =
-  NUM2DBL(func_mean_anomaly(self, vajd));
-  double ta =
-  NUM2DBL(func_true_anomaly(self, vajd));
-  double tl =
-  NUM2DBL(func_true_longitude(self, vajd));
-  double ra = 15.0 * D2R *
-  NUM2DBL(func_right_ascension(self, vajd));
-  return DBL2NUM(roundf(anp(ma - ta + tl - ra) * R2D * RND12) / RND12 );
+  int mode = get_mode(self);
+  return prec_num(solar_eot(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -816,10 +964,8 @@ static VALUE func_eot(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_eot_jd(VALUE self, VALUE vajd){
-  double veot =
-  NUM2DBL(func_eot(self, vajd));
-  double jdeot = veot / 360.0;
-  return DBL2NUM(roundf(jdeot * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_eot_jd(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -831,8 +977,8 @@ static VALUE func_eot_jd(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_eot_min(VALUE self, VALUE vajd){
-  double eot = NUM2DBL(func_eot(self, vajd));
-  return DBL2NUM(roundf((eot / 15 * 60) * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_eot_min(get_days(vajd), mode), mode);
 }
 /*
  * call-seq:
@@ -845,10 +991,8 @@ static VALUE func_eot_min(VALUE self, VALUE vajd){
  *
 */
 static VALUE func_lha(VALUE self, VALUE vajd, VALUE vlon){
-  double lon = NUM2DBL(vlon) * D2R;
-  double gha = NUM2DBL(func_gha(self, vajd)) * D2R;
-  double lha = anp(gha + lon) * R2D;
-  return DBL2NUM(roundf(lha * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_lha(get_days(vajd), NUM2DBL(vlon), mode), mode);
 }
 /*
  * call-seq:
@@ -861,13 +1005,8 @@ static VALUE func_lha(VALUE self, VALUE vajd, VALUE vlon){
  *
 */
 static VALUE func_altitude(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
-  double lat = NUM2DBL(vlat) * D2R;
-  double delta = NUM2DBL(func_declination(self, vajd)) * D2R;
-  double lha = NUM2DBL(func_lha(self, vajd, vlon)) * D2R;
-  double alt =
-  asin(sin(lat) * sin(delta) +
-    cos(lat) * cos(delta) * cos(lha)) * R2D;
-  return DBL2NUM(roundf(alt * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_altitude(get_days(vajd), NUM2DBL(vlat), NUM2DBL(vlon), mode), mode);
 }
 /*
  * call-seq:
@@ -880,14 +1019,89 @@ static VALUE func_altitude(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
  *
 */
 static VALUE func_azimuth(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
-  double lat = NUM2DBL(vlat) * D2R;
-  double delta = NUM2DBL(func_declination(self, vajd)) * D2R;
-  double lha = NUM2DBL(func_lha(self, vajd, vlon)) * D2R;
-  double az;
-  az =
-  atan2(sin(lha), cos(lha) * sin(lat) -
-            tan(delta) * cos(lat)) * R2D + 180.0;
-  return DBL2NUM(roundf(az * RND12) / RND12);
+  int mode = get_mode(self);
+  return prec_num(solar_azimuth(get_days(vajd), NUM2DBL(vlat), NUM2DBL(vlon), mode), mode);
+}
+/* fills n floats from an Array of length n or one Numeric */
+static void
+fill_f32(float *dst, VALUE v, long n, const char *name){
+  long i;
+  if (RB_TYPE_P(v, T_ARRAY)){
+    if (RARRAY_LEN(v) != n)
+      rb_raise(rb_eArgError, "ajds and %s differ in length", name);
+    for (i = 0; i < n; i++)
+      dst[i] = (float)NUM2DBL(rb_ary_entry(v, i));
+  }
+  else{
+    float f = (float)NUM2DBL(v);
+    for (i = 0; i < n; i++)
+      dst[i] = f;
+  }
+}
+/*
+ * call-seq:
+ *  fast_alt_az(ajds, lat, lon, trig_error = 1e-6)
+ *
+ * given an Array of Astronomical Julian Day Numbers and
+ * local Latitude and Longitude, each one Numeric or an
+ * Array as long as ajds,
+ * returns [altitudes, azimuths] in degrees.
+ * trig_error picks the kernel by the error of its trig:
+ * 1e-6 and above computes in single precision, within
+ * 0.0003 degrees of altitude and 0.0015 degrees of azimuth,
+ * 1e-9 and above in double precision, within 3e-8 degrees
+ * of altitude and 5e-7 of azimuth, smaller or :full in
+ * double precision with libm trig, within 2e-9 and 1e-7.
+ * azimuth bounds hold below 85 degrees altitude.
+ * not rounded, precision is ignored.
+ *
+ */
+static VALUE func_fast_alt_az(int argc, VALUE *argv, VALUE self){
+  VALUE vajds, vlat, vlon, verr, vtmp, valt, vaz;
+  long i, n;
+  double *d;
+  int trig = FT_TRIG_1E6;
+  rb_scan_args(argc, argv, "31", &vajds, &vlat, &vlon, &verr);
+  Check_Type(vajds, T_ARRAY);
+  if (verr == sym_full)
+    trig = FT_TRIG_FULL;
+  else if (!NIL_P(verr)){
+    double err = NUM2DBL(verr);
+    if (!(err > 0.0))
+      rb_raise(rb_eArgError, "trig_error must be positive or :full");
+    trig = err >= 1e-6 ? FT_TRIG_1E6 : err >= 1e-9 ? FT_TRIG_1E9 : FT_TRIG_FULL;
+  }
+  n = RARRAY_LEN(vajds);
+  valt = rb_ary_new2(n);
+  vaz = rb_ary_new2(n);
+  if (trig == FT_TRIG_1E6){
+    float *f;
+    d = ALLOCV(vtmp, n * (sizeof(double) + 4 * sizeof(float)) + 1);
+    f = (float *)(d + n);
+    fill_f32(f, vlat, n, "lats");
+    fill_f32(f + n, vlon, n, "lons");
+    for (i = 0; i < n; i++)
+      d[i] = get_days(rb_ary_entry(vajds, i));
+    solar_altaz_f32(d, f, f + n, f + 2 * n, f + 3 * n, (size_t)n);
+    for (i = 0; i < n; i++){
+      rb_ary_push(valt, DBL2NUM(f[2 * n + i]));
+      rb_ary_push(vaz, DBL2NUM(f[3 * n + i]));
+    }
+  }
+  else{
+    d = ALLOCV(vtmp, 5 * n * sizeof(double) + 1);
+    fill_f64(d + n, vlat, n, "ajds and lats");
+    fill_f64(d + 2 * n, vlon, n, "ajds and lons");
+    for (i = 0; i < n; i++)
+      d[i] = get_days(rb_ary_entry(vajds, i));
+    solar_altaz_f64(d, d + n, d + 2 * n, d + 3 * n, d + 4 * n, (size_t)n, trig);
+    for (i = 0; i < n; i++){
+      rb_ary_push(valt, DBL2NUM(d[3 * n + i]));
+      rb_ary_push(vaz, DBL2NUM(d[4 * n + i]));
+    }
+  }
+  ALLOCV_END(vtmp);
+  return rb_assoc_new(valt, vaz);
 }
 /*
  * call-seq:
@@ -899,9 +1113,8 @@ static VALUE func_azimuth(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
  *
 */
 static VALUE func_rise_az(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
-  double rjd = NUM2DBL(func_rise_jd(self, vajd, vlat, vlon));
-  double raz = NUM2DBL(func_azimuth(self, DBL2NUM(rjd), vlat, vlon));
-  return DBL2NUM(raz);
+  int mode = get_mode(self);
+  return prec_num(solar_rise_az(get_days(vajd), NUM2DBL(vlat), NUM2DBL(vlon), mode), mode);
 }
 /*
  * call-seq:
@@ -914,9 +1127,8 @@ static VALUE func_rise_az(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
  *
 */
 static VALUE func_noon_az(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
-  double njd = NUM2DBL(func_noon_jd(self, vajd, vlat, vlon));
-  double naz = NUM2DBL(func_azimuth(self, DBL2NUM(njd), vlat, vlon));
-  return DBL2NUM(naz);
+  int mode = get_mode(self);
+  return prec_num(solar_noon_az(get_days(vajd), NUM2DBL(vlat), NUM2DBL(vlon), mode), mode);
 }
 /*
  * call-seq:
@@ -928,22 +1140,417 @@ static VALUE func_noon_az(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
  *
 */
 static VALUE func_set_az(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
-  double sjd = NUM2DBL(func_set_jd(self, vajd, vlat, vlon));
-  double saz = NUM2DBL(func_azimuth(self, DBL2NUM(sjd), vlat, vlon));
-  return DBL2NUM(saz);
+  int mode = get_mode(self);
+  return prec_num(solar_set_az(get_days(vajd), NUM2DBL(vlat), NUM2DBL(vlon), mode), mode);
+}
+/*
+ * call-seq:
+ *  spa_alt_az(ajd, lats, lons, elevations = 0)
+ *
+ * given one Astronomical Julian Day Number (UT), an Array
+ * of Latitudes and Longitudes and elevations in meters,
+ * each an Array as long as lats or one Numeric,
+ * returns [altitudes, azimuths] in degrees from NREL SPA,
+ * topocentric and without refraction. The ephemeris is
+ * evaluated once for all observers, Delta T and DUT1
+ * come from delta_t and dut1.
+ * not rounded, precision is ignored.
+ *
+ */
+static VALUE func_spa_alt_az(int argc, VALUE *argv, VALUE self){
+  VALUE vajd, vlats, vlons, velev, vtmp, valt, vaz;
+  spa_geo g;
+  spa_atmos atm = {1010.0, 10.0, 0.5667};
+  double ajd, *buf;
+  long i, n;
+  rb_scan_args(argc, argv, "31", &vajd, &vlats, &vlons, &velev);
+  Check_Type(vlats, T_ARRAY);
+  ajd = get_ajd(vajd);
+  n = RARRAY_LEN(vlats);
+  buf = ALLOCV_N(double, vtmp, 5 * n + 1);
+  fill_f64(buf, vlats, n, "lats");
+  fill_f64(buf + n, vlons, n, "lats and lons");
+  fill_f64(buf + 2 * n, NIL_P(velev) ? INT2FIX(0) : velev, n, "lats and elevations");
+  if (spa_geo_at(&g, ajd + delta_t_dut1(ajd) / 86400.0, delta_t_ajd(ajd)) != 0){
+    ALLOCV_END(vtmp);
+    rb_raise(rb_eArgError, "Delta T out of range for SPA");
+  }
+  spa_observe(&g, &atm, (size_t)n, buf, buf + n, buf + 2 * n,
+              buf + 3 * n, NULL, buf + 4 * n);
+  valt = rb_ary_new2(n);
+  vaz = rb_ary_new2(n);
+  for (i = 0; i < n; i++){
+    rb_ary_push(valt, DBL2NUM(buf[3 * n + i]));
+    rb_ary_push(vaz, DBL2NUM(buf[4 * n + i]));
+  }
+  ALLOCV_END(vtmp);
+  return rb_assoc_new(valt, vaz);
+}
+/*
+ * call-seq:
+ *  spa_rts_table(jd, days, lat, lon, delta_t = nil)
+ *
+ * given the Julian Day Number of the first date, a number
+ * of days and local Latitude and Longitude,
+ * returns an Array with one [rise, transit, set] per date
+ * from NREL SPA, in UT hours, nil for a date the Sun
+ * does not rise or set. delta_t in seconds, by default
+ * from delta_t for each date. Consecutive dates share
+ * their geocentric work, one ephemeris evaluation a day.
+ * not rounded, precision is ignored.
+ *
+ */
+static VALUE func_spa_rts_table(int argc, VALUE *argv, VALUE self){
+  VALUE vjd, vdays, vlat, vlon, vdt, vary;
+  spa_rts_window w;
+  spa_data sd;
+  long jdn, days, i, y;
+  rb_scan_args(argc, argv, "41", &vjd, &vdays, &vlat, &vlon, &vdt);
+  jdn = NUM2LONG(vjd);
+  days = NUM2LONG(vdays);
+  if (days < 0) rb_raise(rb_eArgError, "negative day count");
+  memset(&sd, 0, sizeof sd);
+  sd.latitude = NUM2DBL(vlat);
+  sd.longitude = NUM2DBL(vlon);
+  sd.pressure = 1010.0;
+  sd.temperature = 10.0;
+  sd.atmos_refract = 0.5667;
+  sd.function = SPA_ZA_RTS;
+  spa_rts_init(&w);
+  vary = rb_ary_new2(days);
+  for (i = 0; i < days; i++, jdn++){
+    VALUE vrow;
+    int rc;
+    ajd_jdn_to_civil(jdn, &y, &sd.month, &sd.day);
+    sd.year = (int)y;
+    sd.delta_t = NIL_P(vdt) ? delta_t_ajd((double)jdn - 0.5) : NUM2DBL(vdt);
+    rc = spa_rts_day(&w, &sd);
+    if (rc) rb_raise(rb_eArgError, "SPA input out of range (code %d)", rc);
+    if (sd.sunrise < 0.0){
+      rb_ary_push(vary, rb_ary_new3(3, Qnil, Qnil, Qnil));
+      continue;
+    }
+    vrow = rb_ary_new3(3, DBL2NUM(sd.sunrise), DBL2NUM(sd.suntransit),
+                       DBL2NUM(sd.sunset));
+    rb_ary_push(vary, vrow);
+  }
+  return vary;
+}
+/* ajds as days from J2000 and lats, lons filled alongside */
+static void
+fill_days(VALUE vajds, VALUE vlats, VALUE vlons, double *buf, long n){
+  long i;
+  for (i = 0; i < n; i++)
+    buf[i] = get_days(rb_ary_entry(vajds, i));
+  fill_f64(buf + n, vlats, n, "ajds and lats");
+  fill_f64(buf + 2 * n, vlons, n, "ajds and lons");
+}
+/*
+ * call-seq:
+ *  sunriset_rise_set(ajds, lats, lons, altitude = -35.0 / 60,
+ *                    upper_limb = true)
+ *
+ * given an Array of Astronomical Julian Day Numbers and
+ * local Latitudes and Longitudes, each an Array as long
+ * as ajds or one Numeric,
+ * returns [rises, transits, sets, day_lengths] for the day
+ * of each ajd from Paul Schlyter's sunriset algorithm.
+ * rises, transits and sets are Astronomical Julian Day
+ * Numbers, nil where the Sun does not cross altitude,
+ * day lengths in hours. altitude -6, -12 or -18 with
+ * upper_limb false gives the twilights.
+ * within about 4 minutes of NREL SPA up to 60 degrees
+ * of latitude, several times cheaper than the chain.
+ * not rounded, precision is ignored.
+ *
+ */
+static VALUE func_sunriset_rise_set(int argc, VALUE *argv, VALUE self){
+  VALUE vajds, vlats, vlons, valt, vlimb, vtmp, vr, vt, vs, vl;
+  long i, n;
+  double *buf;
+  rb_scan_args(argc, argv, "32", &vajds, &vlats, &vlons, &valt, &vlimb);
+  Check_Type(vajds, T_ARRAY);
+  n = RARRAY_LEN(vajds);
+  buf = ALLOCV(vtmp, 7 * n * sizeof(double) + 1);
+  fill_days(vajds, vlats, vlons, buf, n);
+  sunriset_rise_set_n((size_t)n, buf, buf + n, buf + 2 * n,
+                      NIL_P(valt) ? SUNRISET_RISE_SET : NUM2DBL(valt),
+                      NIL_P(vlimb) || RTEST(vlimb),
+                      buf + 3 * n, buf + 4 * n, buf + 5 * n, buf + 6 * n);
+  vr = rb_ary_new2(n);
+  vt = rb_ary_new2(n);
+  vs = rb_ary_new2(n);
+  vl = rb_ary_new2(n);
+  for (i = 0; i < n; i++){
+    double r = buf[3 * n + i], st = buf[5 * n + i];
+    rb_ary_push(vr, isnan(r) ? Qnil : DBL2NUM(r));
+    rb_ary_push(vt, DBL2NUM(buf[4 * n + i]));
+    rb_ary_push(vs, isnan(st) ? Qnil : DBL2NUM(st));
+    rb_ary_push(vl, DBL2NUM(buf[6 * n + i]));
+  }
+  ALLOCV_END(vtmp);
+  return rb_ary_new3(4, vr, vt, vs, vl);
+}
+/*
+ * call-seq:
+ *  sunriset_alt_az(ajds, lats, lons)
+ *
+ * given an Array of Astronomical Julian Day Numbers and
+ * local Latitudes and Longitudes, each an Array as long
+ * as ajds or one Numeric,
+ * returns [altitudes, azimuths] in degrees from Paul
+ * Schlyter's sunriset algorithm, geocentric, within about
+ * 0.02 degrees of altitude of NREL SPA.
+ * not rounded, precision is ignored.
+ *
+ */
+static VALUE func_sunriset_alt_az(VALUE self, VALUE vajds, VALUE vlats, VALUE vlons){
+  VALUE vtmp, valt, vaz;
+  long i, n;
+  double *buf;
+  Check_Type(vajds, T_ARRAY);
+  n = RARRAY_LEN(vajds);
+  buf = ALLOCV(vtmp, 5 * n * sizeof(double) + 1);
+  fill_days(vajds, vlats, vlons, buf, n);
+  sunriset_alt_az_n((size_t)n, buf, buf + n, buf + 2 * n, buf + 3 * n, buf + 4 * n);
+  valt = rb_ary_new2(n);
+  vaz = rb_ary_new2(n);
+  for (i = 0; i < n; i++){
+    rb_ary_push(valt, DBL2NUM(buf[3 * n + i]));
+    rb_ary_push(vaz, DBL2NUM(buf[4 * n + i]));
+  }
+  ALLOCV_END(vtmp);
+  return rb_assoc_new(valt, vaz);
+}
+/*
+ * call-seq:
+ *  CalcSun.day_table_size
+ *
+ * bytes held by the process wide table of per day solar
+ * state, right ascension, declination, radius vector,
+ * equation of time and sidereal time, that rise, transit,
+ * set and the like read. it fills as days are first
+ * touched, from any thread, and is never emptied.
+ *
+ */
+static VALUE func_day_table_size(VALUE klass){
+  return SIZET2NUM(solar_day_table_size());
+}
+/*
+ * call-seq:
+ *  CalcSun.engines
+ *
+ * returns the table the error budget methods choose from,
+ * an Array of [quantity, engine, error, cost]: quantity
+ * :position (error in degrees on the sky) or :rise_set
+ * (seconds), engine :fast, :sunriset, :chain or :spa, cost
+ * in nanoseconds a sample. errors are the worst measured
+ * against NREL SPA by libcalcsun's make characterize.
+ *
+ */
+static VALUE func_engines(VALUE klass){
+  VALUE vary = rb_ary_new2((long)engine_table_size);
+  size_t i;
+  for (i = 0; i < engine_table_size; i++){
+    const engine_entry *e = &engine_table[i];
+    rb_ary_push(vary, rb_ary_new3(4,
+                e->quantity == ENGINE_POSITION ? sym_position : sym_rise_set,
+                ID2SYM(rb_intern(e->name)), DBL2NUM(e->error),
+                DBL2NUM(e->cost)));
+  }
+  return vary;
+}
+/*
+ * call-seq:
+ *  CalcSun.engine_for(quantity, tolerance)
+ *
+ * returns the cheapest engine of CalcSun.engines for
+ * quantity, :position or :rise_set, whose error is within
+ * tolerance, degrees or seconds.
+ * raises ArgumentError when none is.
+ *
+ */
+static VALUE func_engine_for(VALUE klass, VALUE vq, VALUE vtol){
+  return ID2SYM(rb_intern(select_engine(get_quantity(vq), vtol)->name));
+}
+/*
+ * call-seq:
+ *  alt_az_within(ajds, lats, lons, degrees)
+ *
+ * given an Array of Astronomical Julian Day Numbers and
+ * local Latitudes and Longitudes, each an Array as long
+ * as ajds or one Numeric,
+ * returns [altitudes, azimuths] in degrees, no refraction,
+ * from the cheapest engine within degrees of NREL SPA,
+ * CalcSun.engine_for(:position, degrees).
+ * not rounded, precision is ignored.
+ *
+ */
+static VALUE func_alt_az_within(VALUE self, VALUE vajds, VALUE vlats, VALUE vlons, VALUE vtol){
+  const engine_entry *e = select_engine(ENGINE_POSITION, vtol);
+  VALUE vtmp, valt, vaz;
+  long i, n;
+  double *buf;
+  Check_Type(vajds, T_ARRAY);
+  n = RARRAY_LEN(vajds);
+  buf = ALLOCV(vtmp, 5 * n * sizeof(double) + 1);
+  fill_days(vajds, vlats, vlons, buf, n);
+  if (engine_alt_az(e->engine, (size_t)n, buf, buf + n, buf + 2 * n,
+                    buf + 3 * n, buf + 4 * n) != 0){
+    ALLOCV_END(vtmp);
+    rb_sys_fail(e->name);
+  }
+  valt = rb_ary_new2(n);
+  vaz = rb_ary_new2(n);
+  for (i = 0; i < n; i++){
+    rb_ary_push(valt, DBL2NUM(buf[3 * n + i]));
+    rb_ary_push(vaz, DBL2NUM(buf[4 * n + i]));
+  }
+  ALLOCV_END(vtmp);
+  return rb_assoc_new(valt, vaz);
+}
+/*
+ * call-seq:
+ *  rise_set_within(ajds, lats, lons, seconds)
+ *
+ * given an Array of Astronomical Julian Day Numbers and
+ * local Latitudes and Longitudes, each an Array as long
+ * as ajds or one Numeric,
+ * returns [rises, transits, sets] as Astronomical Julian
+ * Day Numbers for the day of each ajd, from the cheapest
+ * engine within seconds of NREL SPA,
+ * CalcSun.engine_for(:rise_set, seconds). rises and sets
+ * nil where the Sun does not rise or set. the tolerance
+ * holds up to 60 degrees of latitude.
+ * not rounded, precision is ignored.
+ *
+ */
+static VALUE func_rise_set_within(VALUE self, VALUE vajds, VALUE vlats, VALUE vlons, VALUE vtol){
+  const engine_entry *e = select_engine(ENGINE_RISE_SET, vtol);
+  VALUE vtmp, vr, vt, vs;
+  long i, n;
+  double *buf;
+  Check_Type(vajds, T_ARRAY);
+  n = RARRAY_LEN(vajds);
+  buf = ALLOCV(vtmp, 6 * n * sizeof(double) + 1);
+  fill_days(vajds, vlats, vlons, buf, n);
+  if (engine_rise_set(e->engine, (size_t)n, buf, buf + n, buf + 2 * n,
+                      buf + 3 * n, buf + 4 * n, buf + 5 * n) != 0){
+    ALLOCV_END(vtmp);
+    rb_sys_fail(e->name);
+  }
+  vr = rb_ary_new2(n);
+  vt = rb_ary_new2(n);
+  vs = rb_ary_new2(n);
+  for (i = 0; i < n; i++){
+    double r = buf[3 * n + i], t = buf[4 * n + i], st = buf[5 * n + i];
+    rb_ary_push(vr, isnan(r) ? Qnil : DBL2NUM(r));
+    rb_ary_push(vt, isnan(t) ? Qnil : DBL2NUM(t));
+    rb_ary_push(vs, isnan(st) ? Qnil : DBL2NUM(st));
+  }
+  ALLOCV_END(vtmp);
+  return rb_ary_new3(3, vr, vt, vs);
+}
+/*
+ * call-seq:
+ *  alt_az_buffer(ajds, lats, lons, degrees)
+ *
+ * as alt_az_within, but returns a CalcSun::Buffer of shape
+ * [2, ajds.length], altitudes then azimuths, that other
+ * extensions read in place through MemoryView.
+ *
+ */
+static VALUE func_alt_az_buffer(VALUE self, VALUE vajds, VALUE vlats, VALUE vlons, VALUE vtol){
+  const engine_entry *e = select_engine(ENGINE_POSITION, vtol);
+  VALUE vtmp, vbuf;
+  long n;
+  double *buf, *out;
+  Check_Type(vajds, T_ARRAY);
+  n = RARRAY_LEN(vajds);
+  buf = ALLOCV(vtmp, 3 * n * sizeof(double) + 1);
+  fill_days(vajds, vlats, vlons, buf, n);
+  vbuf = buffer_new(2, n, &out);
+  if (engine_alt_az(e->engine, (size_t)n, buf, buf + n, buf + 2 * n,
+                    out, out + n) != 0){
+    ALLOCV_END(vtmp);
+    rb_sys_fail(e->name);
+  }
+  ALLOCV_END(vtmp);
+  return vbuf;
+}
+/*
+ * call-seq:
+ *  rise_set_buffer(ajds, lats, lons, seconds)
+ *
+ * as rise_set_within, but returns a CalcSun::Buffer of
+ * shape [3, ajds.length], rises, transits then sets, NaN
+ * where rise_set_within gives nil, that other extensions
+ * read in place through MemoryView.
+ *
+ */
+static VALUE func_rise_set_buffer(VALUE self, VALUE vajds, VALUE vlats, VALUE vlons, VALUE vtol){
+  const engine_entry *e = select_engine(ENGINE_RISE_SET, vtol);
+  VALUE vtmp, vbuf;
+  long n;
+  double *buf, *out;
+  Check_Type(vajds, T_ARRAY);
+  n = RARRAY_LEN(vajds);
+  buf = ALLOCV(vtmp, 3 * n * sizeof(double) + 1);
+  fill_days(vajds, vlats, vlons, buf, n);
+  vbuf = buffer_new(3, n, &out);
+  if (engine_rise_set(e->engine, (size_t)n, buf, buf + n, buf + 2 * n,
+                      out, out + n, out + 2 * n) != 0){
+    ALLOCV_END(vtmp);
+    rb_sys_fail(e->name);
+  }
+  ALLOCV_END(vtmp);
+  return vbuf;
 }
 
 void Init_calc_sun(void){
   VALUE cCalcSun = rb_define_class("CalcSun", rb_cObject);
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+  /* IDs and Symbols are set here once, the IERS table is
+  * published atomically, Zone and RiseSurface are frozen
+  */
+  rb_ext_ractor_safe(true);
+#endif
   rb_require("date");
-  rb_define_method(cCalcSun, "initialize", t_init, 0);
+  id_ajd = rb_intern("ajd");
+  id_precision = rb_intern("@precision");
+  sym_raw = ID2SYM(rb_intern("raw"));
+  sym_round12 = ID2SYM(rb_intern("round12"));
+  sym_legacy = ID2SYM(rb_intern("legacy"));
+  sym_full = ID2SYM(rb_intern("full"));
+  sym_position = ID2SYM(rb_intern("position"));
+  sym_rise_set = ID2SYM(rb_intern("rise_set"));
+  sym_rising = ID2SYM(rb_intern("rising"));
+  sym_setting = ID2SYM(rb_intern("setting"));
+  rb_define_singleton_method(cCalcSun, "day_table_size", func_day_table_size, 0);
+  rb_define_singleton_method(cCalcSun, "engine_for", func_engine_for, 2);
+  rb_define_singleton_method(cCalcSun, "engines", func_engines, 0);
+  rb_define_singleton_method(cCalcSun, "load_iers", func_load_iers, 1);
+  rb_define_singleton_method(cCalcSun, "unload_iers", func_unload_iers, 0);
+  rb_define_method(cCalcSun, "initialize", t_init, -1);
   rb_define_method(cCalcSun, "ajd", func_get_ajd, 1);
   rb_define_method(cCalcSun, "ajd2dt", func_ajd_2_datetime, 1);
+  rb_define_method(cCalcSun, "alt_az_arrow", func_alt_az_arrow, -1);
+  rb_define_method(cCalcSun, "alt_az_buffer", func_alt_az_buffer, 4);
+  rb_define_method(cCalcSun, "alt_az_within", func_alt_az_within, 4);
+  rb_define_method(cCalcSun, "altitude_batch", func_altitude_batch, 3);
   rb_define_method(cCalcSun, "altitude", func_altitude, 3);
+  rb_define_method(cCalcSun, "altitude_time", func_altitude_time, -1);
+  rb_define_method(cCalcSun, "altitude_time_batch", func_altitude_time_batch, -1);
   rb_define_method(cCalcSun, "azimuth", func_azimuth, 3);
+  rb_define_method(cCalcSun, "azimuth_batch", func_azimuth_batch, 3);
+  rb_define_method(cCalcSun, "azimuth_time", func_azimuth_time, 4);
+  rb_define_method(cCalcSun, "azimuth_time_batch", func_azimuth_time_batch, 4);
   rb_define_method(cCalcSun, "daylight_time", func_dlt, 2);
   rb_define_method(cCalcSun, "declination", func_declination, 1);
+  rb_define_method(cCalcSun, "declination_batch", func_declination_batch, 1);
+  rb_define_method(cCalcSun, "delta_t", func_delta_t, 1);
   rb_define_method(cCalcSun, "diurnal_arc", func_diurnal_arc, 2);
+  rb_define_method(cCalcSun, "dut1", func_dut1, 1);
   rb_define_method(cCalcSun, "eccentricity", func_eccentricity, 1);
   rb_define_method(cCalcSun, "eccentric_anomaly", func_eccentric_anomaly, 1);
   rb_define_method(cCalcSun, "ecliptic_x", func_ecliptic_x, 1);
@@ -951,18 +1558,26 @@ void Init_calc_sun(void){
   rb_define_method(cCalcSun, "eot", func_eot, 1);
   rb_define_method(cCalcSun, "eot_jd", func_eot_jd, 1);
   rb_define_method(cCalcSun, "eot_min", func_eot_min, 1);
+  rb_define_method(cCalcSun, "epoch2jd", func_epoch_2_jd, 1);
   rb_define_method(cCalcSun, "equation_of_center", func_equation_of_center, 1);
+  rb_define_method(cCalcSun, "fast_alt_az", func_fast_alt_az, -1);
   rb_define_method(cCalcSun, "gha", func_gha, 1);
   rb_define_method(cCalcSun, "gmsa0", func_gmsa0, 1);
   rb_define_method(cCalcSun, "gmsa", func_gmsa, 1);
   rb_define_method(cCalcSun, "gmst0", func_gmst0, 1);
   rb_define_method(cCalcSun, "gmst", func_gmst, 1);
+  rb_define_method(cCalcSun, "gmst_batch", func_gmst_batch, 1);
+  rb_define_method(cCalcSun, "gmst_steps", func_gmst_steps, 3);
   rb_define_method(cCalcSun, "jd", func_get_jd, 1);
   rb_define_method(cCalcSun, "jd2000_dif", func_jd_from_2000, 1);
   rb_define_method(cCalcSun, "jd2000_dif_lon", func_days_from_2000, 2);
   rb_define_method(cCalcSun, "lha", func_lha, 2);
+  rb_define_method(cCalcSun, "lmst_batch", func_lmst_batch, 2);
+  rb_define_method(cCalcSun, "local_day_table", func_local_day_table, 5);
   rb_define_method(cCalcSun, "local_sidereal_time", func_local_sidetime, 2);
   rb_define_method(cCalcSun, "longitude_of_perihelion", func_longitude_of_perihelion, 1);
+  rb_define_method(cCalcSun, "max_altitude", func_max_altitude, 3);
+  rb_define_method(cCalcSun, "max_altitude_batch", func_max_altitude_batch, 3);
   rb_define_method(cCalcSun, "mean_anomaly", func_mean_anomaly, 1);
   rb_define_method(cCalcSun, "mean_longitude", func_mean_longitude, 1);
   rb_define_method(cCalcSun, "mean_sidereal_time", func_mean_sidetime, 1);
@@ -970,15 +1585,33 @@ void Init_calc_sun(void){
   rb_define_method(cCalcSun, "noon_jd", func_noon_jd, 3);
   rb_define_method(cCalcSun, "noon_az", func_noon_az, 3);
   rb_define_method(cCalcSun, "obliquity_of_ecliptic", func_obliquity_of_ecliptic, 1);
+  rb_define_method(cCalcSun, "parse_ajd", func_parse_ajd, 1);
+  rb_define_method(cCalcSun, "parse_ajd_lines", func_parse_ajd_lines, 1);
+  rb_define_method(cCalcSun, "precompute_async", func_precompute_async, -1);
+  rb_define_method(cCalcSun, "profile_store", func_get_profile_store, 0);
+  rb_define_method(cCalcSun, "profile_store=", func_set_profile_store, 1);
   rb_define_method(cCalcSun, "radius_vector", func_rv, 1);
   rb_define_method(cCalcSun, "right_ascension", func_right_ascension, 1);
+  rb_define_method(cCalcSun, "precision", func_get_precision, 0);
+  rb_define_method(cCalcSun, "precision=", func_set_precision, 1);
   rb_define_method(cCalcSun, "rise", func_rise, 3);
   rb_define_method(cCalcSun, "rise_jd", func_rise_jd, 3);
+  rb_define_method(cCalcSun, "rise_set_arrow", func_rise_set_arrow, -1);
+  rb_define_method(cCalcSun, "rise_set_batch", func_rise_set_batch, 3);
+  rb_define_method(cCalcSun, "rise_set_buffer", func_rise_set_buffer, 4);
+  rb_define_method(cCalcSun, "rise_set_within", func_rise_set_within, 4);
   rb_define_method(cCalcSun, "rise_az", func_rise_az, 3);
   rb_define_method(cCalcSun, "set", func_set, 3);
   rb_define_method(cCalcSun, "set_jd", func_set_jd, 3);
   rb_define_method(cCalcSun, "set_az", func_set_az, 3);
   rb_define_method(cCalcSun, "set_datetime", func_set_datetime, 1);
+  rb_define_method(cCalcSun, "shared_cache", func_get_shared_cache, 0);
+  rb_define_method(cCalcSun, "shared_cache=", func_set_shared_cache, 1);
+  rb_define_method(cCalcSun, "spa_alt_az", func_spa_alt_az, -1);
+  rb_define_method(cCalcSun, "spa_rts_table", func_spa_rts_table, -1);
+  rb_define_method(cCalcSun, "sun_intervals", func_sun_intervals, -1);
+  rb_define_method(cCalcSun, "sunriset_alt_az", func_sunriset_alt_az, 3);
+  rb_define_method(cCalcSun, "sunriset_rise_set", func_sunriset_rise_set, -1);
   rb_define_method(cCalcSun, "t_mid_day", func_t_mid_day, 3);
   rb_define_method(cCalcSun, "t_rise", func_t_rise, 3);
   rb_define_method(cCalcSun, "t_set", func_t_set, 3);
@@ -986,6 +1619,13 @@ void Init_calc_sun(void){
   rb_define_method(cCalcSun, "true_anomaly", func_true_anomaly, 1);
   rb_define_method(cCalcSun, "true_anomaly1", func_true_anomaly1, 1);
   rb_define_method(cCalcSun, "true_longitude", func_true_longitude, 1);
+  rb_define_method(cCalcSun, "write_profiles", func_write_profiles, -1);
   rb_define_method(cCalcSun, "xv", func_xv, 1);
   rb_define_method(cCalcSun, "yv", func_yv, 1);
+  init_surface(cCalcSun);
+  init_zone(cCalcSun);
+  init_precompute(cCalcSun);
+  init_buffer(cCalcSun);
+  init_shared(cCalcSun);
+  init_profile(cCalcSun);
 }
\ No newline at end of file
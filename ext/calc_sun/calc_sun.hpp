@@ -0,0 +1,716 @@
+/*
+ * calc_sun.hpp
+ *
+ * The CalcSun solar chain as a header only C++ library
+ * (C++11 and later). No Ruby dependency.
+ *
+ *  calc_sun::chain<T, Round>
+ *    every CalcSun method as a static member of the same
+ *    name, taking d, the days from J2000 (ajd - 2451545.0).
+ *    T is the scalar the chain computes in, float or
+ *    double.
+ *    Round is calc_sun::raw (no rounding) or
+ *    calc_sun::legacy (every hop through roundf as
+ *    calc_sun 1.2 did).
+ *
+ *  calc_sun::sun<Algo, T>
+ *    altitude and azimuth for one instant and place,
+ *    Algo calc_sun::simple (the chain) or calc_sun::spa
+ *    (NREL SPA, double only, link spa.c and delta_t.c).
+ *
+ *  calc_sun::pack<S, N>
+ *    N lanes of S in a GCC vector (GCC and clang), for
+ *    chain<pack<double, 4>, raw> and sun<simple, pack<...>>:
+ *    arithmetic runs on the vector, the math functions lane
+ *    by lane through libm.
+ *
+ *  chain<double, raw>::altitude(d, 41.95, -88.75);
+ *  sun<simple, float>::alt_az(d, lat, lon, alt, az);
+ *
+ * Times stay in scalar_traits<T>::time_type, double for
+ * float, so growing angles are reduced to one turn before
+ * dropping to T. A pack carries its times in itself, so
+ * pack<double, N> keeps them as exact as double does;
+ * legacy rounding is for scalars only.
+ *
+ * solar.cpp instantiates chain<double, raw> and
+ * chain<double, legacy> behind the C functions of solar.h
+ * that the Ruby extension calls.
+ */
+#ifndef CALC_SUN_HPP
+#define CALC_SUN_HPP
+
+#include <cmath>
+#include "delta_t.h"
+#include "sidereal.h"
+extern "C" {
+#include "spa.h"
+}
+
+namespace calc_sun {
+
+/*
+ * Same values and types as the C macros of solar.h, long
+ * double where those are, so chain<double> rounds exactly
+ * as solar.c always has.
+ */
+constexpr long double pi = 3.1415926535897932384626433832795028841971L;
+constexpr long double r2d = 57.295779513082320876798154814105L;
+constexpr long double d2r = 0.017453292519943295769236907684886L;
+constexpr long double dj00 = 2451545.0L;
+constexpr long double rnd12 = 1000000000000.0L;
+constexpr double m2pi = 3.14159265358979323846 * 2.0;
+/* apparent altitude of the upper limb at rise and set */
+constexpr double h0 = -0.8333;
+
+/* mean anomaly polynomial in degrees, t in Julian centuries */
+constexpr double ma0 = 357.52910918;
+constexpr double ma1 = 35999.05029113889;
+constexpr double ma2 = 1.0 / -6507.592190889371;
+constexpr double ma3 = 1.0 / 26470588.235294115;
+constexpr double ma4 = 1.0 / -313315926.8929504;
+/* mean longitude in degrees, d in days */
+constexpr double ml0 = 280.4664567;
+constexpr double ml1 = 0.9856473601037645;
+/* eccentricity and obliquity (degrees), d in days */
+constexpr double ecc0 = 0.016709;
+constexpr double ecc1 = 1.151e-9;
+constexpr double ooe0 = 23.439291;
+constexpr double ooe1 = 3.563E-7;
+/* sidereal rate over the solar day */
+constexpr double sid_rate = 1.00273790935;
+
+/*
+ * time_type carries d, wide_type the products with the
+ * angle constants before they drop back to T
+ */
+template <class T>
+struct scalar_traits {
+  typedef T time_type;
+  typedef T wide_type;
+};
+
+template <>
+struct scalar_traits<double> {
+  typedef double time_type;
+  typedef long double wide_type;
+};
+
+template <>
+struct scalar_traits<float> {
+  typedef double time_type;
+  typedef float wide_type;
+};
+
+/* mask ? a : b */
+template <class M, class T>
+inline T
+select(const M &mask, const T &a, const T &b){
+  return mask ? a : b;
+}
+
+/* no rounding at all */
+struct raw {
+  template <class U>
+  static U hop(const U &v){ return v; }
+};
+
+/* roundf(v * RND12) / RND12 as calc_sun 1.2, scalars only */
+struct legacy {
+  template <class U>
+  static U hop(const U &v){
+    return U(std::round((float)(v * rnd12)) / rnd12);
+  }
+};
+
+#if defined(__GNUC__)
+/*
+ * N lanes of S. Comparisons give a pack_mask for select();
+ * the math functions the chain calls are found by ADL.
+ */
+template <class S, int N>
+struct pack {
+  typedef S vec __attribute__((vector_size(N * sizeof(S))));
+  typedef decltype(vec() < vec()) mask_vec;
+  vec v;
+
+  pack() : v() {}
+  pack(S s) : v(vec() + s) {}
+
+  S operator[](int i) const { return v[i]; }
+  S &operator[](int i){ return v[i]; }
+
+  struct mask {
+    mask_vec m;
+  };
+
+  friend pack operator+(const pack &a, const pack &b){ return from(a.v + b.v); }
+  friend pack operator-(const pack &a, const pack &b){ return from(a.v - b.v); }
+  friend pack operator*(const pack &a, const pack &b){ return from(a.v * b.v); }
+  friend pack operator/(const pack &a, const pack &b){ return from(a.v / b.v); }
+  friend pack operator-(const pack &a){ return from(-a.v); }
+  friend mask operator<(const pack &a, const pack &b){ return mask{a.v < b.v}; }
+  friend mask operator<=(const pack &a, const pack &b){ return mask{a.v <= b.v}; }
+  friend mask operator>(const pack &a, const pack &b){ return mask{a.v > b.v}; }
+  friend mask operator>=(const pack &a, const pack &b){ return mask{a.v >= b.v}; }
+
+  /* mask ? a : b, lane by lane, as a bitwise blend */
+  friend pack select(const mask &k, const pack &a, const pack &b){
+    return from((vec)((k.m & (mask_vec)a.v) | (~k.m & (mask_vec)b.v)));
+  }
+
+#define CALC_SUN_PACK1(f) \
+  friend pack f(const pack &a){ \
+    pack r; \
+    for (int i = 0; i < N; i++) r.v[i] = std::f(a.v[i]); \
+    return r; \
+  }
+#define CALC_SUN_PACK2(f) \
+  friend pack f(const pack &a, const pack &b){ \
+    pack r; \
+    for (int i = 0; i < N; i++) r.v[i] = std::f(a.v[i], b.v[i]); \
+    return r; \
+  }
+  CALC_SUN_PACK1(acos)
+  CALC_SUN_PACK1(asin)
+  CALC_SUN_PACK1(cos)
+  CALC_SUN_PACK1(floor)
+  CALC_SUN_PACK1(sin)
+  CALC_SUN_PACK1(sqrt)
+  CALC_SUN_PACK1(tan)
+  CALC_SUN_PACK2(atan2)
+  CALC_SUN_PACK2(fmod)
+#undef CALC_SUN_PACK1
+#undef CALC_SUN_PACK2
+
+ private:
+  static pack from(const vec &v){
+    pack r;
+    r.v = v;
+    return r;
+  }
+};
+#endif
+
+/* GMST angle in degrees, the shared sidereal core for doubles */
+inline double
+gmsa_deg(double d){
+  return sidereal_gmsa_inline(d);
+}
+
+template <class D>
+inline D
+gmsa_deg(const D &d){
+  using std::floor;
+  D t = d / 36525.0;
+  D a =
+  D(280.46061837) +
+  (d - floor(d)) * 360.0 +
+  d * (SIDEREAL_RATE - 360.0) +
+  t * t * (0.000387933 - t / 38710000.0);
+  return a - floor(a / 360.0) * 360.0;
+}
+
+template <class T = double, class Round = raw>
+struct chain {
+  typedef typename scalar_traits<T>::time_type time_type;
+  typedef typename scalar_traits<T>::wide_type W;
+  typedef time_type D;
+
+  /*
+   * what rise, transit and set take from their day, the
+   * same at every site: mean sidereal time (hours), right
+   * ascension (hours) and the sine of the declination at
+   * floor(d). solar.cpp keeps them in its day table.
+   */
+  struct day_state {
+    T mst, ra, sin_dec;
+  };
+
+  /* angles into 0-2pie range */
+  static T anp(const T &angle){
+    using std::fmod;
+    T w = fmod(angle, T(m2pi));
+    return select(w < T(0.0), T(w + T(m2pi)), w);
+  }
+
+  static T mean_anomaly(const D &d){
+    using std::fmod;
+    D t = d / 36525;
+    T vma = T(fmod(D(
+      (D(ma0) + t * (ma1 + t * (ma2 + t * (ma3 + t * ma4)))) * W(d2r)),
+      D(m2pi)));
+    return T(Round::hop(vma));
+  }
+
+  static T eccentricity(const D &d){
+    T ve = T(D(ecc0) - ecc1 * d);
+    return T(Round::hop(ve));
+  }
+
+  static T equation_of_center(const D &d){
+    using std::sin;
+    T mas = mean_anomaly(d);
+    T eoe = eccentricity(d);
+    T sin1a = T(sin(mas) / 4.0);
+    T sin1b = T(sin(mas) * 5.0 / 96.0);
+    T sin2a = T(sin(T(mas * 2.0)) * 11.0 / 24.0);
+    T sin2b = T(sin(T(mas * 2.0)) * 5.0 / 4.0);
+    T sin3a = T(sin(T(mas * 3.0)) * 13.0 / 12.0);
+    T sin3b = T(sin(T(mas * 3.0)) * 43.0 / 64.0);
+    T sin4 = T(sin(T(mas * 4.0)) * 103.0 / 96.0);
+    T sin5 = T(sin(T(mas * 5.0)) * 1097.0 / 960.0);
+    T ad3 = sin3a - sin1a;
+    T ad4 = sin4 - sin2a;
+    T ad5 = sin5 + sin1b - sin3b;
+    T veoc = T(eoe * (sin1a * 8.0 + eoe * (sin2b + eoe * (ad3 + eoe * (ad4 + eoe * ad5)))));
+    return T(Round::hop(veoc));
+  }
+
+  static T true_anomaly(const D &d){
+    T vta = mean_anomaly(d) + equation_of_center(d);
+    return T(Round::hop(vta));
+  }
+
+  static T mean_longitude(const D &d){
+    using std::fmod;
+    T vml = T(fmod(D((D(ml0) + ml1 * d) * W(d2r)), D(m2pi)));
+    return T(Round::hop(vml));
+  }
+
+  static T eccentric_anomaly(const D &d){
+    using std::sin;
+    using std::cos;
+    T ve = eccentricity(d);
+    T vml = mean_longitude(d);
+    T vea = T(vml + ve * sin(vml) * (1.0 + ve * cos(vml)));
+    return T(Round::hop(vea));
+  }
+
+  static T obliquity_of_ecliptic(const D &d){
+    T vooe = T((D(ooe0) - ooe1 * d) * W(d2r));
+    return T(Round::hop(vooe));
+  }
+
+  static T longitude_of_perihelion(const D &d){
+    T vlop = anp(mean_longitude(d) - mean_anomaly(d));
+    return T(Round::hop(vlop));
+  }
+
+  static T xv(const D &d){
+    using std::cos;
+    T vxv = cos(eccentric_anomaly(d)) - eccentricity(d);
+    return T(Round::hop(vxv));
+  }
+
+  static T yv(const D &d){
+    using std::sin;
+    using std::sqrt;
+    T vea = eccentric_anomaly(d);
+    T ve = eccentricity(d);
+    T vyv = T(sqrt(T(1.0 - ve * ve)) * sin(vea));
+    return T(Round::hop(vyv));
+  }
+
+  static T true_anomaly1(const D &d){
+    using std::atan2;
+    T vta = anp(atan2(yv(d), xv(d)));
+    return T(Round::hop(vta));
+  }
+
+  static T true_longitude(const D &d){
+    T vtl = anp(mean_longitude(d) + equation_of_center(d));
+    return T(Round::hop(vtl));
+  }
+
+  /* in hours */
+  static T mean_sidetime(const D &d){
+    using std::fmod;
+    T sidereal = T(gmsa_deg(d));
+    return fmod(T(Round::hop(T(sidereal / 15.0))), T(24.0));
+  }
+
+  static T gmsa0(const D &d){
+    using std::floor;
+    /* fraction of the ajd, J2000 being a whole day */
+    D ajdt = d - floor(d);
+    D d0 = select(ajdt <= D(0.5), D(floor(D(d - 0.5)) + 0.5), D(floor(d) + 0.5));
+    T msa0 = T(mean_sidetime(d0) * 15);
+    return T(Round::hop(msa0));
+  }
+
+  static T gmsa(const D &d){
+    using std::floor;
+    D ajdt = (d - 0.5) - floor(D(d - 0.5));
+    T vtr = T(ajdt * 24.0 * sid_rate * 15 * W(d2r));
+    T msar0 = T(gmsa0(d) * W(d2r));
+    T msa = T(anp(msar0 + vtr) * W(r2d));
+    return T(Round::hop(msa));
+  }
+
+  static T gmst0(const D &d){
+    T era0 = T(gmsa0(d) / 15.0);
+    return T(Round::hop(era0));
+  }
+
+  static T gmst(const D &d){
+    T vmst = T(gmsa(d) / 15.0);
+    return T(Round::hop(vmst));
+  }
+
+  static T rv(const D &d){
+    using std::sqrt;
+    T vxv = xv(d);
+    T vyv = yv(d);
+    T vrv = sqrt(vxv * vxv + vyv * vyv);
+    return T(Round::hop(vrv));
+  }
+
+  static T ecliptic_x(const D &d){
+    using std::cos;
+    T vex = rv(d) * cos(true_longitude(d));
+    return T(Round::hop(vex));
+  }
+
+  static T ecliptic_y(const D &d){
+    using std::sin;
+    T vey = rv(d) * sin(true_longitude(d));
+    return T(Round::hop(vey));
+  }
+
+  /* in hours */
+  static T right_ascension(const D &d){
+    using std::atan2;
+    using std::cos;
+    using std::fmod;
+    T vey = ecliptic_y(d);
+    T vooe = obliquity_of_ecliptic(d);
+    T vex = ecliptic_x(d);
+    T vra = fmod(T(atan2(T(vey * cos(vooe)), vex) + T(m2pi)), T(m2pi));
+    return fmod(T(Round::hop(vra * W(r2d) / 15.0)), T(24.0));
+  }
+
+  static T gha(const D &d){
+    T gmsa = T(mean_sidetime(d) * 15 * W(d2r));
+    T ra = T(right_ascension(d) * 15 * W(d2r));
+    T vgha = anp(gmsa - ra);
+    return T(Round::hop(vgha * W(r2d)));
+  }
+
+  /* in degrees */
+  static T declination(const D &d){
+    using std::atan2;
+    using std::sin;
+    using std::sqrt;
+    T vex = ecliptic_x(d);
+    T vey = ecliptic_y(d);
+    T vooe = obliquity_of_ecliptic(d);
+    T ver = sqrt(vex * vex + vey * vey);
+    T vz = vey * sin(vooe);
+    T vdec = atan2(vz, ver);
+    return T(Round::hop(vdec * W(r2d)));
+  }
+
+  /* local sidereal time from the mean sidereal time mst */
+  static T local_sidetime_of(const T &mst, const T &lon){
+    using std::fmod;
+    T vlst = T(mst + lon / 15.0);
+    return fmod(T(Round::hop(vlst)), T(24.0));
+  }
+
+  static T local_sidetime(const D &d, const T &lon){
+    return local_sidetime_of(mean_sidetime(d), lon);
+  }
+
+  static day_state day(const D &d){
+    using std::floor;
+    using std::sin;
+    D jd = floor(d);
+    day_state s;
+    s.mst = mean_sidetime(jd);
+    s.ra = right_ascension(jd);
+    s.sin_dec = sin(obliquity_of_ecliptic(jd)) * sin(true_longitude(jd));
+    return s;
+  }
+
+  /*
+   * cosine of the hour angle of rise and set, past 1 when
+   * the Sun stays below h0 all day, past -1 above
+   */
+  static T cos_h0(const day_state &s, const T &lat){
+    using std::cos;
+    using std::sin;
+    using std::sqrt;
+    T vsin_alt = sin(T(h0 * W(d2r)));
+    T vlat_r = T(lat * W(d2r));
+    T vcos_lat = cos(vlat_r);
+    T vsin_lat = sin(vlat_r);
+    T vsin_dec = s.sin_dec;
+    T vcos_dec = sqrt(T(1.0 - vsin_dec * vsin_dec));
+    return T((vsin_alt - vsin_dec * vsin_lat) / (vcos_dec * vcos_lat));
+  }
+
+  static T dlt(const day_state &s, const T &lat){
+    using std::acos;
+    T vdl = acos(cos_h0(s, lat));
+    T vdla = T(vdl * W(r2d));
+    T vdlt = T(vdla / 15.0 * 2.0);
+    return T(Round::hop(vdlt));
+  }
+
+  static T dlt(const D &d, const T &lat){
+    return dlt(day(d), lat);
+  }
+
+  static T diurnal_arc(const day_state &s, const T &lat){
+    T da = T(dlt(s, lat) / 2.0);
+    return T(Round::hop(da));
+  }
+
+  static T diurnal_arc(const D &d, const T &lat){
+    return diurnal_arc(day(d), lat);
+  }
+
+  static T t_south(const day_state &s, const T &lon){
+    using std::floor;
+    using std::fmod;
+    T lst = local_sidetime_of(s.mst, lon);
+    T vx = lst - s.ra;
+    /* vx * INV24 of the C macro, which expands to vx * 1.0 / 24.0 */
+    T vt = T(vx - 24.0 * floor(T(vx / 24.0 + 0.5)));
+    return fmod(T(Round::hop(T(12.0 - vt))), T(24.0));
+  }
+
+  static T t_south(const D &d, const T &lon){
+    return t_south(day(d), lon);
+  }
+
+  static T t_rise(const day_state &s, const T &lat, const T &lon){
+    using std::fmod;
+    T ts = t_south(s, lon);
+    T da = diurnal_arc(s, lat);
+    return fmod(T(Round::hop(T(ts - da))), T(24.0));
+  }
+
+  static T t_rise(const D &d, const T &lat, const T &lon){
+    return t_rise(day(d), lat, lon);
+  }
+
+  static T t_mid_day(const day_state &s, const T &lat, const T &lon){
+    using std::fmod;
+    (void)lat;
+    return fmod(T(Round::hop(t_south(s, lon))), T(24.0));
+  }
+
+  static T t_mid_day(const D &d, const T &lat, const T &lon){
+    return t_mid_day(day(d), lat, lon);
+  }
+
+  static T t_set(const day_state &s, const T &lat, const T &lon){
+    using std::fmod;
+    T ts = t_south(s, lon);
+    T da = diurnal_arc(s, lat);
+    return T(Round::hop(fmod(T(ts + da), T(24.0))));
+  }
+
+  static T t_set(const D &d, const T &lat, const T &lon){
+    return t_set(day(d), lat, lon);
+  }
+
+  /* ajd of the midnight starting the day of d */
+  static D day_start(const D &d){
+    using std::floor;
+    return D(floor(d) + D(dj00)) - 0.5;
+  }
+
+  /* these three return an ajd, s the day_state of d */
+  static D rise_jd(const D &d, const day_state &s, const T &lat,
+                   const T &lon){
+    return day_start(d) + D(t_rise(s, lat, lon)) / 24.0;
+  }
+
+  static D noon_jd(const D &d, const day_state &s, const T &lat,
+                   const T &lon){
+    (void)lat;
+    return day_start(d) + D(t_south(s, lon)) / 24.0;
+  }
+
+  static D set_jd(const D &d, const day_state &s, const T &lat,
+                  const T &lon){
+    T st = t_set(s, lat, lon);
+    T nt = t_mid_day(s, lat, lon);
+    st = select(st < nt, T(st + 24.0), st);
+    return day_start(d) + D(st) / 24.0;
+  }
+
+  static D rise_jd(const D &d, const T &lat, const T &lon){
+    return rise_jd(d, day(d), lat, lon);
+  }
+
+  static D noon_jd(const D &d, const T &lat, const T &lon){
+    return noon_jd(d, day(d), lat, lon);
+  }
+
+  static D set_jd(const D &d, const T &lat, const T &lon){
+    return set_jd(d, day(d), lat, lon);
+  }
+
+  static D days_from_2000(const D &d, const T &lon){
+    D days = d - D(lon) / 360;
+    return D(Round::hop(days));
+  }
+
+  static T eot(const D &d){
+    T ma = mean_anomaly(d);
+    T ta = true_anomaly(d);
+    T tl = true_longitude(d);
+    T ra = T(15.0 * W(d2r) * right_ascension(d));
+    return T(Round::hop(anp(ma - ta + tl - ra) * W(r2d)));
+  }
+
+  static T eot_jd(const D &d){
+    T jdeot = T(eot(d) / 360.0);
+    return T(Round::hop(jdeot));
+  }
+
+  static T eot_min(const D &d){
+    return T(Round::hop(T(eot(d) / 15 * 60)));
+  }
+
+  static T lha(const D &d, const T &lon){
+    T lonr = T(lon * W(d2r));
+    T vgha = T(gha(d) * W(d2r));
+    T vlha = T(anp(vgha + lonr) * W(r2d));
+    return T(Round::hop(vlha));
+  }
+
+  static T altitude(const D &d, const T &lat, const T &lon){
+    using std::asin;
+    using std::cos;
+    using std::sin;
+    T latr = T(lat * W(d2r));
+    T delta = T(declination(d) * W(d2r));
+    T vlha = T(lha(d, lon) * W(d2r));
+    T alt = T(asin(sin(latr) * sin(delta) +
+                   cos(latr) * cos(delta) * cos(vlha)) * W(r2d));
+    return T(Round::hop(alt));
+  }
+
+  static T azimuth(const D &d, const T &lat, const T &lon){
+    using std::atan2;
+    using std::cos;
+    using std::sin;
+    using std::tan;
+    T latr = T(lat * W(d2r));
+    T delta = T(declination(d) * W(d2r));
+    T vlha = T(lha(d, lon) * W(d2r));
+    T az = T(atan2(sin(vlha), cos(vlha) * sin(latr) -
+                   tan(delta) * cos(latr)) * W(r2d) + 180.0);
+    return T(Round::hop(az));
+  }
+
+  static T rise_az(const D &d, const T &lat, const T &lon){
+    return azimuth(rise_jd(d, lat, lon) - D(dj00), lat, lon);
+  }
+
+  static T noon_az(const D &d, const T &lat, const T &lon){
+    return azimuth(noon_jd(d, lat, lon) - D(dj00), lat, lon);
+  }
+
+  static T set_az(const D &d, const T &lat, const T &lon){
+    return azimuth(set_jd(d, lat, lon) - D(dj00), lat, lon);
+  }
+};
+
+/* algorithms for sun<> */
+struct simple {};
+struct spa {};
+
+template <class Algo, class T = double>
+struct sun;
+
+/* the raw chain with the trig of lat and hour angle formed once */
+template <class T>
+struct sun<simple, T> {
+  typedef chain<T, raw> base;
+  typedef typename base::time_type time_type;
+  typedef typename base::W W;
+
+  static void alt_az(const time_type &d, const T &lat, const T &lon,
+                     T &alt, T &az){
+    using std::asin;
+    using std::atan2;
+    using std::cos;
+    using std::sin;
+    using std::tan;
+    T latr = T(lat * W(d2r));
+    T delta = T(base::declination(d) * W(d2r));
+    T vlha = T(base::lha(d, lon) * W(d2r));
+    T sl = sin(latr), cl = cos(latr);
+    T ch = cos(vlha);
+    alt = T(asin(sl * sin(delta) + cl * cos(delta) * ch) * W(r2d));
+    az = T(atan2(sin(vlha), ch * sl - tan(delta) * cl) * W(r2d) + 180.0);
+  }
+};
+
+/*
+ * NREL SPA through spa_calculate(), geometric topocentric
+ * altitude (no refraction) and azimuth east of north.
+ * delta_t is TT - UT in seconds; left out, it and DUT1 come
+ * from delta_t.h per call (link delta_t.c too).
+ */
+template <>
+struct sun<spa, double> {
+  typedef double time_type;
+
+  static int alt_az(double d, double lat, double lon,
+                    double &alt, double &az, double delta_t = NAN){
+    spa_data s;
+    /* civil date of ajd = d + dj00 */
+    double ajd = d + (double)dj00 + 0.5;
+    long z = (long)std::floor(ajd);
+    double f = ajd - (double)z;
+    long a = z + 32044;
+    long b = (4 * a + 3) / 146097;
+    long c = a - 146097 * b / 4;
+    long dd = (4 * c + 3) / 1461;
+    long e = c - 1461 * dd / 4;
+    long m = (5 * e + 2) / 153;
+    double secs = f * 86400.0;
+    int rc;
+    s.day = (int)(e - (153 * m + 2) / 5 + 1);
+    s.month = (int)(m + 3 - 12 * (m / 10));
+    s.year = (int)(100 * b + dd - 4800 + m / 10);
+    s.hour = (int)(secs / 3600.0);
+    s.minute = (int)((secs - s.hour * 3600.0) / 60.0);
+    s.second = secs - s.hour * 3600.0 - s.minute * 60.0;
+    if (s.second >= 60.0) s.second = 59.999999;
+    if (s.hour > 23){
+      s.hour = 23;
+      s.minute = 59;
+      s.second = 59.999999;
+    }
+    s.timezone = 0.0;
+    s.delta_ut1 = std::isnan(delta_t) ? delta_t_dut1(d + (double)dj00) : 0.0;
+    s.delta_t = std::isnan(delta_t) ? delta_t_ajd(d + (double)dj00) : delta_t;
+    s.longitude = lon;
+    s.latitude = lat;
+    s.elevation = 0.0;
+    s.pressure = 1010.0;
+    s.temperature = 10.0;
+    s.slope = 0.0;
+    s.azm_rotation = 0.0;
+    s.atmos_refract = 0.5667;
+    s.function = SPA_ZA;
+    rc = spa_calculate(&s);
+    if (rc == 0){
+      alt = s.e0;
+      az = s.azimuth;
+    }
+    return rc;
+  }
+};
+
+} /* namespace calc_sun */
+
+#endif
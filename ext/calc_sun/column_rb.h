@@ -0,0 +1,262 @@
+/*
+ * column_rb.h
+ *
+ * Ruby glue for the *_batch methods, which read their
+ * inputs in place: a packed String of native doubles, any
+ * MemoryView exporter of doubles (Numo::DFloat, a row of a
+ * CalcSun::Buffer), an Array, or one value for every
+ * sample. Included by calc_sun.c after buffer_rb.h and
+ * precompute_rb.h.
+ */
+#ifndef CALC_SUN_COLUMN_RB_H
+#define CALC_SUN_COLUMN_RB_H
+
+#include <string.h>
+
+/* one input of a batch call, sample i at ptr + i * stride */
+typedef struct {
+  VALUE src;
+  const char *ptr;     /* packed or viewed doubles, else NULL */
+  ssize_t stride;      /* bytes, 0 repeats sample 0 */
+  long len;
+  double one;          /* a single value, as days for ajds */
+  int days;            /* ajds, read as days from J2000 */
+#ifdef HAVE_RUBY_MEMORY_VIEW_H
+  int viewed;
+  rb_memory_view_t view;
+#endif
+} column;
+
+#ifdef HAVE_RUBY_MEMORY_VIEW_H
+/* "d" with no or the host's byte order */
+static int
+col_format_ok(const char *f){
+  if (!f) return 0;
+#ifdef WORDS_BIGENDIAN
+  if (*f == '>' || *f == '!') f++;
+#else
+  if (*f == '<') f++;
+#endif
+  else if (*f == '=' || *f == '@') f++;
+  return strcmp(f, "d") == 0;
+}
+/* a view of doubles with at most one dimension past 1 */
+static void
+col_view(column *c, const char *name){
+  const rb_memory_view_t *v = &c->view;
+  ssize_t i, step = v->item_size;
+  if (!col_format_ok(v->format) || v->item_size != sizeof(double))
+    rb_raise(rb_eTypeError, "%s: MemoryView of format %s, not doubles",
+             name, v->format ? v->format : "C");
+  c->ptr = v->data;
+  c->len = 1;
+  c->stride = 0;
+  for (i = v->ndim - 1; i >= 0; i--){
+    ssize_t s = v->strides ? v->strides[i] : step;
+    if (v->shape[i] != 1){
+      if (c->len != 1)
+        rb_raise(rb_eArgError, "%s: MemoryView of more than one row", name);
+      c->len = (long)v->shape[i];
+      c->stride = s;
+    }
+    step *= v->shape[i];
+  }
+}
+#endif
+/*
+ * reads v into c. nothing is copied but a single value;
+ * a view taken here is let go by col_close().
+ */
+static void
+col_open(column *c, VALUE v, int days, const char *name){
+  c->src = v;
+  c->ptr = NULL;
+  c->stride = 0;
+  c->len = 1;
+  c->days = days;
+  if (RB_TYPE_P(v, T_STRING)){
+    long bytes = RSTRING_LEN(v);
+    if (bytes % (long)sizeof(double))
+      rb_raise(rb_eArgError, "%s: packed String of %ld bytes, not whole doubles",
+               name, bytes);
+    /*
+     * rise_set_batch may leave the GVL while reading it: read
+     * a frozen copy, which shares the bytes and keeps them
+     * when v changes, rather than lock v, which fails when
+     * another column or thread has it locked
+     */
+    if (!OBJ_FROZEN(v)) c->src = v = rb_str_new_frozen(v);
+    c->ptr = RSTRING_PTR(v);
+    c->stride = sizeof(double);
+    c->len = bytes / (long)sizeof(double);
+  }
+  else if (RB_TYPE_P(v, T_ARRAY))
+    c->len = RARRAY_LEN(v);
+#ifdef HAVE_RUBY_MEMORY_VIEW_H
+  else if (!RB_FLOAT_TYPE_P(v) && !RB_INTEGER_TYPE_P(v) &&
+           rb_memory_view_available_p(v)){
+    if (!rb_memory_view_get(v, &c->view, RUBY_MEMORY_VIEW_FORMAT | RUBY_MEMORY_VIEW_STRIDES))
+      rb_raise(rb_eTypeError, "%s: no MemoryView", name);
+    c->viewed = 1;
+    col_view(c, name);
+  }
+#endif
+  else
+    c->one = days ? get_days(v) : NUM2DBL(v);
+  if (c->len == 1) c->stride = 0;
+}
+
+static void
+col_close(column *c){
+#ifdef HAVE_RUBY_MEMORY_VIEW_H
+  if (c->viewed){
+    c->viewed = 0;
+    rb_memory_view_release(&c->view);
+  }
+#endif
+}
+/* sample i of c; a column of one repeats it */
+static inline double
+col_at(const column *c, long i){
+  double v;
+  if (c->ptr){
+    memcpy(&v, c->ptr + i * c->stride, sizeof v);
+    return c->days ? v - DJ00 : v;
+  }
+  if (!RB_TYPE_P(c->src, T_ARRAY)) return c->one;
+  if (c->len == 1) i = 0;
+  return c->days ? get_days(rb_ary_entry(c->src, i)) : NUM2DBL(rb_ary_entry(c->src, i));
+}
+
+enum { BATCH_ALTITUDE, BATCH_AZIMUTH, BATCH_DECLINATION, BATCH_RISE_SET };
+
+typedef struct {
+  VALUE self;
+  int what, ncols;
+  column col[3];
+} batch_args;
+
+static VALUE
+batch_close(VALUE arg){
+  batch_args *a = (batch_args *)arg;
+  int k;
+  for (k = 0; k < a->ncols; k++) col_close(&a->col[k]);
+  return Qnil;
+}
+
+static VALUE
+batch_body(VALUE arg){
+  static const char *names[] = {"ajds", "lats", "lons"};
+  batch_args *a = (batch_args *)arg;
+  VALUE vbuf;
+  long i, n = 1;
+  int k, mode = get_mode(a->self);
+  double *out;
+  for (k = 0; k < a->ncols; k++){
+    col_open(&a->col[k], a->col[k].src, k == 0, names[k]);
+    if (a->col[k].len == 1) continue;
+    if (n != 1 && a->col[k].len != n)
+      rb_raise(rb_eArgError, "%s has %ld samples, not %ld",
+               names[k], a->col[k].len, n);
+    n = a->col[k].len;
+  }
+  if (a->what == BATCH_RISE_SET){
+    vbuf = buffer_new(3, n, &out);
+    for (i = 0; i < n; i++){
+      double d = col_at(&a->col[0], i), lat = col_at(&a->col[1], i);
+      double lon = col_at(&a->col[2], i), v[3];
+      if (!precomputed(a->self, d, lat, lon, mode, v) &&
+          !stored_rts(a->self, d, lat, lon, mode, v) &&
+          !shared_rts(a->self, d, lat, lon, mode, v)){
+        v[0] = solar_rise_jd(d, lat, lon, mode);
+        v[1] = solar_noon_jd(d, lat, lon, mode);
+        v[2] = solar_set_jd(d, lat, lon, mode);
+      }
+      out[i] = v[0];
+      out[n + i] = v[1];
+      out[2 * n + i] = v[2];
+    }
+    return vbuf;
+  }
+  vbuf = buffer_new(1, n, &out);
+  for (i = 0; i < n; i++){
+    double d = col_at(&a->col[0], i), v;
+    if (a->what == BATCH_DECLINATION)
+      v = solar_declination(d, mode);
+    else if (a->what == BATCH_ALTITUDE)
+      v = solar_altitude(d, col_at(&a->col[1], i), col_at(&a->col[2], i), mode);
+    else
+      v = solar_azimuth(d, col_at(&a->col[1], i), col_at(&a->col[2], i), mode);
+    out[i] = mode == SOLAR_ROUND12 ? solar_round12(v) : v;
+  }
+  return vbuf;
+}
+
+static VALUE
+batch_run(VALUE self, int what, int ncols, VALUE vajds, VALUE vlats, VALUE vlons){
+  batch_args a;
+  memset(&a, 0, sizeof a);
+  a.self = self;
+  a.what = what;
+  a.ncols = ncols;
+  a.col[0].src = vajds;
+  a.col[1].src = vlats;
+  a.col[2].src = vlons;
+  return rb_ensure(batch_body, (VALUE)&a, batch_close, (VALUE)&a);
+}
+/*
+ * call-seq:
+ *  altitude_batch(ajds, lats, lons)
+ *
+ * given Astronomical Julian Day Numbers and local
+ * Latitudes and Longitudes, each a packed String of native
+ * doubles (Array#pack('d*')), a one dimensional MemoryView
+ * of doubles such as a Numo::DFloat, strided or not, an
+ * Array, or one value for all,
+ * returns a CalcSun::Buffer of shape [1, samples] of the
+ * altitudes of the Sun in degrees, as altitude gives them.
+ * inputs of one sample repeat for all, the others must
+ * agree in length. packed and viewed inputs are read in
+ * place, no Float made per sample.
+ *
+ */
+static VALUE func_altitude_batch(VALUE self, VALUE vajds, VALUE vlats, VALUE vlons){
+  return batch_run(self, BATCH_ALTITUDE, 3, vajds, vlats, vlons);
+}
+/*
+ * call-seq:
+ *  azimuth_batch(ajds, lats, lons)
+ *
+ * as altitude_batch, with the azimuths of the Sun in
+ * degrees, as azimuth gives them.
+ *
+ */
+static VALUE func_azimuth_batch(VALUE self, VALUE vajds, VALUE vlats, VALUE vlons){
+  return batch_run(self, BATCH_AZIMUTH, 3, vajds, vlats, vlons);
+}
+/*
+ * call-seq:
+ *  declination_batch(ajds)
+ *
+ * as altitude_batch, with the declinations of the Sun in
+ * degrees, as declination gives them.
+ *
+ */
+static VALUE func_declination_batch(VALUE self, VALUE vajds){
+  return batch_run(self, BATCH_DECLINATION, 1, vajds, Qnil, Qnil);
+}
+/*
+ * call-seq:
+ *  rise_set_batch(ajds, lats, lons)
+ *
+ * as altitude_batch, with a CalcSun::Buffer of shape
+ * [3, samples], the rise, transit and set Astronomical
+ * Julian Day Numbers as rise_jd, noon_jd and set_jd give
+ * them, NaN where the Sun does not rise or set.
+ *
+ */
+static VALUE func_rise_set_batch(VALUE self, VALUE vajds, VALUE vlats, VALUE vlons){
+  return batch_run(self, BATCH_RISE_SET, 3, vajds, vlats, vlons);
+}
+
+#endif
@@ -0,0 +1,277 @@
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "delta_t.h"
+
+#define MJD0 2400000.5
+/* mean Gregorian year in days and the ajd of 2000.0 */
+#define YEAR_DAYS 365.2425
+#define AJD_2000 2451544.5
+
+/* observed Delta T every 5 years from 1900 to 2025 */
+#define OBS_FIRST 1900.0
+#define OBS_STEP 5.0
+static const double obs_dt[] = {
+  -2.79, 3.86, 10.46, 17.20, 21.16, 23.62, 24.02, 23.93, 24.33,
+  26.77, 29.15, 31.07, 33.15, 35.73, 40.18, 45.48, 50.54, 54.34,
+  56.86, 60.78, 63.83, 64.69, 66.07, 67.64, 69.36, 69.20
+};
+#define OBS_N (sizeof obs_dt / sizeof obs_dt[0])
+#define OBS_LAST (OBS_FIRST + OBS_STEP * (OBS_N - 1))
+
+/* MJD from which TAI - UTC is 10, 11, ... seconds */
+static const long leap_mjd[] = {
+  41317, 41499, 41683, 42048, 42413, 42778, 43144, 43509, 43874,
+  44239, 44786, 45151, 45516, 46247, 47161, 47892, 48257, 48804,
+  49169, 49534, 50083, 50630, 51179, 53736, 54832, 56109, 57204,
+  57754
+};
+#define LEAP_N (sizeof leap_mjd / sizeof leap_mjd[0])
+
+/* daily Delta T from an IERS file, continuous across leap seconds */
+typedef struct iers_table {
+  struct iers_table *next;  /* retired list */
+  long mjd0;
+  size_t n;
+  double dt[1];
+} iers_table;
+
+/*
+ * the published table is never written again. Lookups on
+ * other threads or Ractors may still hold a replaced one,
+ * so it is retired, not freed: a few hundred KB a reload.
+ */
+static iers_table *iers;
+static iers_table *retired;
+
+#ifdef __GNUC__
+# define IERS_LOAD() __atomic_load_n(&iers, __ATOMIC_ACQUIRE)
+# define IERS_SWAP(t) __atomic_exchange_n(&iers, (t), __ATOMIC_ACQ_REL)
+# define RETIRED_LOAD() __atomic_load_n(&retired, __ATOMIC_RELAXED)
+# define RETIRED_CAS(old, t) \
+  __atomic_compare_exchange_n(&retired, (old), (t), 1, \
+                              __ATOMIC_RELEASE, __ATOMIC_RELAXED)
+#else
+/* no atomics: single threaded use only */
+static iers_table *
+iers_swap(iers_table *t){
+  iers_table *old = iers;
+  iers = t;
+  return old;
+}
+# define IERS_LOAD() iers
+# define IERS_SWAP(t) iers_swap(t)
+# define RETIRED_LOAD() retired
+# define RETIRED_CAS(old, t) (retired = (t), 1)
+#endif
+
+static void
+iers_retire(iers_table *t){
+  if (!t) return;
+  t->next = RETIRED_LOAD();
+  while (!RETIRED_CAS(&t->next, t))
+    ;
+}
+
+static double
+year_of_ajd(double ajd){
+  return 2000.0 + (ajd - AJD_2000) / YEAR_DAYS;
+}
+
+/* Espenak and Meeus, valid -1999 to 3000 */
+static double
+espenak_meeus(double y){
+  double u, t;
+  if (y < -500.0){
+    u = (y - 1820.0) / 100.0;
+    return -20.0 + 32.0 * u * u;
+  }
+  if (y < 500.0){
+    u = y / 100.0;
+    return 10583.6 + u * (-1014.41 + u * (33.78311 + u * (-5.952053 +
+      u * (-0.1798452 + u * (0.022174192 + u * 0.0090316521)))));
+  }
+  if (y < 1600.0){
+    u = (y - 1000.0) / 100.0;
+    return 1574.2 + u * (-556.01 + u * (71.23472 + u * (0.319781 +
+      u * (-0.8503463 + u * (-0.005050998 + u * 0.0083572073)))));
+  }
+  if (y < 1700.0){
+    t = y - 1600.0;
+    return 120.0 + t * (-0.9808 + t * (-0.01532 + t / 7129.0));
+  }
+  if (y < 1800.0){
+    t = y - 1700.0;
+    return 8.83 + t * (0.1603 + t * (-0.0059285 + t * (0.00013336 -
+      t / 1174000.0)));
+  }
+  if (y < 1860.0){
+    t = y - 1800.0;
+    return 13.72 + t * (-0.332447 + t * (0.0068612 + t * (0.0041116 +
+      t * (-0.00037436 + t * (0.0000121272 + t * (-0.0000001699 +
+      t * 0.000000000875))))));
+  }
+  if (y < 1900.0){
+    t = y - 1860.0;
+    return 7.62 + t * (0.5737 + t * (-0.251754 + t * (0.01680668 +
+      t * (-0.0004473624 + t / 233174.0))));
+  }
+  if (y < 1920.0){
+    t = y - 1900.0;
+    return -2.79 + t * (1.494119 + t * (-0.0598939 + t * (0.0061966 -
+      t * 0.000197)));
+  }
+  if (y < 1941.0){
+    t = y - 1920.0;
+    return 21.20 + t * (0.84493 + t * (-0.076100 + t * 0.0020936));
+  }
+  if (y < 1961.0){
+    t = y - 1950.0;
+    return 29.07 + t * (0.407 + t * (-1.0 / 233.0 + t / 2547.0));
+  }
+  if (y < 1986.0){
+    t = y - 1975.0;
+    return 45.45 + t * (1.067 + t * (-1.0 / 260.0 - t / 718.0));
+  }
+  if (y < 2005.0){
+    t = y - 2000.0;
+    return 63.86 + t * (0.3345 + t * (-0.060374 + t * (0.0017275 +
+      t * (0.000651814 + t * 0.00002373599))));
+  }
+  if (y < 2050.0){
+    t = y - 2000.0;
+    return 62.92 + t * (0.32217 + t * 0.005589);
+  }
+  u = (y - 1820.0) / 100.0;
+  if (y < 2150.0)
+    return -20.0 + 32.0 * u * u - 0.5628 * (2150.0 - y);
+  return -20.0 + 32.0 * u * u;
+}
+
+double
+delta_t_model(double y){
+  if (y >= OBS_FIRST && y < OBS_LAST){
+    double x = (y - OBS_FIRST) / OBS_STEP;
+    size_t i = (size_t)x;
+    double f = x - (double)i;
+    return obs_dt[i] + f * (obs_dt[i + 1] - obs_dt[i]);
+  }
+  if (y >= OBS_LAST && y < 2050.0){
+    /* fade the polynomial's offset from the last observation out by 2050 */
+    double off = obs_dt[OBS_N - 1] - espenak_meeus(OBS_LAST);
+    return espenak_meeus(y) + off * (2050.0 - y) / (2050.0 - OBS_LAST);
+  }
+  return espenak_meeus(y);
+}
+
+/* interpolated Delta T of the IERS table, NAN outside it */
+static double
+iers_dt(double ajd){
+  const iers_table *t = IERS_LOAD();
+  double x;
+  size_t i;
+  if (!t) return NAN;
+  x = ajd - MJD0 - (double)t->mjd0;
+  if (!(x >= 0.0 && x < (double)(t->n - 1))) return NAN;
+  i = (size_t)x;
+  return t->dt[i] + (x - (double)i) * (t->dt[i + 1] - t->dt[i]);
+}
+
+double
+delta_t_ajd(double ajd){
+  double dt = iers_dt(ajd);
+  return isnan(dt) ? delta_t_model(year_of_ajd(ajd)) : dt;
+}
+
+void
+delta_t_batch(const double *ajd, double *dt, size_t n){
+  size_t i;
+  for (i = 0; i < n; i++)
+    dt[i] = delta_t_ajd(ajd[i]);
+}
+
+double
+delta_t_tai_utc(double ajd){
+  double mjd = ajd - MJD0;
+  size_t lo = 0, hi = LEAP_N;
+  if (mjd < (double)leap_mjd[0]) return 0.0;
+  while (hi - lo > 1){
+    size_t mid = (lo + hi) / 2;
+    if (mjd < (double)leap_mjd[mid]) hi = mid; else lo = mid;
+  }
+  return 10.0 + (double)lo;
+}
+
+double
+delta_t_dut1(double ajd){
+  double dt = iers_dt(ajd);
+  /* TT - UTC = 32.184 + TAI - UTC, less Delta T */
+  return isnan(dt) ? 0.0 : 32.184 + delta_t_tai_utc(ajd) - dt;
+}
+
+/*
+ * finals columns (1 based): 8-15 MJD, 58 I or P flag,
+ * 59-68 UT1 - UTC. Lines without a value end the usable data.
+ */
+static int
+parse_finals(const char *line, long *mjd, double *dut1){
+  char buf[16];
+  char *end;
+  size_t len = strlen(line);
+  if (len < 68 || (line[57] != 'I' && line[57] != 'P')) return 0;
+  memcpy(buf, line + 7, 8);
+  buf[8] = '\0';
+  *mjd = (long)floor(strtod(buf, &end) + 0.5);
+  if (end == buf) return 0;
+  memcpy(buf, line + 58, 10);
+  buf[10] = '\0';
+  *dut1 = strtod(buf, &end);
+  return end != buf;
+}
+
+long
+delta_t_load_iers(const char *path){
+  FILE *f = fopen(path, "r");
+  char line[256];
+  iers_table *t = NULL;
+  size_t cap = 0;
+  long mjd, last = 0;
+  double dut1;
+  if (!f) return -1;
+  while (fgets(line, sizeof line, f)){
+    if (!parse_finals(line, &mjd, &dut1)) continue;
+    if (t && mjd != last + 1) break;
+    if (!t || t->n == cap){
+      iers_table *nt;
+      cap = cap ? 2 * cap : 4096;
+      nt = realloc(t, sizeof *t + cap * sizeof t->dt[0]);
+      if (!nt){
+        free(t);
+        fclose(f);
+        errno = ENOMEM;
+        return -1;
+      }
+      if (!t){
+        nt->mjd0 = mjd;
+        nt->n = 0;
+      }
+      t = nt;
+    }
+    t->dt[t->n++] = 32.184 + delta_t_tai_utc((double)mjd + MJD0) - dut1;
+    last = mjd;
+  }
+  fclose(f);
+  if (!t || t->n < 2){
+    free(t);
+    return 0;
+  }
+  iers_retire(IERS_SWAP(t));
+  return (long)t->n;
+}
+
+void
+delta_t_unload_iers(void){
+  iers_retire(IERS_SWAP(NULL));
+}
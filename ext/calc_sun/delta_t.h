@@ -0,0 +1,56 @@
+/*
+ * delta_t.h
+ *
+ * Delta T (TT - UT1) and DUT1 (UT1 - UTC) in seconds.
+ * No Ruby dependency.
+ *
+ * Built in model, by decimal year:
+ *  1900 to 2025  observed values every 5 years, interpolated
+ *  elsewhere     the Espenak and Meeus polynomials (NASA
+ *                eclipse predictions), with the 2025 to 2050
+ *                piece blended into the last observed value
+ *
+ * delta_t_load_iers() reads daily UT1 - UTC from an IERS
+ * finals file (finals2000A.all, finals.data and the like).
+ * Where that table covers an instant it is used for both
+ * values, otherwise DUT1 is 0.
+ *
+ * Lookups index straight into uniform tables, O(1).
+ * Loading and unloading publish the table atomically and
+ * are safe against concurrent lookups, which see the old
+ * table or the new one; the replaced table is kept to exit.
+ */
+#ifndef CALC_SUN_DELTA_T_H
+#define CALC_SUN_DELTA_T_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Delta T of the built in model at decimal year y */
+double delta_t_model(double year);
+/* Delta T at an ajd (UT) */
+double delta_t_ajd(double ajd);
+/* Delta T for n ajds */
+void delta_t_batch(const double *ajd, double *dt, size_t n);
+/* UT1 - UTC at an ajd, 0 where no IERS table covers it */
+double delta_t_dut1(double ajd);
+/* TAI - UTC at an ajd from the leap second table, 0 before 1972 */
+double delta_t_tai_utc(double ajd);
+
+/*
+ * replace the IERS table with the daily values of path.
+ * returns the number of days loaded, or -1 with errno set
+ * when the file cannot be read; 0 keeps the old table.
+ */
+long delta_t_load_iers(const char *path);
+/* drop a loaded IERS table, back to the model alone */
+void delta_t_unload_iers(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,258 @@
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "engine.h"
+#include "ajd_parse.h"
+#include "delta_t.h"
+#include "solar.h"
+#include "solar_f32.h"
+#include "spa_geo.h"
+#include "spa_rts.h"
+#include "sunriset.h"
+
+/*
+ * measured with libcalcsun/characterize.c, errors rounded up;
+ * costs on an AVX-512 x86-64, only their order matters
+ */
+const engine_entry engine_table[] = {
+  {ENGINE_POSITION, ENGINE_FAST,     "fast",     3.0,    35.0},
+  {ENGINE_POSITION, ENGINE_SUNRISET, "sunriset", 0.013,  470.0},
+  {ENGINE_POSITION, ENGINE_CHAIN,    "chain",    3.0,    3300.0},
+  {ENGINE_POSITION, ENGINE_SPA,      "spa",      0.0003, 10500.0},
+  {ENGINE_RISE_SET, ENGINE_SUNRISET, "sunriset", 250.0,  320.0},
+  {ENGINE_RISE_SET, ENGINE_CHAIN,    "chain",    150.0,  4000.0},
+  {ENGINE_RISE_SET, ENGINE_SPA,      "spa",      3.0,    41000.0},
+};
+const size_t engine_table_size = sizeof engine_table / sizeof engine_table[0];
+
+const engine_entry *
+engine_select(int quantity, double tolerance){
+  const engine_entry *best = NULL;
+  size_t i;
+  for (i = 0; i < engine_table_size; i++){
+    const engine_entry *e = &engine_table[i];
+    if (e->quantity != quantity || !(e->error <= tolerance)) continue;
+    if (!best || e->cost < best->cost) best = e;
+  }
+  return best;
+}
+
+static int
+fast_alt_az(size_t n, const double *d, const double *lat, const double *lon,
+            double *alt, double *az){
+  float *f = calloc(4 * n + 1, sizeof *f);
+  size_t i;
+  if (!f){
+    errno = ENOMEM;
+    return -1;
+  }
+  for (i = 0; i < n; i++){
+    f[i] = (float)lat[i];
+    f[n + i] = (float)lon[i];
+  }
+  solar_altaz_f32(d, f, f + n, f + 2 * n, f + 3 * n, n);
+  for (i = 0; i < n; i++){
+    alt[i] = f[2 * n + i];
+    az[i] = f[3 * n + i];
+  }
+  free(f);
+  return 0;
+}
+
+static int
+spa_alt_az(size_t n, const double *d, const double *lat, const double *lon,
+           double *alt, double *az){
+  static const spa_atmos atm = {1010.0, 10.0, 0.5667};
+  spa_geo g;
+  size_t i;
+  for (i = 0; i < n; i++){
+    /* samples at one instant share the geocentric Sun */
+    if (i == 0 || d[i] != d[i - 1]){
+      double ajd = d[i] + DJ00;
+      if (spa_geo_at(&g, ajd + delta_t_dut1(ajd) / 86400.0,
+                     delta_t_ajd(ajd)) != 0){
+        errno = EDOM;
+        return -1;
+      }
+    }
+    spa_observe(&g, &atm, 1, lat + i, lon + i, NULL, alt + i, NULL, az + i);
+  }
+  return 0;
+}
+
+int
+engine_alt_az(int engine, size_t n, const double *d, const double *lat,
+              const double *lon, double *alt, double *az){
+  size_t i;
+  switch (engine){
+  case ENGINE_FAST:
+    return fast_alt_az(n, d, lat, lon, alt, az);
+  case ENGINE_SUNRISET:
+    sunriset_alt_az_n(n, d, lat, lon, alt, az);
+    return 0;
+  case ENGINE_SPA:
+    return spa_alt_az(n, d, lat, lon, alt, az);
+  case ENGINE_CHAIN:
+    for (i = 0; i < n; i++){
+      alt[i] = solar_altitude(d[i], lat[i], lon[i], SOLAR_RAW);
+      az[i] = solar_azimuth(d[i], lat[i], lon[i], SOLAR_RAW);
+    }
+    return 0;
+  }
+  errno = EINVAL;
+  return -1;
+}
+
+/* SPA altitude of the Sun's upper limb above its refracted horizon */
+static int
+spa_above(double ajd, double lat, double lon, double *h){
+  static const spa_atmos atm = {1010.0, 10.0, 0.5667};
+  spa_geo g;
+  if (spa_geo_at(&g, ajd + delta_t_dut1(ajd) / 86400.0,
+                 delta_t_ajd(ajd)) != 0) return -1;
+  spa_observe(&g, &atm, 1, &lat, &lon, NULL, h, NULL, NULL);
+  *h += 0.26667 + 0.5667;
+  return 0;
+}
+
+/* the horizon crossing nearest ajd, a few secant steps */
+static int
+spa_cross(double *ajd, double lat, double lon){
+  double a = *ajd, b = a + 60.0 / 86400.0, fa, fb;
+  int k;
+  if (spa_above(a, lat, lon, &fa) != 0 || spa_above(b, lat, lon, &fb) != 0)
+    return -1;
+  for (k = 0; k < 4 && fb != fa; k++){
+    double c = b - fb * (b - a) / (fb - fa);
+    a = b;
+    fa = fb;
+    b = c;
+    if (spa_above(b, lat, lon, &fb) != 0) return -1;
+  }
+  *ajd = b;
+  return 0;
+}
+
+/* SPA rise, transit and set hours of UT date jdn into sd */
+static int
+spa_date(spa_rts_window *w, spa_data *sd, long jdn, double lat, double lon){
+  long y;
+  ajd_jdn_to_civil(jdn, &y, &sd->month, &sd->day);
+  sd->year = (int)y;
+  sd->latitude = lat;
+  sd->longitude = lon;
+  sd->delta_t = delta_t_ajd((double)jdn - 0.5);
+  sd->delta_ut1 = delta_t_dut1((double)jdn - 0.5);
+  return spa_rts_day(w, sd);
+}
+
+static int
+spa_rise_set(size_t n, const double *d, const double *lat, const double *lon,
+             double *rise, double *transit, double *set, signed char *status){
+  spa_rts_window w;
+  spa_data sd;
+  size_t i;
+  spa_rts_init(&w);
+  memset(&sd, 0, sizeof sd);
+  sd.pressure = 1010.0;
+  sd.temperature = 10.0;
+  sd.atmos_refract = 0.5667;
+  sd.function = SPA_ZA_RTS;
+  for (i = 0; i < n; i++){
+    /* the civil date whose noon the chain's day holds */
+    long jdn = (long)floor(d[i]) + 2451545;
+    double start = (double)jdn - 0.5, tr, r, st;
+    if (spa_date(&w, &sd, jdn, lat[i], lon[i]) != 0) goto fail;
+    tr = sd.suntransit;
+    r = sd.sunrise;
+    st = sd.sunset;
+    if (transit) transit[i] = start + tr / 24.0;
+    if (r < 0.0){
+      if (rise) rise[i] = NAN;
+      if (set) set[i] = NAN;
+      if (status)
+        status[i] = spa_rts_polar(&w, &sd) > 0 ? ENGINE_DAY_UP : ENGINE_DAY_DOWN;
+      continue;
+    }
+    if (status) status[i] = ENGINE_DAY_RISES;
+    /* SPA wraps the rise before 0h and the set after 24h of
+    * this transit into the UT date and interpolates them at
+    * the wrapped hour, minutes off; solve for those again
+    */
+    if (r > tr && rise){
+      rise[i] = start + (r - 24.0) / 24.0;
+      if (spa_cross(rise + i, lat[i], lon[i]) != 0) goto fail;
+    }
+    else if (rise)
+      rise[i] = start + r / 24.0;
+    if (st < tr && set){
+      set[i] = start + (st + 24.0) / 24.0;
+      if (spa_cross(set + i, lat[i], lon[i]) != 0) goto fail;
+    }
+    else if (set)
+      set[i] = start + st / 24.0;
+  }
+  return 0;
+fail:
+  errno = EDOM;
+  return -1;
+}
+
+/* sunriset_rise_set_n() with the return code of each day */
+static void
+sunriset_status(size_t n, const double *d, const double *lat,
+                const double *lon, double *rise, double *transit, double *set,
+                signed char *status){
+  size_t i;
+  for (i = 0; i < n; i++){
+    double start = floor(d[i]) + DJ00 - 0.5, r, s;
+    int rc = sunriset_rise_set(d[i], lat[i], lon[i], SUNRISET_RISE_SET, 1, &r, &s);
+    if (transit) transit[i] = start + (r + s) / 48.0;
+    if (rise) rise[i] = rc ? NAN : start + r / 24.0;
+    if (set) set[i] = rc ? NAN : start + s / 24.0;
+    status[i] = rc > 0 ? ENGINE_DAY_UP : rc < 0 ? ENGINE_DAY_DOWN : ENGINE_DAY_RISES;
+  }
+}
+
+int
+engine_rise_set(int engine, size_t n, const double *d, const double *lat,
+                const double *lon, double *rise, double *transit,
+                double *set){
+  return engine_rise_set_status(engine, n, d, lat, lon, rise, transit, set,
+                                NULL);
+}
+
+int
+engine_rise_set_status(int engine, size_t n, const double *d,
+                       const double *lat, const double *lon, double *rise,
+                       double *transit, double *set, signed char *status){
+  size_t i;
+  switch (engine){
+  case ENGINE_SUNRISET:
+    if (status)
+      sunriset_status(n, d, lat, lon, rise, transit, set, status);
+    else
+      sunriset_rise_set_n(n, d, lat, lon, SUNRISET_RISE_SET, 1,
+                          rise, transit, set, NULL);
+    return 0;
+  case ENGINE_SPA:
+    return spa_rise_set(n, d, lat, lon, rise, transit, set, status);
+  case ENGINE_CHAIN:
+  case ENGINE_FAST:
+    /* the chain's rise and set have no batch kernel */
+    for (i = 0; i < n; i++){
+      if (rise) rise[i] = solar_rise_jd(d[i], lat[i], lon[i], SOLAR_RAW);
+      if (transit) transit[i] = solar_noon_jd(d[i], lat[i], lon[i], SOLAR_RAW);
+      if (set) set[i] = solar_set_jd(d[i], lat[i], lon[i], SOLAR_RAW);
+      if (status){
+        double c = solar_cos_h0(d[i], lat[i], SOLAR_RAW);
+        status[i] = c < -1.0 ? ENGINE_DAY_UP : c > 1.0 ? ENGINE_DAY_DOWN :
+          ENGINE_DAY_RISES;
+      }
+    }
+    return 0;
+  }
+  errno = EINVAL;
+  return -1;
+}
@@ -0,0 +1,98 @@
+/*
+ * engine.h
+ *
+ * Picks the cheapest of the CalcSun chain, its single
+ * precision batch kernel, Schlyter's sunriset and NREL SPA
+ * that meets an error budget, from a table of measured
+ * error and cost per engine, and runs it. No Ruby
+ * dependency.
+ *
+ * Position errors are degrees on the sky against SPA, the
+ * larger of the altitude error and the azimuth error times
+ * cos(altitude), over 1900 to 2100 and latitudes -89 to 89.
+ * Rise and set errors are seconds against SPA over 1900 to
+ * 2100 and latitudes -60 to 60; every engine does worse
+ * closer to the poles. SPA's own errors are its stated
+ * 0.0003 degrees and its rise and set against the roots of
+ * its altitude. libcalcsun/characterize.c measures them.
+ */
+#ifndef CALC_SUN_ENGINE_H
+#define CALC_SUN_ENGINE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+  ENGINE_POSITION,          /* altitude and azimuth, degrees */
+  ENGINE_RISE_SET           /* rise, transit and set, seconds */
+};
+
+enum {
+  ENGINE_CHAIN,             /* solar.h, double precision */
+  ENGINE_FAST,              /* solar_f32.h batch kernel */
+  ENGINE_SUNRISET,          /* sunriset.h */
+  ENGINE_SPA                /* spa_geo.h and spa_rts.h */
+};
+
+typedef struct {
+  int quantity;             /* ENGINE_POSITION or ENGINE_RISE_SET */
+  int engine;
+  const char *name;
+  double error;             /* worst error, degrees or seconds */
+  double cost;              /* nanoseconds a sample */
+} engine_entry;
+
+extern const engine_entry engine_table[];
+extern const size_t engine_table_size;
+
+/*
+ * the cheapest entry for quantity whose error is within
+ * tolerance, NULL when none is.
+ */
+const engine_entry *engine_select(int quantity, double tolerance);
+
+/*
+ * altitude and azimuth in degrees, no refraction, for n
+ * samples of d days from J2000 at lat, lon in degrees.
+ * returns 0, or -1 with errno set.
+ */
+int engine_alt_az(int engine, size_t n, const double *d, const double *lat,
+                  const double *lon, double *alt, double *az);
+
+/*
+ * rise, transit and set ajds of the day of each d, as the
+ * chain takes it, rise before and set after transit; rise
+ * and set NaN when the Sun does not rise or set, transit
+ * given every day. Any output may be NULL.
+ * returns 0, or -1 with errno set.
+ */
+int engine_rise_set(int engine, size_t n, const double *d, const double *lat,
+                    const double *lon, double *rise, double *transit,
+                    double *set);
+
+/* how a day went, as engine_rise_set_status() gives it */
+enum {
+  ENGINE_DAY_RISES,         /* rises and sets */
+  ENGINE_DAY_UP,            /* stays up all day */
+  ENGINE_DAY_DOWN           /* stays down all day */
+};
+
+/*
+ * engine_rise_set() and, into status when not NULL, how
+ * each day went, decided by the engine that found no
+ * crossing: the chain's hour angle of rise and set,
+ * sunriset's return code, SPA's altitude at transit.
+ */
+int engine_rise_set_status(int engine, size_t n, const double *d,
+                           const double *lat, const double *lon, double *rise,
+                           double *transit, double *set,
+                           signed char *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,4 +1,22 @@
 require 'mkmf'
 extension_name = 'calc_sun/calc_sun'
 dir_config(extension_name)
+# lets the batch kernels' selects and sqrt vectorize,
+# nothing here reads floating point flags or errno
+%w[-fno-math-errno -fno-trapping-math].each do |flag|
+  $CFLAGS << ' ' << flag if try_cflags(flag)
+end
+# solar.cpp includes the C++11 calc_sun.hpp,
+# older g++ default to C++98
+$CXXFLAGS << ' -std=gnu++11' if RbConfig::CONFIG['GCC'] == 'yes'
+# Ruby 3.0 and later run the extension in any Ractor
+have_header('ruby/ractor.h')
+# and export batch buffers through MemoryView
+have_header('ruby/memory_view.h')
+have_func('rb_ext_ractor_safe', 'ruby.h')
+# CalcSun::SharedCache, shm_open is in librt before glibc 2.34
+have_library('rt', 'shm_open') unless have_func('shm_open', 'sys/mman.h')
+# CalcSun#write_profiles reserves the file's blocks before
+# mapping it, else writes zeros
+have_func('posix_fallocate', 'fcntl.h')
 create_makefile(extension_name)
\ No newline at end of file
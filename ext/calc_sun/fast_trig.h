@@ -0,0 +1,219 @@
+/*
+ * fast_trig.h
+ *
+ * Branch free trig for the batch kernels in three tiers.
+ * Everything is static inline and free of libm calls so
+ * loops over arrays vectorize.
+ *
+ *  FT_TRIG_1E6   single precision, ft_*f
+ *  FT_TRIG_1E9   double precision, ft_*
+ *  FT_TRIG_FULL  libm
+ *
+ * Bounds against libm, checked by libcalcsun's make check
+ * (every float in range for the single precision tier,
+ * a dense sweep plus the reduction edges for double):
+ *  ft_sincosf  |x| < 8 pi      abs error < 1e-6
+ *  ft_atan2f                   abs error < 2e-6 rad
+ *  ft_asinf    |x| <= 1        abs error < 2e-6 rad
+ *  ft_sincos   |x| < 2^20      abs error < 1e-9
+ *  ft_sincosd  |x| < 2^40 deg  abs error < 1e-9
+ *  ft_atan2, ft_asin, ft_acos  abs error < 1e-9 rad
+ *  ft_anp                      abs error < 1e-15 rel
+ *
+ * The solar angles arrive in degrees and grow with time, so
+ * ft_sincosd reduces by quadrants of 90 degrees, exact in
+ * double, before converting to radians.
+ *
+ * The kernels of solar_f32.c and solar_f64.c use the *f
+ * forms, ft_sincosd and ft_atan2, reducing in degrees.
+ * ft_sincos, ft_asin, ft_acos and ft_anp, the radian
+ * forms, serve callers of libcalcsun, which installs this
+ * header; no kernel here calls them.
+ */
+#ifndef CALC_SUN_FAST_TRIG_H
+#define CALC_SUN_FAST_TRIG_H
+
+#include <math.h>
+
+#define FT_PI_F      3.14159265358979f
+#define FT_PI_2_F    1.57079632679490f
+#define FT_2_PI_F    0.63661977236758f
+/* pi / 2 split in two for Cody-Waite reduction */
+#define FT_PI_2_HI_F 1.5707963705062866f
+#define FT_PI_2_LO_F -4.371139000186243e-8f
+
+#define FT_PI        3.14159265358979323846
+#define FT_PI_2      1.57079632679489661923
+#define FT_PI_6      0.52359877559829887308
+#define FT_2PI       6.28318530717958647692
+#define FT_2_PI      0.63661977236758134308
+#define FT_SQRT3     1.73205080756887729353
+/* pi / 2 in two parts, the first with 33 bits, fdlibm's */
+#define FT_PI_2_HI   1.57079632673412561417e+00
+#define FT_PI_2_LO   6.07710050650619224932e-11
+
+/* accuracy tiers */
+enum {
+  FT_TRIG_1E6,
+  FT_TRIG_1E9,
+  FT_TRIG_FULL
+};
+
+/*
+ * floor of |x| < 2^51 by the round to nearest magic number,
+ * unlike floor() it stays inline and vectorizes
+ */
+static inline double
+ft_floor(double x){
+  double r = (x + 6755399441055744.0) - 6755399441055744.0;
+  return r > x ? r - 1.0 : r;
+}
+
+/* nearest integer of |x| < 2^51 */
+static inline double
+ft_round(double x){
+  return (x + 6755399441055744.0) - 6755399441055744.0;
+}
+
+/* sin and cos of x, reduced by quadrant of pi / 2 */
+static inline void
+ft_sincosf(float x, float *s, float *c){
+  int k = (int)(x * FT_2_PI_F + (x >= 0.0f ? 0.5f : -0.5f));
+  float r = (x - (float)k * FT_PI_2_HI_F) - (float)k * FT_PI_2_LO_F;
+  float r2 = r * r;
+  float ps =
+  r + r * r2 * (-1.6666654611e-1f +
+    r2 * (8.3321608736e-3f +
+    r2 * -1.9515295891e-4f));
+  float pc =
+  1.0f - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f +
+    r2 * (-1.388731625493765e-3f +
+    r2 * 2.443315711809948e-5f));
+  int q = k & 3;
+  float sv = (q & 1) ? pc : ps;
+  float cv = (q & 1) ? ps : pc;
+  *s = (q & 2) ? -sv : sv;
+  *c = ((q + 1) & 2) ? -cv : cv;
+}
+
+/* atan of 0 <= a <= 1 */
+static inline float
+ft_atan01f(float a){
+  float a2 = a * a;
+  return a * (0.99997726f +
+    a2 * (-0.33262347f +
+    a2 * (0.19354346f +
+    a2 * (-0.11643287f +
+    a2 * (0.05265332f +
+    a2 * -0.01172120f)))));
+}
+
+static inline float
+ft_atan2f(float y, float x){
+  float ax = x < 0.0f ? -x : x;
+  float ay = y < 0.0f ? -y : y;
+  float mx = ax > ay ? ax : ay;
+  float mn = ax > ay ? ay : ax;
+  float r = ft_atan01f(mn / (mx > 0.0f ? mx : 1.0f));
+  r = ay > ax ? FT_PI_2_F - r : r;
+  r = x < 0.0f ? FT_PI_F - r : r;
+  return y < 0.0f ? -r : r;
+}
+
+static inline float
+ft_asinf(float x){
+  float c = 1.0f - x * x;
+  return ft_atan2f(x, sqrtf(c > 0.0f ? c : 0.0f));
+}
+
+/*
+ * sin and cos of |r| <= pi / 4 (a hair over is fine),
+ * Taylor to r^11 and r^10, next terms 7e-12 and 1.2e-10
+ */
+static inline void
+ft_sincos_kernel(double r, int q, double *s, double *c){
+  double r2 = r * r;
+  double ps = r + r * r2 * (-1.0 / 6.0 +
+    r2 * (1.0 / 120.0 +
+    r2 * (-1.0 / 5040.0 +
+    r2 * (1.0 / 362880.0 +
+    r2 * (-1.0 / 39916800.0)))));
+  double pc = 1.0 + r2 * (-0.5 +
+    r2 * (1.0 / 24.0 +
+    r2 * (-1.0 / 720.0 +
+    r2 * (1.0 / 40320.0 +
+    r2 * (-1.0 / 3628800.0)))));
+  double sv = (q & 1) ? pc : ps;
+  double cv = (q & 1) ? ps : pc;
+  *s = (q & 2) ? -sv : sv;
+  *c = ((q + 1) & 2) ? -cv : cv;
+}
+
+/* sin and cos of x radians, Cody-Waite reduction */
+static inline void
+ft_sincos(double x, double *s, double *c){
+  double k = ft_round(x * FT_2_PI);
+  double r = (x - k * FT_PI_2_HI) - k * FT_PI_2_LO;
+  ft_sincos_kernel(r, (int)(long long)k, s, c);
+}
+
+/* sin and cos of x degrees, reduced exactly by 90 degrees */
+static inline void
+ft_sincosd(double x, double *s, double *c){
+  double k = ft_round(x * (1.0 / 90.0));
+  ft_sincos_kernel((x - 90.0 * k) * (FT_PI / 180.0), (int)(long long)k, s, c);
+}
+
+/*
+ * atan of 0 <= a <= 1, above 2 - sqrt(3) shifted down by
+ * pi / 6, so |t| <= 0.268 and Taylor to t^13 leaves 1.7e-10
+ */
+static inline double
+ft_atan01(double a){
+  int big = a > 0.26794919243112270;
+  double t = big ? (a * FT_SQRT3 - 1.0) / (a + FT_SQRT3) : a;
+  double t2 = t * t;
+  double p = t + t * t2 * (-1.0 / 3.0 +
+    t2 * (1.0 / 5.0 +
+    t2 * (-1.0 / 7.0 +
+    t2 * (1.0 / 9.0 +
+    t2 * (-1.0 / 11.0 +
+    t2 * (1.0 / 13.0))))));
+  return big ? FT_PI_6 + p : p;
+}
+
+static inline double
+ft_atan2(double y, double x){
+  double ax = x < 0.0 ? -x : x;
+  double ay = y < 0.0 ? -y : y;
+  double mx = ax > ay ? ax : ay;
+  double mn = ax > ay ? ay : ax;
+  double r = ft_atan01(mn / (mx > 0.0 ? mx : 1.0));
+  r = ay > ax ? FT_PI_2 - r : r;
+  r = x < 0.0 ? FT_PI - r : r;
+  /* signbit so atan2(-0.0, -1) is -pi as in libm */
+  return signbit(y) ? -r : r;
+}
+
+/* (1 - x)(1 + x) keeps the cosine accurate near |x| = 1 */
+static inline double
+ft_asin(double x){
+  double c = (1.0 - x) * (1.0 + x);
+  return ft_atan2(x, sqrt(c > 0.0 ? c : 0.0));
+}
+
+static inline double
+ft_acos(double x){
+  double c = (1.0 - x) * (1.0 + x);
+  return ft_atan2(sqrt(c > 0.0 ? c : 0.0), x);
+}
+
+/* angle into 0 to 2 pi without fmod, as anp() */
+static inline double
+ft_anp(double a){
+  double w = a - FT_2PI * ft_floor(a * (1.0 / FT_2PI));
+  w = w < 0.0 ? w + FT_2PI : w;
+  return w >= FT_2PI ? w - FT_2PI : w;
+}
+
+#endif
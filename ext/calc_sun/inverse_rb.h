@@ -0,0 +1,183 @@
+/*
+ * inverse_rb.h
+ *
+ * Ruby glue for the inverse queries of sun_inverse.h: the
+ * time of an azimuth, of an altitude and of the highest
+ * altitude, one at a time or over columns of days and
+ * sites. Included by calc_sun.c after column_rb.h.
+ */
+#ifndef CALC_SUN_INVERSE_RB_H
+#define CALC_SUN_INVERSE_RB_H
+
+#include "sun_inverse.h"
+
+enum { INVERSE_AZIMUTH, INVERSE_ALTITUDE, INVERSE_MAX };
+
+typedef struct {
+  VALUE self;
+  int what, rising;
+  double target;
+  column col[3];
+} inverse_args;
+
+/* true for :rising, false for :setting */
+static int
+get_branch(VALUE vbranch){
+  if (NIL_P(vbranch) || vbranch == sym_rising) return 1;
+  if (vbranch == sym_setting) return 0;
+  rb_raise(rb_eArgError, "branch must be :rising or :setting");
+  return 0;
+}
+
+static VALUE
+inverse_ajd(double t){
+  return isnan(t) ? Qnil : DBL2NUM(t + DJ00);
+}
+
+static VALUE
+inverse_close(VALUE arg){
+  inverse_args *a = (inverse_args *)arg;
+  int k;
+  for (k = 0; k < 3; k++) col_close(&a->col[k]);
+  return Qnil;
+}
+
+static VALUE
+inverse_body(VALUE arg){
+  static const char *names[] = {"ajds", "lats", "lons"};
+  inverse_args *a = (inverse_args *)arg;
+  VALUE vbuf;
+  long i, n = 1;
+  int k, mode = get_mode(a->self);
+  double *out;
+  for (k = 0; k < 3; k++){
+    col_open(&a->col[k], a->col[k].src, k == 0, names[k]);
+    if (a->col[k].len == 1) continue;
+    if (n != 1 && a->col[k].len != n)
+      rb_raise(rb_eArgError, "%s has %ld samples, not %ld",
+               names[k], a->col[k].len, n);
+    n = a->col[k].len;
+  }
+  vbuf = buffer_new(a->what == INVERSE_MAX ? 2 : 1, n, &out);
+  for (i = 0; i < n; i++){
+    double d = col_at(&a->col[0], i), lat = col_at(&a->col[1], i);
+    double lon = col_at(&a->col[2], i), t, alt;
+    if (a->what == INVERSE_AZIMUTH)
+      t = sun_azimuth_time(d, lat, lon, a->target, mode);
+    else if (a->what == INVERSE_ALTITUDE)
+      t = sun_altitude_time(d, lat, lon, a->target, a->rising, mode);
+    else{
+      t = sun_max_altitude(d, lat, lon, mode, &alt);
+      out[n + i] = mode == SOLAR_ROUND12 ? solar_round12(alt) : alt;
+    }
+    out[i] = t + DJ00;
+  }
+  return vbuf;
+}
+
+static VALUE
+inverse_run(VALUE self, int what, VALUE vajds, VALUE vlats, VALUE vlons,
+            double target, int rising){
+  inverse_args a;
+  memset(&a, 0, sizeof a);
+  a.self = self;
+  a.what = what;
+  a.target = target;
+  a.rising = rising;
+  a.col[0].src = vajds;
+  a.col[1].src = vlats;
+  a.col[2].src = vlons;
+  return rb_ensure(inverse_body, (VALUE)&a, inverse_close, (VALUE)&a);
+}
+/*
+ * call-seq:
+ *  azimuth_time(ajd, lat, lon, azimuth)
+ *
+ * given an Astronomical Julian Day Number, local Latitude
+ * and Longitude and an azimuth in degrees east of north,
+ * returns the Astronomical Julian Day Number when the Sun
+ * stands at that azimuth in the solar day centred on the
+ * transit noon_jd gives, the earlier of two, or nil when
+ * it does not. solved by Newton's method on the formula of
+ * azimuth with its time derivative taken analytically, to
+ * 1e-9 days, in a handful of calls of the chain.
+ *
+ */
+static VALUE func_azimuth_time(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon, VALUE vaz){
+  return inverse_ajd(sun_azimuth_time(get_days(vajd), NUM2DBL(vlat), NUM2DBL(vlon),
+                                      NUM2DBL(vaz), get_mode(self)));
+}
+/*
+ * call-seq:
+ *  altitude_time(ajd, lat, lon, altitude, branch = :rising)
+ *
+ * as azimuth_time, the Astronomical Julian Day Number when
+ * the Sun climbs through altitude degrees before its
+ * highest point, or with :setting sinks through it after,
+ * or nil when it stays above or below all day. altitudes
+ * are geometric, so -0.833 for the rise of the upper limb
+ * with refraction.
+ *
+ */
+static VALUE func_altitude_time(int argc, VALUE *argv, VALUE self){
+  VALUE vajd, vlat, vlon, valt, vbranch;
+  rb_scan_args(argc, argv, "41", &vajd, &vlat, &vlon, &valt, &vbranch);
+  return inverse_ajd(sun_altitude_time(get_days(vajd), NUM2DBL(vlat), NUM2DBL(vlon),
+                                       NUM2DBL(valt), get_branch(vbranch),
+                                       get_mode(self)));
+}
+/*
+ * call-seq:
+ *  max_altitude(ajd, lat, lon)
+ *
+ * as azimuth_time, returns [ajd, altitude], when the Sun
+ * is highest in the solar day and that altitude in degrees
+ * as altitude gives it, close to the transit.
+ *
+ */
+static VALUE func_max_altitude(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
+  int mode = get_mode(self);
+  double alt, t = sun_max_altitude(get_days(vajd), NUM2DBL(vlat), NUM2DBL(vlon),
+                                   mode, &alt);
+  return rb_assoc_new(inverse_ajd(t), prec_num(alt, mode));
+}
+/*
+ * call-seq:
+ *  azimuth_time_batch(ajds, lats, lons, azimuth)
+ *
+ * azimuth_time for columns of days and sites read as
+ * altitude_batch reads them, returns a CalcSun::Buffer of
+ * shape [1, samples] of Astronomical Julian Day Numbers,
+ * NaN for nil.
+ *
+ */
+static VALUE func_azimuth_time_batch(VALUE self, VALUE vajds, VALUE vlats, VALUE vlons, VALUE vaz){
+  return inverse_run(self, INVERSE_AZIMUTH, vajds, vlats, vlons, NUM2DBL(vaz), 0);
+}
+/*
+ * call-seq:
+ *  altitude_time_batch(ajds, lats, lons, altitude, branch = :rising)
+ *
+ * as azimuth_time_batch, for altitude_time.
+ *
+ */
+static VALUE func_altitude_time_batch(int argc, VALUE *argv, VALUE self){
+  VALUE vajds, vlats, vlons, valt, vbranch;
+  rb_scan_args(argc, argv, "41", &vajds, &vlats, &vlons, &valt, &vbranch);
+  return inverse_run(self, INVERSE_ALTITUDE, vajds, vlats, vlons, NUM2DBL(valt),
+                     get_branch(vbranch));
+}
+/*
+ * call-seq:
+ *  max_altitude_batch(ajds, lats, lons)
+ *
+ * as azimuth_time_batch, for max_altitude, a
+ * CalcSun::Buffer of shape [2, samples], the times and the
+ * altitudes.
+ *
+ */
+static VALUE func_max_altitude_batch(VALUE self, VALUE vajds, VALUE vlats, VALUE vlons){
+  return inverse_run(self, INVERSE_MAX, vajds, vlats, vlons, 0.0, 0);
+}
+
+#endif
@@ -0,0 +1,240 @@
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "precompute.h"
+#include "solar.h"
+
+typedef struct {
+  double lat, lon;
+  size_t site;
+} site_key;
+
+struct precompute {
+  size_t nsites, ndays, nslices;
+  long day0;
+  int mode, nthreads;
+  double *lat, *lon;
+  site_key *order;         /* sites by lat, then lon */
+  double *val;             /* rise, transit, set by site, then day */
+  unsigned char *ready;    /* by slice */
+  size_t next, done;       /* slices handed out and finished */
+  int stop;
+  unsigned wake;           /* bumped by precompute_interrupt() */
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  pthread_t *threads;
+};
+
+static int
+cmp_site(const void *a, const void *b){
+  const site_key *x = a, *y = b;
+  if (x->lat != y->lat) return x->lat < y->lat ? -1 : 1;
+  if (x->lon != y->lon) return x->lon < y->lon ? -1 : 1;
+  return x->site < y->site ? -1 : x->site > y->site;
+}
+
+/* the first site at lat, lon, or -1 */
+static long
+find_site(const precompute *p, double lat, double lon){
+  size_t lo = 0, hi = p->nsites;
+  while (lo < hi){
+    size_t mid = lo + (hi - lo) / 2;
+    const site_key *k = &p->order[mid];
+    if (k->lat < lat || (k->lat == lat && k->lon < lon))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo < p->nsites && p->order[lo].lat == lat && p->order[lo].lon == lon)
+    return (long)p->order[lo].site;
+  return -1;
+}
+
+/* slice s: days of block s / nsites at site s % nsites */
+static void
+run_slice(precompute *p, size_t s){
+  size_t site = s % p->nsites, k0 = s / p->nsites * PRECOMPUTE_BLOCK, k;
+  size_t k1 = k0 + PRECOMPUTE_BLOCK < p->ndays ? k0 + PRECOMPUTE_BLOCK : p->ndays;
+  double lat = p->lat[site], lon = p->lon[site];
+  double *v = p->val + 3 * (site * p->ndays + k0);
+  for (k = k0; k < k1; k++, v += 3){
+    double d = (double)(p->day0 + (long)k);
+    v[0] = solar_rise_jd(d, lat, lon, p->mode);
+    v[1] = solar_noon_jd(d, lat, lon, p->mode);
+    v[2] = solar_set_jd(d, lat, lon, p->mode);
+  }
+}
+
+static void *
+worker(void *arg){
+  precompute *p = arg;
+  for (;;){
+    size_t s;
+    pthread_mutex_lock(&p->lock);
+    if (p->stop || p->next >= p->nslices){
+      pthread_mutex_unlock(&p->lock);
+      return NULL;
+    }
+    s = p->next++;
+    pthread_mutex_unlock(&p->lock);
+    run_slice(p, s);
+    pthread_mutex_lock(&p->lock);
+    p->ready[s] = 1;
+    p->done++;
+    pthread_cond_broadcast(&p->cond);
+    pthread_mutex_unlock(&p->lock);
+  }
+}
+
+static void
+release(precompute *p){
+  free(p->lat);
+  free(p->order);
+  free(p->val);
+  free(p->ready);
+  free(p->threads);
+  free(p);
+}
+
+precompute *
+precompute_start(size_t nsites, const double *lat, const double *lon,
+                 long day0, size_t ndays, int mode, int nthreads){
+  precompute *p = calloc(1, sizeof *p);
+  size_t i, nblocks = (ndays + PRECOMPUTE_BLOCK - 1) / PRECOMPUTE_BLOCK;
+  int t;
+  if (!p){
+    errno = ENOMEM;
+    return NULL;
+  }
+  /* the table, 3 * nsites * ndays doubles, is the largest block */
+  if (ndays && nsites > (SIZE_MAX - 1) / (3 * sizeof *p->val) / ndays){
+    free(p);
+    errno = EFBIG;
+    return NULL;
+  }
+  if (nthreads <= 0) nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (nthreads <= 0) nthreads = 1;
+  p->nsites = nsites;
+  p->ndays = ndays;
+  p->nslices = nsites * nblocks;
+  p->day0 = day0;
+  p->mode = mode;
+  p->lat = malloc(2 * nsites * sizeof *p->lat + 1);
+  p->order = malloc(nsites * sizeof *p->order + 1);
+  p->val = malloc(3 * nsites * ndays * sizeof *p->val + 1);
+  p->ready = calloc(p->nslices + 1, 1);
+  p->threads = calloc((size_t)nthreads, sizeof *p->threads);
+  if (!p->lat || !p->order || !p->val || !p->ready || !p->threads){
+    release(p);
+    errno = ENOMEM;
+    return NULL;
+  }
+  p->lon = p->lat + nsites;
+  memcpy(p->lat, lat, nsites * sizeof *lat);
+  memcpy(p->lon, lon, nsites * sizeof *lon);
+  for (i = 0; i < nsites; i++){
+    p->order[i].lat = lat[i];
+    p->order[i].lon = lon[i];
+    p->order[i].site = i;
+  }
+  qsort(p->order, nsites, sizeof *p->order, cmp_site);
+  pthread_mutex_init(&p->lock, NULL);
+  pthread_cond_init(&p->cond, NULL);
+  for (t = 0; t < nthreads; t++)
+    if (pthread_create(&p->threads[p->nthreads], NULL, worker, p) == 0)
+      p->nthreads++;
+  if (p->nthreads == 0){
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->cond);
+    release(p);
+    errno = EAGAIN;
+    return NULL;
+  }
+  return p;
+}
+
+void
+precompute_free(precompute *p){
+  int t;
+  if (!p) return;
+  pthread_mutex_lock(&p->lock);
+  p->stop = 1;
+  pthread_mutex_unlock(&p->lock);
+  for (t = 0; t < p->nthreads; t++)
+    pthread_join(p->threads[t], NULL);
+  pthread_mutex_destroy(&p->lock);
+  pthread_cond_destroy(&p->cond);
+  release(p);
+}
+
+size_t
+precompute_done(precompute *p){
+  size_t n;
+  pthread_mutex_lock(&p->lock);
+  n = p->done;
+  pthread_mutex_unlock(&p->lock);
+  return n;
+}
+
+size_t
+precompute_slices(const precompute *p){
+  return p->nslices;
+}
+
+size_t
+precompute_size(const precompute *p){
+  return sizeof *p + p->nsites * (2 * sizeof *p->lat + sizeof *p->order) +
+    3 * p->nsites * p->ndays * sizeof *p->val + p->nslices;
+}
+
+int
+precompute_wait(precompute *p){
+  unsigned w;
+  int r;
+  pthread_mutex_lock(&p->lock);
+  w = p->wake;
+  while (p->done < p->nslices && p->wake == w)
+    pthread_cond_wait(&p->cond, &p->lock);
+  r = p->done == p->nslices;
+  pthread_mutex_unlock(&p->lock);
+  return r;
+}
+
+void
+precompute_interrupt(precompute *p){
+  pthread_mutex_lock(&p->lock);
+  p->wake++;
+  pthread_cond_broadcast(&p->cond);
+  pthread_mutex_unlock(&p->lock);
+}
+
+int
+precompute_lookup(precompute *p, double d, double lat, double lon,
+                  int mode, int wait, double *rise, double *transit,
+                  double *set){
+  double k = floor(d) - (double)p->day0;
+  size_t s;
+  const double *v;
+  unsigned w;
+  long site;
+  int r;
+  if (mode != p->mode || !(k >= 0.0 && k < (double)p->ndays)) return 0;
+  if ((site = find_site(p, lat, lon)) < 0) return 0;
+  s = (size_t)k / PRECOMPUTE_BLOCK * p->nsites + (size_t)site;
+  pthread_mutex_lock(&p->lock);
+  w = p->wake;
+  while (wait && !p->ready[s] && p->wake == w)
+    pthread_cond_wait(&p->cond, &p->lock);
+  r = p->ready[s];
+  pthread_mutex_unlock(&p->lock);
+  if (!r) return -1;
+  v = p->val + 3 * ((size_t)site * p->ndays + (size_t)k);
+  if (rise) *rise = v[0];
+  if (transit) *transit = v[1];
+  if (set) *set = v[2];
+  return 1;
+}
@@ -0,0 +1,71 @@
+/*
+ * precompute.h
+ *
+ * Rise, transit and set of the CalcSun chain for a set of
+ * sites over a span of days, filled in the background by a
+ * pool of native threads. No Ruby dependency.
+ *
+ * The work is cut into slices of one site and up to
+ * PRECOMPUTE_BLOCK days, handed out earliest days first, so
+ * the near dates of every site are ready soonest. A lookup
+ * waits for its own slice only. The chain works on whole
+ * days (floor(d)), so a stored value is exactly what the
+ * chain gives for any d of that day.
+ */
+#ifndef CALC_SUN_PRECOMPUTE_H
+#define CALC_SUN_PRECOMPUTE_H
+
+#include <stddef.h>
+
+#define PRECOMPUTE_BLOCK 32
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct precompute precompute;
+
+/*
+ * starts nthreads workers (0 for one a core) on nsites
+ * sites lat, lon in degrees, for the days day0 to
+ * day0 + ndays - 1 (floor(d), days from J2000), chain
+ * precision mode as in solar.h.
+ * returns NULL with errno set on no memory or no threads,
+ * EFBIG when the table's size does not fit a size_t.
+ */
+precompute *precompute_start(size_t nsites, const double *lat,
+                             const double *lon, long day0, size_t ndays,
+                             int mode, int nthreads);
+/* stops the workers after their current slice and frees p */
+void precompute_free(precompute *p);
+
+/* slices finished and in all, and bytes held */
+size_t precompute_done(precompute *p);
+size_t precompute_slices(const precompute *p);
+size_t precompute_size(const precompute *p);
+
+/*
+ * waits until every slice is done; returns 1, or 0 when
+ * precompute_interrupt() woke it first.
+ */
+int precompute_wait(precompute *p);
+/* wakes every waiter of p, for a caller's interrupt check */
+void precompute_interrupt(precompute *p);
+
+/*
+ * rise, transit and set ajds of the day of d at the site
+ * lat, lon when p holds it with precision mode, with wait
+ * set waiting for that slice. returns 1 with the values,
+ * 0 when p does not hold them, -1 when the slice is not
+ * done and wait is clear or precompute_interrupt() woke
+ * it. rise and set are NaN where the chain gives NaN.
+ */
+int precompute_lookup(precompute *p, double d, double lat, double lon,
+                      int mode, int wait, double *rise, double *transit,
+                      double *set);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
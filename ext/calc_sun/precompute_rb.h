@@ -0,0 +1,282 @@
+/*
+ * precompute_rb.h
+ *
+ * Ruby glue for CalcSun#precompute_async and
+ * CalcSun::Precompute. Included by calc_sun.c after
+ * get_days(), get_mode(), the solar.h declarations,
+ * shm_rb.h and profile_rb.h.
+ */
+#ifndef CALC_SUN_PRECOMPUTE_RB_H
+#define CALC_SUN_PRECOMPUTE_RB_H
+
+#include <errno.h>
+#include <ruby/thread.h>
+#include "precompute.h"
+
+static VALUE cPrecompute;
+static ID id_precomputed;
+
+/* a CalcSun::Precompute, its table gone once released */
+typedef struct {
+  precompute *p;
+  VALUE owner;         /* the CalcSun whose @precomputed lists it */
+  int busy;            /* calls waiting on p without the GVL */
+  int released;
+} pre_ref;
+
+static void
+pre_mark(void *r){
+  rb_gc_mark(((pre_ref *)r)->owner);
+}
+
+static void
+pre_free(void *r){
+  precompute_free(((pre_ref *)r)->p);
+  xfree(r);
+}
+
+static size_t
+pre_memsize(const void *r){
+  const precompute *p = ((const pre_ref *)r)->p;
+  return sizeof(pre_ref) + (p ? precompute_size(p) : 0);
+}
+
+static const rb_data_type_t pre_type = {
+  "CalcSun::Precompute",
+  {pre_mark, pre_free, pre_memsize,},
+  0, 0,
+  RUBY_TYPED_FREE_IMMEDIATELY,
+};
+
+static pre_ref *
+get_ref(VALUE vpre){
+  return rb_check_typeddata(vpre, &pre_type);
+}
+
+static precompute *
+get_pre(VALUE vpre){
+  pre_ref *ref = get_ref(vpre);
+  if (ref->released) rb_raise(rb_eArgError, "released CalcSun::Precompute");
+  return ref->p;
+}
+/* after a wait without the GVL, frees a released table none waits on */
+static void
+pre_unbusy(pre_ref *ref){
+  if (--ref->busy == 0 && ref->released){
+    precompute_free(ref->p);
+    ref->p = NULL;
+  }
+}
+
+typedef struct {
+  precompute *p;
+  double d, lat, lon, v[3];
+  int mode, r;
+} pre_lookup_t;
+
+static void *
+pre_wait_nogvl(void *arg){
+  precompute *p = arg;
+  return precompute_wait(p) ? p : NULL;
+}
+
+static void *
+pre_lookup_nogvl(void *arg){
+  pre_lookup_t *l = arg;
+  l->r = precompute_lookup(l->p, l->d, l->lat, l->lon, l->mode, 1,
+                           l->v, l->v + 1, l->v + 2);
+  return NULL;
+}
+
+static void
+pre_ubf(void *arg){
+  precompute_interrupt((precompute *)arg);
+}
+/*
+ * rise, transit and set of the day of d from a precompute
+ * of self, waiting without the GVL for a slice still being
+ * filled. returns 0 when none holds them.
+ */
+static int
+precomputed(VALUE self, double d, double lat, double lon, int mode,
+            double v[3]){
+  VALUE vlist = rb_attr_get(self, id_precomputed);
+  long i;
+  if (NIL_P(vlist)) return 0;
+  for (i = 0; i < RARRAY_LEN(vlist); i++){
+    VALUE vpre = rb_ary_entry(vlist, i);
+    pre_ref *ref = get_ref(vpre);
+    pre_lookup_t l;
+    l.p = ref->p;
+    l.d = d;
+    l.lat = lat;
+    l.lon = lon;
+    l.mode = mode;
+    l.r = precompute_lookup(l.p, d, lat, lon, mode, 0, v, v + 1, v + 2);
+    if (l.r == 0) continue;
+    while (l.r < 0){
+      ref->busy++;
+      rb_thread_call_without_gvl(pre_lookup_nogvl, &l, pre_ubf, l.p);
+      pre_unbusy(ref);
+      rb_thread_check_ints();
+      if (l.r > 0){
+        v[0] = l.v[0];
+        v[1] = l.v[1];
+        v[2] = l.v[2];
+      }
+      /* released meanwhile, by a trap or another thread */
+      else if (!(l.p = ref->p))
+        return 0;
+    }
+    RB_GC_GUARD(vpre);
+    return 1;
+  }
+  return 0;
+}
+/* rise (0), transit (1) or set (2) ajd as rise_jd and the
+* like give it, from a precompute when one holds it, else
+* from the profile store, else the shared cache, when set
+*/
+static double
+rts_jd(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon, int k){
+  int mode = get_mode(self);
+  double d = get_days(vajd), lat = NUM2DBL(vlat), lon = NUM2DBL(vlon), v[3];
+  if (precomputed(self, d, lat, lon, mode, v) ||
+      stored_rts(self, d, lat, lon, mode, v) ||
+      shared_rts(self, d, lat, lon, mode, v)) return v[k];
+  if (k == 0) return solar_rise_jd(d, lat, lon, mode);
+  if (k == 1) return solar_noon_jd(d, lat, lon, mode);
+  return solar_set_jd(d, lat, lon, mode);
+}
+/*
+ * call-seq:
+ *  precompute_async(sites, ajds, threads = nil)
+ *
+ * given an Array of [lat, lon] sites and a Range of
+ * Astronomical Julian Day Numbers, starts filling rise,
+ * transit and set for every site and day of the range on
+ * native threads, one a core by default, outside the GVL,
+ * and returns a CalcSun::Precompute at once.
+ * later rise, rise_jd, noon, noon_jd, set and set_jd
+ * calls of this object at those sites and days, at the
+ * same precision, read the table, waiting only for their
+ * own slice if it is not filled yet. sites must be given
+ * as the same Floats.
+ *
+ */
+static VALUE func_precompute_async(int argc, VALUE *argv, VALUE self){
+  VALUE vsites, vrange, vthreads, vtmp, vpre, vlist;
+  long i, n, day0, day1;
+  int mode = get_mode(self);
+  double *buf;
+  pre_ref *ref;
+  rb_scan_args(argc, argv, "21", &vsites, &vrange, &vthreads);
+  Check_Type(vsites, T_ARRAY);
+  n = RARRAY_LEN(vsites);
+  get_day_range(vrange, &day0, &day1);
+  buf = ALLOCV(vtmp, 2 * n * sizeof(double) + 1);
+  for (i = 0; i < n; i++){
+    VALUE vsite = rb_ary_entry(vsites, i);
+    Check_Type(vsite, T_ARRAY);
+    if (RARRAY_LEN(vsite) != 2) rb_raise(rb_eArgError, "sites must be [lat, lon]");
+    buf[i] = NUM2DBL(rb_ary_entry(vsite, 0));
+    buf[n + i] = NUM2DBL(rb_ary_entry(vsite, 1));
+  }
+  vpre = TypedData_Make_Struct(cPrecompute, pre_ref, &pre_type, ref);
+  ref->owner = self;
+  ref->p = precompute_start((size_t)n, buf, buf + n, day0,
+                            (size_t)(day1 - day0 + 1), mode,
+                            NIL_P(vthreads) ? 0 : NUM2INT(vthreads));
+  ALLOCV_END(vtmp);
+  if (!ref->p && errno == EFBIG)
+    rb_raise(rb_eArgError, "%ld sites over %ld days do not fit in memory",
+             n, day1 - day0 + 1);
+  if (!ref->p) rb_sys_fail("precompute_async");
+  vlist = rb_attr_get(self, id_precomputed);
+  if (NIL_P(vlist)){
+    vlist = rb_ary_new();
+    rb_ivar_set(self, id_precomputed, vlist);
+  }
+  rb_ary_push(vlist, vpre);
+  return vpre;
+}
+/*
+ * call-seq:
+ *  ready?
+ *
+ * true when every slice is filled.
+ *
+ */
+static VALUE pre_ready_p(VALUE self){
+  precompute *p = get_pre(self);
+  return precompute_done(p) == precompute_slices(p) ? Qtrue : Qfalse;
+}
+/*
+ * call-seq:
+ *  progress
+ *
+ * the share of slices filled, 0.0 to 1.0.
+ *
+ */
+static VALUE pre_progress(VALUE self){
+  precompute *p = get_pre(self);
+  size_t n = precompute_slices(p);
+  return DBL2NUM(n ? (double)precompute_done(p) / (double)n : 1.0);
+}
+/*
+ * call-seq:
+ *  wait
+ *
+ * blocks, without the GVL, until every slice is filled.
+ * returns self.
+ *
+ */
+static VALUE pre_wait(VALUE self){
+  pre_ref *ref = get_ref(self);
+  precompute *p = get_pre(self);
+  for (;;){
+    void *done;
+    ref->busy++;
+    done = rb_thread_call_without_gvl(pre_wait_nogvl, p, pre_ubf, p);
+    pre_unbusy(ref);
+    if (done || !ref->p) return self;
+    rb_thread_check_ints();
+    if (!ref->p) return self;
+  }
+}
+/*
+ * call-seq:
+ *  release
+ *
+ * drops the table: the CalcSun that made it no longer
+ * reads it, its threads stop and its memory is freed, at
+ * once or when the last call waiting on it returns. other
+ * methods raise ArgumentError after. returns nil.
+ *
+ */
+static VALUE pre_release(VALUE self){
+  pre_ref *ref = get_ref(self);
+  VALUE vlist;
+  if (ref->released) return Qnil;
+  ref->released = 1;
+  vlist = rb_attr_get(ref->owner, id_precomputed);
+  if (!NIL_P(vlist)) rb_ary_delete(vlist, self);
+  if (!ref->busy){
+    precompute_free(ref->p);
+    ref->p = NULL;
+  }
+  return Qnil;
+}
+
+static void
+init_precompute(VALUE cCalcSun){
+  id_precomputed = rb_intern("@precomputed");
+  cPrecompute = rb_define_class_under(cCalcSun, "Precompute", rb_cObject);
+  rb_undef_alloc_func(cPrecompute);
+  rb_define_method(cPrecompute, "progress", pre_progress, 0);
+  rb_define_method(cPrecompute, "ready?", pre_ready_p, 0);
+  rb_define_method(cPrecompute, "release", pre_release, 0);
+  rb_define_method(cPrecompute, "wait", pre_wait, 0);
+}
+
+#endif
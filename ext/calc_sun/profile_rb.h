@@ -0,0 +1,359 @@
+/*
+ * profile_rb.h
+ *
+ * Ruby glue for CalcSun::ProfileStore, CalcSun#write_profiles
+ * and CalcSun#profile_store=. Included by calc_sun.c after
+ * get_day_range() and buffer_rb.h, before precompute_rb.h,
+ * whose rise, noon and set lookups read the store.
+ */
+#ifndef CALC_SUN_PROFILE_RB_H
+#define CALC_SUN_PROFILE_RB_H
+
+#include <errno.h>
+#include <ruby/thread.h>
+#include "profile_store.h"
+
+static VALUE cProfileStore;
+static ID id_profile_store;
+
+typedef struct {
+  const char *path;
+  size_t nsites;
+  const double *lat, *lon;
+  long day0;
+  size_t ndays;
+  int mode, nthreads, r, err;
+  double quantum;
+  profile_writer *pw;  /* open until filled and renamed */
+  volatile int stop;   /* set by profile_ubf() */
+} profile_write_t;
+
+static void
+store_free(void *p){
+  profile_store_close((profile_store *)p);
+}
+
+static size_t
+store_memsize(const void *p){
+  /* the mapping is the page cache's, not this process's */
+  return p ? sizeof(void *) : 0;
+}
+
+static const rb_data_type_t store_type = {
+  "CalcSun::ProfileStore",
+  {0, store_free, store_memsize,},
+  0, 0,
+  RUBY_TYPED_FREE_IMMEDIATELY,
+};
+
+static VALUE
+store_alloc(VALUE klass){
+  return TypedData_Wrap_Struct(klass, &store_type, 0);
+}
+
+static profile_store *
+get_store(VALUE vstore){
+  profile_store *s = rb_check_typeddata(vstore, &store_type);
+  if (!s) rb_raise(rb_eArgError, "uninitialized CalcSun::ProfileStore");
+  return s;
+}
+/*
+ * rise, transit and set of the day of d from the profile
+ * store of self. returns 0 when self has none, or it has
+ * not that site, day or precision.
+ */
+static int
+stored_rts(VALUE self, double d, double lat, double lon, int mode,
+           double v[3]){
+  VALUE vstore = rb_attr_get(self, id_profile_store);
+  double w[PROFILE_FIELDS];
+  if (NIL_P(vstore) ||
+      !profile_store_day(get_store(vstore), d, lat, lon, mode, w)) return 0;
+  v[0] = w[PROFILE_RISE];
+  v[1] = w[PROFILE_TRANSIT];
+  v[2] = w[PROFILE_SET];
+  return 1;
+}
+
+static void
+profile_ubf(void *arg){
+  ((profile_write_t *)arg)->stop = 1;
+}
+
+static void *
+profile_write_nogvl(void *arg){
+  profile_write_t *w = arg;
+  if (!w->pw &&
+      !(w->pw = profile_writer_open(w->path, w->nsites, w->lat, w->lon,
+                                    w->day0, w->ndays, w->mode, w->quantum))){
+    w->r = -1;
+    w->err = errno;
+    return NULL;
+  }
+  /* stopped, it keeps w->pw to go on with */
+  w->r = profile_writer_fill(w->pw, w->nthreads, &w->stop);
+  if (!w->r){
+    w->r = profile_writer_commit(w->pw);
+    w->pw = NULL;
+  }
+  w->err = errno;
+  return NULL;
+}
+
+static VALUE
+profile_check_ints(VALUE unused){
+  rb_thread_check_ints();
+  return Qnil;
+}
+/*
+ * call-seq:
+ *  write_profiles(path, sites, ajds, quantum = 1e-4, threads = nil)
+ *
+ * given an Array of [lat, lon] sites and a Range of
+ * Astronomical Julian Day Numbers, computes for every site
+ * and day of the range rise, transit and set as rise_jd,
+ * noon_jd and set_jd give them, day length in hours and
+ * the altitude at transit, at the precision of this
+ * object, on native threads outside the GVL, and writes
+ * them to path for CalcSun::ProfileStore.new to map.
+ * sites are rounded to a grid of quantum degrees and the
+ * profiles are those of the grid points. path is replaced
+ * whole at the end, so readers never see half a file.
+ * returns the number of grid points written.
+ *
+ */
+static VALUE func_write_profiles(int argc, VALUE *argv, VALUE self){
+  VALUE vpath, vsites, vrange, vquantum, vthreads, vtmp;
+  profile_write_t w;
+  long i, n, day0, day1;
+  double *buf;
+  profile_store *s;
+  int state;
+  rb_scan_args(argc, argv, "32", &vpath, &vsites, &vrange, &vquantum, &vthreads);
+  Check_Type(vsites, T_ARRAY);
+  vpath = rb_get_path(vpath);
+  n = RARRAY_LEN(vsites);
+  get_day_range(vrange, &day0, &day1);
+  memset(&w, 0, sizeof w);
+  buf = ALLOCV(vtmp, 2 * n * sizeof(double) + 1);
+  for (i = 0; i < n; i++){
+    VALUE vsite = rb_ary_entry(vsites, i);
+    Check_Type(vsite, T_ARRAY);
+    if (RARRAY_LEN(vsite) != 2) rb_raise(rb_eArgError, "sites must be [lat, lon]");
+    buf[i] = NUM2DBL(rb_ary_entry(vsite, 0));
+    buf[n + i] = NUM2DBL(rb_ary_entry(vsite, 1));
+  }
+  w.path = RSTRING_PTR(vpath);
+  w.nsites = (size_t)n;
+  w.lat = buf;
+  w.lon = buf + n;
+  w.day0 = day0;
+  w.ndays = (size_t)(day1 - day0 + 1);
+  w.mode = get_mode(self);
+  w.quantum = NIL_P(vquantum) ? 1e-4 : NUM2DBL(vquantum);
+  w.nthreads = NIL_P(vthreads) ? 0 : NUM2INT(vthreads);
+  for (;;){
+    rb_thread_call_without_gvl(profile_write_nogvl, &w, profile_ubf, &w);
+    if (!w.pw) break;
+    /* a signal handled by a trap goes on with the sites left */
+    rb_protect(profile_check_ints, Qnil, &state);
+    if (state){
+      profile_writer_abort(w.pw);
+      rb_jump_tag(state);
+    }
+    w.stop = 0;
+  }
+  ALLOCV_END(vtmp);
+  RB_GC_GUARD(vpath);
+  if (w.r && (w.err == EINVAL || w.err == EDOM))
+    rb_raise(rb_eArgError, "quantum must be in [1e-7, 1], with sites on its grid "
+             "and at most %ld days", 1L << 24);
+  if (w.r) rb_syserr_fail_str(w.err, vpath);
+  /* the grid points written */
+  if (!(s = profile_store_open(RSTRING_PTR(vpath)))) rb_sys_fail_str(vpath);
+  n = (long)profile_store_sites(s);
+  profile_store_close(s);
+  return LONG2NUM(n);
+}
+/*
+ * call-seq:
+ *  CalcSun::ProfileStore.new(path)
+ *
+ * maps the file write_profiles wrote to path, read only.
+ * later runs and processes read it in place; the pages are
+ * the host's page cache, shared by every reader.
+ *
+ */
+static VALUE store_init(VALUE self, VALUE vpath){
+  profile_store *s;
+  if (DATA_PTR(self)) rb_raise(rb_eTypeError, "already initialized store");
+  vpath = rb_get_path(vpath);
+  if (!(s = profile_store_open(RSTRING_PTR(vpath)))){
+    if (errno == EINVAL)
+      rb_raise(rb_eArgError, "%s is not a profile store", RSTRING_PTR(vpath));
+    rb_sys_fail_str(vpath);
+  }
+  DATA_PTR(self) = s;
+  return self;
+}
+/*
+ * call-seq:
+ *  size
+ *
+ * the number of grid points held.
+ *
+ */
+static VALUE store_size(VALUE self){
+  return SIZET2NUM(profile_store_sites(get_store(self)));
+}
+/*
+ * call-seq:
+ *  days
+ *
+ * the number of days of each profile.
+ *
+ */
+static VALUE store_days(VALUE self){
+  return SIZET2NUM(profile_store_days(get_store(self)));
+}
+/*
+ * call-seq:
+ *  first_ajd
+ *
+ * the Astronomical Julian Day Number the first day
+ * starts at.
+ *
+ */
+static VALUE store_first_ajd(VALUE self){
+  return DBL2NUM((double)profile_store_day0(get_store(self)) + DJ00);
+}
+/*
+ * call-seq:
+ *  precision
+ *
+ * :raw, :round12 or :legacy, that of the object that wrote
+ * the profiles. only objects of that precision read them.
+ *
+ */
+static VALUE store_precision(VALUE self){
+  int mode = profile_store_mode(get_store(self));
+  return mode == SOLAR_RAW ? sym_raw : mode == SOLAR_ROUND12 ? sym_round12 :
+    sym_legacy;
+}
+/*
+ * call-seq:
+ *  quantum
+ *
+ * grid step of the sites, in degrees.
+ *
+ */
+static VALUE store_quantum(VALUE self){
+  return DBL2NUM(profile_store_quantum(get_store(self)));
+}
+/*
+ * call-seq:
+ *  sites
+ *
+ * the grid points held, as [lat, lon] Arrays in the
+ * order of the file.
+ *
+ */
+static VALUE store_sites(VALUE self){
+  profile_store *s = get_store(self);
+  size_t i, n = profile_store_sites(s);
+  VALUE vsites = rb_ary_new2((long)n);
+  for (i = 0; i < n; i++){
+    double lat, lon;
+    profile_store_site(s, i, &lat, &lon);
+    rb_ary_push(vsites, rb_assoc_new(DBL2NUM(lat), DBL2NUM(lon)));
+  }
+  return vsites;
+}
+/*
+ * call-seq:
+ *  day(ajd, lat, lon)
+ *
+ * [rise, transit, set, day_length, noon_altitude] of the
+ * day of ajd at the grid point of lat, lon, rise and set
+ * nil where the Sun does not cross, or nil when the store
+ * has not that site or day.
+ *
+ */
+static VALUE store_day(VALUE self, VALUE vajd, VALUE vlat, VALUE vlon){
+  profile_store *s = get_store(self);
+  double v[PROFILE_FIELDS];
+  VALUE vday;
+  int f;
+  if (!profile_store_day(s, get_days(vajd), NUM2DBL(vlat), NUM2DBL(vlon),
+                         profile_store_mode(s), v)) return Qnil;
+  vday = rb_ary_new2(PROFILE_FIELDS);
+  for (f = 0; f < PROFILE_FIELDS; f++)
+    rb_ary_push(vday, isnan(v[f]) ? Qnil : DBL2NUM(v[f]));
+  return vday;
+}
+/*
+ * call-seq:
+ *  profile(lat, lon)
+ *
+ * the whole profile of the grid point of lat, lon as a
+ * CalcSun::Buffer of 5 rows, rise, transit, set,
+ * day_length and noon_altitude, of days samples, or nil
+ * when the store has not that site.
+ *
+ */
+static VALUE store_profile(VALUE self, VALUE vlat, VALUE vlon){
+  profile_store *s = get_store(self);
+  long i = profile_store_find(s, NUM2DBL(vlat), NUM2DBL(vlon));
+  size_t n = profile_store_days(s);
+  double *out;
+  VALUE vbuf;
+  if (i < 0) return Qnil;
+  vbuf = buffer_new(PROFILE_FIELDS, (long)n, &out);
+  memcpy(out, profile_store_profile(s, (size_t)i),
+         PROFILE_FIELDS * n * sizeof *out);
+  return vbuf;
+}
+/*
+ * call-seq:
+ *  profile_store = store
+ *
+ * makes rise, rise_jd, noon, noon_jd, set, set_jd and
+ * rise_set_batch read a CalcSun::ProfileStore for the
+ * sites, days and precision it holds, after any
+ * precompute_async table and before any shared cache.
+ * nil stops.
+ *
+ */
+static VALUE func_set_profile_store(VALUE self, VALUE vstore){
+  if (!NIL_P(vstore)) get_store(vstore);
+  rb_ivar_set(self, id_profile_store, vstore);
+  return vstore;
+}
+/*
+ * call-seq:
+ *  profile_store
+ *
+ * the CalcSun::ProfileStore in use, or nil.
+ *
+ */
+static VALUE func_get_profile_store(VALUE self){
+  return rb_attr_get(self, id_profile_store);
+}
+
+static void
+init_profile(VALUE cCalcSun){
+  id_profile_store = rb_intern("@profile_store");
+  cProfileStore = rb_define_class_under(cCalcSun, "ProfileStore", rb_cObject);
+  rb_define_alloc_func(cProfileStore, store_alloc);
+  rb_define_method(cProfileStore, "initialize", store_init, 1);
+  rb_define_method(cProfileStore, "day", store_day, 3);
+  rb_define_method(cProfileStore, "days", store_days, 0);
+  rb_define_method(cProfileStore, "first_ajd", store_first_ajd, 0);
+  rb_define_method(cProfileStore, "precision", store_precision, 0);
+  rb_define_method(cProfileStore, "profile", store_profile, 2);
+  rb_define_method(cProfileStore, "quantum", store_quantum, 0);
+  rb_define_method(cProfileStore, "sites", store_sites, 0);
+  rb_define_method(cProfileStore, "size", store_size, 0);
+}
+
+#endif
@@ -0,0 +1,437 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "profile_store.h"
+#include "solar.h"
+
+#define PROFILE_MAGIC 0x53505343u    /* "CSPS" */
+#define PROFILE_VERSION 1
+
+/* 64 bytes */
+typedef struct {
+  uint32_t magic, version, mode, fields;
+  uint64_t nsites;
+  int64_t day0;
+  uint64_t ndays;
+  double quantum;
+  uint64_t reserved[2];
+} profile_header;
+
+/* a grid point, sorted by qlat, then qlon */
+typedef struct {
+  int32_t qlat, qlon;
+} profile_key;
+
+struct profile_store {
+  const profile_header *h;
+  const profile_key *keys;
+  const double *data;
+  size_t size;
+};
+
+typedef struct {
+  const profile_key *keys;
+  double *data, quantum;
+  size_t nsites, ndays, next;
+  long day0;
+  int mode;
+  volatile int *stop;
+  pthread_mutex_t lock;
+} profile_job;
+
+static int
+cmp_key(const void *a, const void *b){
+  const profile_key *x = a, *y = b;
+  if (x->qlat != y->qlat) return x->qlat < y->qlat ? -1 : 1;
+  return (x->qlon > y->qlon) - (x->qlon < y->qlon);
+}
+
+/* grid indices of lat, lon; 0 when off the int32 range */
+static int
+grid_key(double quantum, double lat, double lon, profile_key *k){
+  double a = nearbyint(lat / quantum), b = nearbyint(lon / quantum);
+  if (!(fabs(a) < 2147483647.0 && fabs(b) < 2147483647.0)) return 0;
+  k->qlat = (int32_t)a;
+  k->qlon = (int32_t)b;
+  return 1;
+}
+
+static size_t
+file_size(size_t nsites, size_t ndays){
+  return sizeof(profile_header) + nsites * sizeof(profile_key) +
+    nsites * PROFILE_FIELDS * ndays * sizeof(double);
+}
+
+/* the profile of one grid point into its PROFILE_FIELDS columns v */
+static void
+fill_profile(const profile_job *j, const profile_key *k, double *v){
+  double lat = k->qlat * j->quantum, lon = k->qlon * j->quantum;
+  size_t n = j->ndays, i;
+  for (i = 0; i < n; i++){
+    double d = (double)(j->day0 + (long)i), len;
+    double transit = solar_noon_jd(d, lat, lon, j->mode);
+    double alt = solar_altitude(transit - DJ00, lat, lon, j->mode);
+    v[PROFILE_RISE * n + i] = solar_rise_jd(d, lat, lon, j->mode);
+    v[PROFILE_TRANSIT * n + i] = transit;
+    v[PROFILE_SET * n + i] = solar_set_jd(d, lat, lon, j->mode);
+    len = solar_dlt(d, lat, j->mode);
+    /* acos out of range, its sign says which way */
+    if (isnan(len)) len = solar_cos_h0(d, lat, j->mode) < 0.0 ? 24.0 : 0.0;
+    v[PROFILE_DAY_LENGTH * n + i] = len;
+    v[PROFILE_NOON_ALTITUDE * n + i] = alt;
+  }
+}
+
+static void *
+worker(void *arg){
+  profile_job *j = arg;
+  for (;;){
+    size_t i = j->nsites;
+    /* a site taken is filled, so a stopped job goes on from next */
+    pthread_mutex_lock(&j->lock);
+    if (j->next < j->nsites && !(j->stop && *j->stop)) i = j->next++;
+    pthread_mutex_unlock(&j->lock);
+    if (i >= j->nsites) return NULL;
+    fill_profile(j, &j->keys[i], j->data + i * PROFILE_FIELDS * j->ndays);
+  }
+}
+
+/* runs j on nthreads threads, or this one when none start */
+static void
+run_job(profile_job *j, int nthreads){
+  pthread_t *t;
+  int i, started = 0;
+  if (nthreads <= 0) nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (nthreads <= 0) nthreads = 1;
+  if ((size_t)nthreads > j->nsites) nthreads = j->nsites ? (int)j->nsites : 1;
+  pthread_mutex_init(&j->lock, NULL);
+  t = malloc((size_t)nthreads * sizeof *t);
+  for (i = 0; t && i < nthreads; i++)
+    if (pthread_create(&t[started], NULL, worker, j) == 0) started++;
+  if (!started) worker(j);
+  for (i = 0; i < started; i++) pthread_join(t[i], NULL);
+  free(t);
+  pthread_mutex_destroy(&j->lock);
+}
+
+struct profile_writer {
+  profile_job j;
+  profile_key *keys;
+  profile_header *h;
+  size_t size;
+  char *path, *tmp;    /* tmp is renamed over path at the end */
+  int fd, made;        /* made while tmp is on disk */
+};
+
+/*
+ * disk blocks for the whole file, so a full disk fails
+ * here and not as SIGBUS on a store through the mapping
+ */
+static int
+reserve(int fd, size_t size){
+#ifdef HAVE_POSIX_FALLOCATE
+  int e = posix_fallocate(fd, 0, (off_t)size);
+  if (e != EINVAL && e != EOPNOTSUPP){
+    errno = e;
+    return e ? -1 : 0;
+  }
+#endif
+  {
+    /* no fallocate here, write the zeros */
+    static const char zero[65536];
+    size_t at = 0;
+    while (at < size){
+      size_t k = size - at < sizeof zero ? size - at : sizeof zero;
+      ssize_t r = pwrite(fd, zero, k, (off_t)at);
+      if (r < 0){
+        if (errno == EINTR) continue;
+        return -1;
+      }
+      at += (size_t)r;
+    }
+  }
+  return 0;
+}
+
+/*
+ * creates the temporary file next to w->path, as open()
+ * makes any file: mode 0666 less the umask, not mkstemp's
+ * 0600, to be renamed over path as it is
+ */
+static int
+make_tmp(profile_writer *w, size_t len){
+  unsigned k;
+  for (k = 0; k < 1000; k++){
+    snprintf(w->tmp, len + 32, "%s.%ld.%u", w->path, (long)getpid(), k);
+    w->fd = open(w->tmp, O_RDWR | O_CREAT | O_EXCL, 0666);
+    if (w->fd >= 0) return 0;
+    if (errno != EEXIST) return -1;
+  }
+  return -1;
+}
+
+/* drops w and its temporary file, errno kept */
+static void
+writer_free(profile_writer *w){
+  int e = errno;
+  if (w->h) munmap(w->h, w->size);
+  if (w->fd >= 0) close(w->fd);
+  if (w->made) unlink(w->tmp);
+  free(w->keys);
+  free(w->path);
+  free(w->tmp);
+  free(w);
+  errno = e;
+}
+
+profile_writer *
+profile_writer_open(const char *path, size_t nsites, const double *lat,
+                    const double *lon, long day0, size_t ndays, int mode,
+                    double quantum){
+  profile_writer *w;
+  profile_key *keys;
+  size_t i, n = 0, len = strlen(path);
+  if (!(quantum >= 1e-7 && quantum <= 1.0) || ndays == 0 ||
+      ndays > ((size_t)1 << 24)){
+    errno = EINVAL;
+    return NULL;
+  }
+  if (!(w = calloc(1, sizeof *w))){
+    errno = ENOMEM;
+    return NULL;
+  }
+  w->fd = -1;
+  if (!(w->keys = keys = malloc(nsites * sizeof *keys + 1)) ||
+      !(w->path = malloc(len + 1)) || !(w->tmp = malloc(len + 32))){
+    errno = ENOMEM;
+    writer_free(w);
+    return NULL;
+  }
+  for (i = 0; i < nsites; i++)
+    if (!grid_key(quantum, lat[i], lon[i], &keys[i])){
+      errno = EDOM;
+      writer_free(w);
+      return NULL;
+    }
+  qsort(keys, nsites, sizeof *keys, cmp_key);
+  for (i = 0; i < nsites; i++)
+    if (n == 0 || cmp_key(&keys[n - 1], &keys[i]) != 0) keys[n++] = keys[i];
+  if (n > (SIZE_MAX - sizeof *w->h) / (sizeof *keys + PROFILE_FIELDS *
+                                       ndays * sizeof(double))){
+    errno = EFBIG;
+    writer_free(w);
+    return NULL;
+  }
+  w->size = file_size(n, ndays);
+  memcpy(w->path, path, len + 1);
+  if (make_tmp(w, len) != 0){
+    writer_free(w);
+    return NULL;
+  }
+  w->made = 1;
+  if (reserve(w->fd, w->size) != 0){
+    writer_free(w);
+    return NULL;
+  }
+  w->h = mmap(NULL, w->size, PROT_READ | PROT_WRITE, MAP_SHARED, w->fd, 0);
+  if (w->h == MAP_FAILED){
+    w->h = NULL;
+    writer_free(w);
+    return NULL;
+  }
+  memcpy(w->h + 1, keys, n * sizeof *keys);
+  w->j.keys = keys;
+  w->j.data = (double *)((profile_key *)(w->h + 1) + n);
+  w->j.quantum = quantum;
+  w->j.nsites = n;
+  w->j.ndays = ndays;
+  w->j.day0 = day0;
+  w->j.mode = mode;
+  return w;
+}
+
+int
+profile_writer_fill(profile_writer *w, int nthreads, volatile int *stop){
+  w->j.stop = stop;
+  run_job(&w->j, nthreads);
+  if (w->j.next < w->j.nsites){
+    errno = EINTR;
+    return -1;
+  }
+  return 0;
+}
+
+int
+profile_writer_commit(profile_writer *w){
+  profile_header *h = w->h;
+  int e;
+  h->version = PROFILE_VERSION;
+  h->mode = (uint32_t)w->j.mode;
+  h->fields = PROFILE_FIELDS;
+  h->nsites = w->j.nsites;
+  h->day0 = w->j.day0;
+  h->ndays = w->j.ndays;
+  h->quantum = w->j.quantum;
+  h->magic = PROFILE_MAGIC;
+  w->h = NULL;
+  e = munmap(h, w->size);
+  if (e == 0) e = fsync(w->fd);
+  if (e == 0){
+    e = close(w->fd);
+    w->fd = -1;
+  }
+  if (e == 0) e = rename(w->tmp, w->path);
+  if (e == 0) w->made = 0;
+  writer_free(w);
+  return e ? -1 : 0;
+}
+
+void
+profile_writer_abort(profile_writer *w){
+  if (w) writer_free(w);
+}
+
+int
+profile_store_write(const char *path, size_t nsites, const double *lat,
+                    const double *lon, long day0, size_t ndays, int mode,
+                    double quantum, int nthreads, volatile int *stop){
+  profile_writer *w = profile_writer_open(path, nsites, lat, lon, day0, ndays,
+                                          mode, quantum);
+  if (!w) return -1;
+  if (profile_writer_fill(w, nthreads, stop) != 0){
+    profile_writer_abort(w);
+    return -1;
+  }
+  return profile_writer_commit(w);
+}
+
+profile_store *
+profile_store_open(const char *path){
+  profile_store *s;
+  const profile_header *h;
+  struct stat st;
+  size_t size;
+  int fd = open(path, O_RDONLY), e;
+  if (fd < 0) return NULL;
+  if (fstat(fd, &st) != 0){
+    e = errno;
+    close(fd);
+    errno = e;
+    return NULL;
+  }
+  size = (size_t)st.st_size;
+  if (size < sizeof *h){
+    close(fd);
+    errno = EINVAL;
+    return NULL;
+  }
+  h = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  e = errno;
+  close(fd);
+  if (h == MAP_FAILED){
+    errno = e;
+    return NULL;
+  }
+  if (h->magic != PROFILE_MAGIC || h->version != PROFILE_VERSION ||
+      h->fields != PROFILE_FIELDS || h->ndays == 0 ||
+      h->ndays > ((uint64_t)1 << 24) ||
+      h->nsites > (size - sizeof *h) / (sizeof(profile_key) +
+                                        PROFILE_FIELDS * h->ndays * sizeof(double)) ||
+      file_size((size_t)h->nsites, (size_t)h->ndays) != size){
+    munmap((void *)h, size);
+    errno = EINVAL;
+    return NULL;
+  }
+  if (!(s = malloc(sizeof *s))){
+    munmap((void *)h, size);
+    errno = ENOMEM;
+    return NULL;
+  }
+  s->h = h;
+  s->keys = (const profile_key *)(h + 1);
+  s->data = (const double *)(s->keys + h->nsites);
+  s->size = size;
+  return s;
+}
+
+void
+profile_store_close(profile_store *s){
+  if (!s) return;
+  munmap((void *)s->h, s->size);
+  free(s);
+}
+
+size_t
+profile_store_sites(const profile_store *s){
+  return (size_t)s->h->nsites;
+}
+
+size_t
+profile_store_days(const profile_store *s){
+  return (size_t)s->h->ndays;
+}
+
+long
+profile_store_day0(const profile_store *s){
+  return (long)s->h->day0;
+}
+
+int
+profile_store_mode(const profile_store *s){
+  return (int)s->h->mode;
+}
+
+double
+profile_store_quantum(const profile_store *s){
+  return s->h->quantum;
+}
+
+void
+profile_store_site(const profile_store *s, size_t i, double *lat, double *lon){
+  *lat = s->keys[i].qlat * s->h->quantum;
+  *lon = s->keys[i].qlon * s->h->quantum;
+}
+
+long
+profile_store_find(const profile_store *s, double lat, double lon){
+  profile_key k;
+  size_t lo = 0, hi = (size_t)s->h->nsites;
+  if (!grid_key(s->h->quantum, lat, lon, &k)) return -1;
+  while (lo < hi){
+    size_t mid = lo + (hi - lo) / 2;
+    if (cmp_key(&s->keys[mid], &k) < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo < s->h->nsites && cmp_key(&s->keys[lo], &k) == 0) return (long)lo;
+  return -1;
+}
+
+const double *
+profile_store_profile(const profile_store *s, size_t i){
+  return s->data + i * PROFILE_FIELDS * (size_t)s->h->ndays;
+}
+
+int
+profile_store_day(const profile_store *s, double d, double lat, double lon,
+                  int mode, double v[PROFILE_FIELDS]){
+  double k = floor(d) - (double)s->h->day0;
+  size_t n = (size_t)s->h->ndays;
+  const double *p;
+  long i;
+  int f;
+  if (mode != (int)s->h->mode || !(k >= 0.0 && k < (double)n)) return 0;
+  if ((i = profile_store_find(s, lat, lon)) < 0) return 0;
+  p = profile_store_profile(s, (size_t)i) + (size_t)k;
+  for (f = 0; f < PROFILE_FIELDS; f++) v[f] = p[f * n];
+  return 1;
+}
@@ -0,0 +1,115 @@
+/*
+ * profile_store.h
+ *
+ * Yearly, or any span of days, solar profiles of many sites
+ * kept in one file: written once on native threads, then
+ * mapped read only by later runs, which read it in place.
+ * No Ruby dependency.
+ *
+ * Sites are rounded to a grid of quantum degrees, like
+ * shm_cache.h, and the profiles are those of the grid
+ * points. The file holds a 64 byte header, the grid points
+ * sorted, which a lookup bisects, then for each of them
+ * PROFILE_FIELDS columns of ndays doubles: rise, transit
+ * and set ajds as rise_jd, noon_jd and set_jd give them
+ * (NaN rise and set where the Sun does not cross), day
+ * length in hours as daylight_time gives it where it does
+ * (24 or 0 where it does not, by the sign of solar_cos_h0,
+ * not NaN as daylight_time has it), and the
+ * altitude at transit in degrees. Values are in the host's
+ * byte order; a file of the other order does not open.
+ */
+#ifndef CALC_SUN_PROFILE_STORE_H
+#define CALC_SUN_PROFILE_STORE_H
+
+#include <stddef.h>
+
+#define PROFILE_FIELDS 5
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+  PROFILE_RISE,
+  PROFILE_TRANSIT,
+  PROFILE_SET,
+  PROFILE_DAY_LENGTH,
+  PROFILE_NOON_ALTITUDE
+};
+
+typedef struct profile_store profile_store;
+
+/*
+ * computes the profiles of nsites sites lat, lon in
+ * degrees, grid quantum degrees, for the days day0 to
+ * day0 + ndays - 1 (floor(d), days from J2000), chain
+ * precision mode as in solar.h, on nthreads threads (0 for
+ * one a core), and writes them to path through a temporary
+ * file renamed over it at the end, of the mode open()
+ * gives a new file. the file's blocks are reserved first,
+ * so a full disk fails with ENOSPC. sites on the same grid
+ * point are stored once. *stop, when set by another
+ * thread, makes it give up. returns 0, or -1 with errno set
+ * (EINTR when stopped).
+ */
+int profile_store_write(const char *path, size_t nsites, const double *lat,
+                        const double *lon, long day0, size_t ndays, int mode,
+                        double quantum, int nthreads, volatile int *stop);
+
+/*
+ * profile_store_write() in steps, for a caller that goes
+ * on after a stop: profile_writer_open() checks the sites
+ * and maps a temporary file next to path (NULL with errno
+ * set), profile_writer_fill() fills the profiles not yet
+ * filled, -1 with errno EINTR when *stop set, to be called
+ * again, and profile_writer_commit() renames the file over
+ * path, returning 0 or -1 with errno set. commit and abort
+ * free w.
+ */
+typedef struct profile_writer profile_writer;
+
+profile_writer *profile_writer_open(const char *path, size_t nsites,
+                                    const double *lat, const double *lon,
+                                    long day0, size_t ndays, int mode,
+                                    double quantum);
+int profile_writer_fill(profile_writer *w, int nthreads, volatile int *stop);
+int profile_writer_commit(profile_writer *w);
+void profile_writer_abort(profile_writer *w);
+
+/* maps the file path. returns NULL with errno set, EINVAL if not a store */
+profile_store *profile_store_open(const char *path);
+/* unmaps s */
+void profile_store_close(profile_store *s);
+
+/* grid points, days, the first day, precision mode, grid step */
+size_t profile_store_sites(const profile_store *s);
+size_t profile_store_days(const profile_store *s);
+long profile_store_day0(const profile_store *s);
+int profile_store_mode(const profile_store *s);
+double profile_store_quantum(const profile_store *s);
+/* lat and lon of grid point i */
+void profile_store_site(const profile_store *s, size_t i, double *lat,
+                        double *lon);
+
+/* the grid point of lat, lon, or -1 when s has none */
+long profile_store_find(const profile_store *s, double lat, double lon);
+/*
+ * the PROFILE_FIELDS columns of grid point i, each
+ * profile_store_days() doubles, one after the other, in
+ * the mapping
+ */
+const double *profile_store_profile(const profile_store *s, size_t i);
+/*
+ * the PROFILE_FIELDS values of the day of d at lat, lon,
+ * precision mode. returns 1 with them, 0 when s has not
+ * that grid point, day or mode.
+ */
+int profile_store_day(const profile_store *s, double d, double lat,
+                      double lon, int mode, double v[PROFILE_FIELDS]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,155 @@
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include "rise_surface.h"
+#include "solar.h"
+
+enum {
+  CELL_SURFACE,             /* interpolate */
+  CELL_CHAIN,               /* over tolerance, go direct */
+  CELL_POLAR                /* no rise or set across the cell */
+};
+
+struct rise_surface {
+  long jd0;
+  size_t ndays, nlat;       /* nlat grid latitudes, nlat - 1 cells */
+  double lat_step;
+  int mode;
+  double max_err;
+  size_t nflagged;
+  double *transit;          /* per day, t_south at longitude 0 */
+  double *arc;              /* ndays x nlat diurnal arcs, hours */
+  unsigned char *flag;      /* ndays x (nlat - 1), CELL_ below */
+};
+
+/* hour in [0, 24) */
+static inline double
+hour24(double h){
+  h = fmod(h, 24.0);
+  return h < 0.0 ? h + 24.0 : h;
+}
+
+rise_surface *
+rise_surface_build(long jd0, size_t ndays, double lat_step,
+                   double tolerance, int mode){
+  rise_surface *s;
+  size_t k, i, nc;
+  if (ndays == 0 || !(lat_step > 0.0 && lat_step <= 90.0) ||
+      !(tolerance > 0.0)){
+    errno = EINVAL;
+    return NULL;
+  }
+  s = calloc(1, sizeof *s);
+  if (!s) return NULL;
+  s->jd0 = jd0;
+  s->ndays = ndays;
+  s->nlat = (size_t)ceil(180.0 / lat_step) + 1;
+  s->lat_step = 180.0 / (double)(s->nlat - 1);
+  s->mode = mode;
+  nc = s->nlat - 1;
+  s->transit = malloc(ndays * sizeof *s->transit);
+  s->arc = malloc(ndays * s->nlat * sizeof *s->arc);
+  s->flag = malloc(ndays * nc);
+  if (!s->transit || !s->arc || !s->flag){
+    rise_surface_free(s);
+    errno = ENOMEM;
+    return NULL;
+  }
+  for (k = 0; k < ndays; k++){
+    double d = (double)(jd0 + (long)k) - DJ00;
+    double *arc = s->arc + k * s->nlat;
+    unsigned char *flag = s->flag + k * nc;
+    s->transit[k] = solar_t_south(d, 0.0, mode);
+    for (i = 0; i < s->nlat; i++)
+      arc[i] = solar_diurnal_arc(d, -90.0 + (double)i * s->lat_step, mode);
+    for (i = 0; i < nc; i++){
+      double mid = solar_diurnal_arc(d, -90.0 + ((double)i + 0.5) * s->lat_step,
+                                     mode);
+      double err = fabs(mid - 0.5 * (arc[i] + arc[i + 1]));
+      /* polar regions run from their edge to the pole, a cell
+      * with both ends in one is in it all the way across
+      */
+      if (isnan(mid) && isnan(arc[i]) && isnan(arc[i + 1]))
+        flag[i] = CELL_POLAR;
+      else if (err <= tolerance){
+        flag[i] = CELL_SURFACE;
+        if (err > s->max_err) s->max_err = err;
+      }
+      else{
+        /* NaN at one end, the polar edges, lands here too */
+        flag[i] = CELL_CHAIN;
+        s->nflagged++;
+      }
+    }
+  }
+  return s;
+}
+
+void
+rise_surface_free(rise_surface *s){
+  if (!s) return;
+  free(s->transit);
+  free(s->arc);
+  free(s->flag);
+  free(s);
+}
+
+double
+rise_surface_max_error(const rise_surface *s){
+  return s->max_err;
+}
+
+size_t
+rise_surface_flagged(const rise_surface *s){
+  return s->nflagged;
+}
+
+size_t
+rise_surface_size(const rise_surface *s){
+  return sizeof *s + s->ndays * (sizeof *s->transit +
+         s->nlat * sizeof *s->arc + (s->nlat - 1));
+}
+
+size_t
+rise_surface_eval(const rise_surface *s, size_t n, const long *jdn,
+                  const double *lat, const double *lon,
+                  double *rise, double *transit, double *set){
+  size_t j, direct = 0, nc = s->nlat - 1;
+  for (j = 0; j < n; j++){
+    long k = jdn[j] - s->jd0;
+    double x = (lat[j] + 90.0) / s->lat_step;
+    double start = (double)jdn[j] - 0.5;
+    double ts, da, f;
+    size_t i;
+    if (k < 0 || (size_t)k >= s->ndays || !(x >= 0.0 && x <= (double)nc))
+      goto chain;
+    i = (size_t)x;
+    if (i == nc) i--;
+    switch (s->flag[(size_t)k * nc + i]){
+    case CELL_CHAIN:
+      goto chain;
+    case CELL_POLAR:
+      da = NAN;
+      break;
+    default:
+      f = x - (double)i;
+      da = s->arc[(size_t)k * s->nlat + i];
+      da += f * (s->arc[(size_t)k * s->nlat + i + 1] - da);
+    }
+    ts = hour24(s->transit[k] - lon[j] / 15.0);
+    /* t_rise and t_set of the chain without their wraps */
+    if (rise) rise[j] = start + (ts - da) / 24.0;
+    if (transit) transit[j] = start + ts / 24.0;
+    if (set) set[j] = start + (ts + da) / 24.0;
+    continue;
+  chain:
+    {
+      double d = (double)jdn[j] - DJ00;
+      if (rise) rise[j] = solar_rise_jd(d, lat[j], lon[j], s->mode);
+      if (transit) transit[j] = solar_noon_jd(d, lat[j], lon[j], s->mode);
+      if (set) set[j] = solar_set_jd(d, lat[j], lon[j], s->mode);
+      direct++;
+    }
+  }
+  return direct;
+}
@@ -0,0 +1,66 @@
+/*
+ * rise_surface.h
+ *
+ * Precomputed rise, transit and set of the CalcSun chain
+ * for a span of days at every latitude. No Ruby dependency.
+ *
+ * In the chain, transit only shifts with longitude,
+ * t_south(d, lon) = t_south(d, 0) - lon / 15 (mod 24), and
+ * the half day arc depends on the day and latitude alone.
+ * So a surface holds one transit per day and a grid of
+ * half day arcs over latitude, and each lookup is an index
+ * and a linear interpolation instead of the trig chain.
+ *
+ * The chain works on whole days (floor(d)), so the day axis
+ * is exact and latitude is the only one interpolated.
+ * Building checks every grid cell at its midpoint against
+ * the direct chain; cells off by more than the tolerance,
+ * which gathers them along the polar day and night edges,
+ * are flagged and looked up directly instead. Cells wholly
+ * inside polar day or night need no chain, they have no
+ * rise or set.
+ */
+#ifndef CALC_SUN_RISE_SURFACE_H
+#define CALC_SUN_RISE_SURFACE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct rise_surface rise_surface;
+
+/*
+ * surface for days jd0 to jd0 + ndays - 1 (Julian Day
+ * Numbers), latitudes every lat_step degrees, tolerance
+ * in hours, chain precision mode as in solar.h.
+ * returns NULL with errno set on bad arguments or no memory.
+ */
+rise_surface *rise_surface_build(long jd0, size_t ndays, double lat_step,
+                                 double tolerance, int mode);
+void rise_surface_free(rise_surface *s);
+
+/* largest midpoint error of the cells kept, hours */
+double rise_surface_max_error(const rise_surface *s);
+/* number of cells flagged for the direct chain */
+size_t rise_surface_flagged(const rise_surface *s);
+/* bytes held */
+size_t rise_surface_size(const rise_surface *s);
+
+/*
+ * rise, transit and set ajds for n (jdn, lat, lon); rise and
+ * set NaN where the Sun does not rise or set, as the chain
+ * gives them. Days outside the surface and flagged cells go
+ * through the chain. Any output may be NULL.
+ * returns the number of samples that went through the chain.
+ */
+size_t rise_surface_eval(const rise_surface *s, size_t n, const long *jdn,
+                         const double *lat, const double *lon,
+                         double *rise, double *transit, double *set);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
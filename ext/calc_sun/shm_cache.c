@@ -0,0 +1,297 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "shm_cache.h"
+#include "solar.h"
+
+#define SHM_CACHE_MAGIC 0x43534843u    /* "CHSC" */
+#define SHM_CACHE_VERSION 1
+/* how long an opener waits for the creator to set the header up */
+#define SHM_CACHE_WAIT_MS 1000
+
+/* 64 bytes, magic stored last by the creator */
+typedef struct {
+  uint32_t magic, version;
+  uint64_t nslots;
+  double quantum;
+  uint64_t reserved[5];
+} shm_header;
+
+/* 48 bytes; seq 0 never written, odd being written */
+typedef struct {
+  uint64_t seq;
+  uint64_t key[2];
+  uint64_t v[3];
+} shm_slot;
+
+struct shm_cache {
+  shm_header *h;
+  shm_slot *slots;
+  size_t nslots, size;
+  double quantum;
+};
+
+#ifdef __GNUC__
+# define LOAD_ACQ(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+# define LOAD(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+# define STORE_REL(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+# define STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+# define FENCE_ACQ() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+# define FENCE_REL() __atomic_thread_fence(__ATOMIC_RELEASE)
+# define CLAIM(p, old) __atomic_compare_exchange_n((p), &(old), (old) + 1, 0, \
+                                                  __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)
+#endif
+
+static uint64_t
+mix(uint64_t x){
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/*
+ * grid indices of lat and lon, as profile_store.c's
+ * grid_key; 0 when either is not finite or falls outside
+ * int32_t, as lon past 214.7 degrees does at quantum 1e-7
+ */
+static int
+grid_index(const shm_cache *c, double lat, double lon, int32_t *qlat,
+           int32_t *qlon){
+  double a = round(lat / c->quantum), b = round(lon / c->quantum);
+  if (!(fabs(a) < 2147483647.0 && fabs(b) < 2147483647.0)) return 0;
+  *qlat = (int32_t)a;
+  *qlon = (int32_t)b;
+  return 1;
+}
+
+/* 0 when the site or the day of d has no key */
+static int
+make_key(const shm_cache *c, double d, double lat, double lon, int mode,
+         uint64_t key[2]){
+  int32_t qlat, qlon;
+  double day = floor(d);
+  if (!(fabs(day) < 2147483647.0) || !grid_index(c, lat, lon, &qlat, &qlon))
+    return 0;
+  key[0] = (uint64_t)(uint32_t)qlat << 32 | (uint32_t)qlon;
+  key[1] = (uint64_t)(uint32_t)(int32_t)day << 32 | (uint32_t)mode;
+  return 1;
+}
+
+shm_cache *
+shm_cache_open(const char *name, size_t slots, double quantum){
+#ifdef __GNUC__
+  shm_cache *c;
+  shm_header *h;
+  struct stat st;
+  size_t n = SHM_CACHE_PROBE, size;
+  int fd, created = 0, waited;
+  if (!(quantum >= 1e-7 && quantum <= 1.0) || slots > ((size_t)1 << 40)){
+    errno = EINVAL;
+    return NULL;
+  }
+  while (n < slots) n *= 2;
+  size = sizeof *h + n * sizeof(shm_slot);
+  if ((fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600)) >= 0){
+    created = 1;
+    if (ftruncate(fd, (off_t)size) != 0){
+      int e = errno;
+      close(fd);
+      shm_unlink(name);
+      errno = e;
+      return NULL;
+    }
+  }
+  else if (errno != EEXIST || (fd = shm_open(name, O_RDWR, 0)) < 0)
+    return NULL;
+  /* an opener waits for the creator's ftruncate and header */
+  for (waited = 0; !created; waited++){
+    if (fstat(fd, &st) != 0) goto fail;
+    if ((size_t)st.st_size >= sizeof *h){
+      h = mmap(NULL, sizeof *h, PROT_READ, MAP_SHARED, fd, 0);
+      if (h == MAP_FAILED) goto fail;
+      if (LOAD_ACQ(&h->magic) == SHM_CACHE_MAGIC){
+        n = (size_t)h->nslots;
+        quantum = h->quantum;
+        size = sizeof *h + n * sizeof(shm_slot);
+        waited = h->version != SHM_CACHE_VERSION ||
+          (size_t)st.st_size < size;
+        munmap(h, sizeof *h);
+        if (waited){
+          errno = EINVAL;
+          goto fail;
+        }
+        break;
+      }
+      munmap(h, sizeof *h);
+    }
+    if (waited >= SHM_CACHE_WAIT_MS){
+      errno = EAGAIN;
+      goto fail;
+    }
+    usleep(1000);
+  }
+  h = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (h == MAP_FAILED) goto fail;
+  close(fd);
+  if (created){
+    h->version = SHM_CACHE_VERSION;
+    h->nslots = n;
+    h->quantum = quantum;
+    STORE_REL(&h->magic, SHM_CACHE_MAGIC);
+  }
+  if (!(c = malloc(sizeof *c))){
+    munmap(h, size);
+    errno = ENOMEM;
+    return NULL;
+  }
+  c->h = h;
+  c->slots = (shm_slot *)(h + 1);
+  c->nslots = n;
+  c->size = size;
+  c->quantum = quantum;
+  return c;
+ fail:
+  {
+    int e = errno;
+    close(fd);
+    errno = e;
+  }
+  return NULL;
+#else
+  (void)name;
+  (void)slots;
+  (void)quantum;
+  errno = ENOSYS;
+  return NULL;
+#endif
+}
+
+void
+shm_cache_close(shm_cache *c){
+  if (!c) return;
+  munmap(c->h, c->size);
+  free(c);
+}
+
+int
+shm_cache_unlink(const char *name){
+  return shm_unlink(name);
+}
+
+size_t
+shm_cache_slots(const shm_cache *c){
+  return c->nslots;
+}
+
+double
+shm_cache_quantum(const shm_cache *c){
+  return c->quantum;
+}
+
+void
+shm_cache_grid(const shm_cache *c, double *lat, double *lon){
+  int32_t qlat, qlon;
+  if (!grid_index(c, *lat, *lon, &qlat, &qlon)) return;
+  *lat = qlat * c->quantum;
+  *lon = qlon * c->quantum;
+}
+
+#ifdef __GNUC__
+/* a stable read of slot s: its seq, 0 when being written */
+static uint64_t
+read_slot(shm_slot *s, uint64_t key[2], double v[3]){
+  uint64_t seq = LOAD_ACQ(&s->seq), w[3];
+  int i;
+  if (seq == 0 || (seq & 1)) return 0;
+  key[0] = LOAD(&s->key[0]);
+  key[1] = LOAD(&s->key[1]);
+  for (i = 0; i < 3; i++) w[i] = LOAD(&s->v[i]);
+  FENCE_ACQ();
+  if (LOAD(&s->seq) != seq) return 0;
+  if (v) memcpy(v, w, sizeof w);
+  return seq;
+}
+#endif
+
+int
+shm_cache_get(shm_cache *c, double d, double lat, double lon, int mode,
+              double v[3]){
+#ifdef __GNUC__
+  uint64_t key[2], k[2], h;
+  size_t i;
+  if (!make_key(c, d, lat, lon, mode, key)) return 0;
+  h = mix(key[0] ^ mix(key[1]));
+  for (i = 0; i < SHM_CACHE_PROBE; i++){
+    shm_slot *s = &c->slots[(h + i) & (c->nslots - 1)];
+    double w[3];
+    /* slots never empty again, so the key lies before any empty one */
+    if (LOAD_ACQ(&s->seq) == 0) return 0;
+    if (read_slot(s, k, w) && k[0] == key[0] && k[1] == key[1]){
+      memcpy(v, w, sizeof w);
+      return 1;
+    }
+  }
+#endif
+  return 0;
+}
+
+#ifdef __GNUC__
+/* fills slot s claimed at odd seq, publishing it at seq + 1 */
+static void
+fill_slot(shm_slot *s, uint64_t seq, const uint64_t key[2], const double v[3]){
+  uint64_t w[3];
+  int i;
+  memcpy(w, v, sizeof w);
+  FENCE_REL();
+  STORE(&s->key[0], key[0]);
+  STORE(&s->key[1], key[1]);
+  for (i = 0; i < 3; i++) STORE(&s->v[i], w[i]);
+  STORE_REL(&s->seq, seq + 1);
+}
+#endif
+
+void
+shm_cache_put(shm_cache *c, double d, double lat, double lon, int mode,
+              const double v[3]){
+#ifdef __GNUC__
+  uint64_t key[2], k[2], h, seq;
+  shm_slot *s;
+  size_t i;
+  if (!make_key(c, d, lat, lon, mode, key)) return;
+  h = mix(key[0] ^ mix(key[1]));
+  for (i = 0; i < SHM_CACHE_PROBE; i++){
+    s = &c->slots[(h + i) & (c->nslots - 1)];
+    seq = 0;
+    if (CLAIM(&s->seq, seq)){
+      fill_slot(s, 1, key, v);
+      return;
+    }
+    if (read_slot(s, k, NULL) && k[0] == key[0] && k[1] == key[1]) return;
+  }
+  /* the window is full: evict a slot of it picked by the hash */
+  s = &c->slots[(h + (h >> 59) % SHM_CACHE_PROBE) & (c->nslots - 1)];
+  seq = LOAD(&s->seq);
+  if (!(seq & 1) && CLAIM(&s->seq, seq)) fill_slot(s, seq + 1, key, v);
+#else
+  (void)c; (void)d; (void)lat; (void)lon; (void)mode; (void)v;
+#endif
+}
+
+void
+shm_cache_rts(shm_cache *c, double d, double lat, double lon, int mode,
+              double v[3]){
+  if (shm_cache_get(c, d, lat, lon, mode, v)) return;
+  shm_cache_grid(c, &lat, &lon);
+  v[0] = solar_rise_jd(d, lat, lon, mode);
+  v[1] = solar_noon_jd(d, lat, lon, mode);
+  v[2] = solar_set_jd(d, lat, lon, mode);
+  shm_cache_put(c, d, lat, lon, mode, v);
+}
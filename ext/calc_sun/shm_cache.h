@@ -0,0 +1,76 @@
+/*
+ * shm_cache.h
+ *
+ * Rise, transit and set of the CalcSun chain cached in a
+ * POSIX shared memory segment (shm_open + mmap), so the
+ * processes of a host, forked workers or not, reuse each
+ * other's results. No Ruby dependency.
+ *
+ * Entries are keyed by latitude and longitude rounded to a
+ * grid of quantum degrees, the day (floor(d)) and the
+ * precision mode, and hold the values at the grid point.
+ * The table is open addressed, a key living in one of
+ * SHM_CACHE_PROBE slots from its hash. Readers take no
+ * lock: each slot carries a sequence number, odd while its
+ * one writer fills it, and a read that sees it change is
+ * retried as a miss. A writer claims a slot by moving the
+ * number from even to odd; when the probe window is full
+ * it evicts one slot of it.
+ */
+#ifndef CALC_SUN_SHM_CACHE_H
+#define CALC_SUN_SHM_CACHE_H
+
+#include <stddef.h>
+
+#define SHM_CACHE_PROBE 8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct shm_cache shm_cache;
+
+/*
+ * opens the segment name ("/calc_sun" form), creating it
+ * with room for slots entries (rounded up to a power of 2)
+ * and grid quantum degrees when it does not exist yet.
+ * An existing segment keeps its own size and quantum.
+ * returns NULL with errno set.
+ */
+shm_cache *shm_cache_open(const char *name, size_t slots, double quantum);
+/* unmaps c; the segment stays for the other processes */
+void shm_cache_close(shm_cache *c);
+/* removes the segment name once every process closes it */
+int shm_cache_unlink(const char *name);
+
+size_t shm_cache_slots(const shm_cache *c);
+double shm_cache_quantum(const shm_cache *c);
+/* lat and lon of the grid point of lat, lon, unchanged when off the grid */
+void shm_cache_grid(const shm_cache *c, double *lat, double *lon);
+
+/*
+ * rise, transit and set ajds of the day of d at the grid
+ * point of lat, lon, precision mode, when cached. returns
+ * 1 with the values, else 0, always 0 for a lat, lon or d
+ * not finite or past the int32_t grid.
+ */
+int shm_cache_get(shm_cache *c, double d, double lat, double lon, int mode,
+                  double v[3]);
+/*
+ * stores v for that key; gives up quietly if another writer
+ * holds the slot or the key is past the grid
+ */
+void shm_cache_put(shm_cache *c, double d, double lat, double lon, int mode,
+                   const double v[3]);
+/*
+ * shm_cache_get, else the chain's values at the grid point,
+ * stored for the next caller.
+ */
+void shm_cache_rts(shm_cache *c, double d, double lat, double lon, int mode,
+                   double v[3]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,182 @@
+/*
+ * shm_rb.h
+ *
+ * Ruby glue for CalcSun::SharedCache and
+ * CalcSun#shared_cache=. Included by calc_sun.c after
+ * get_mode(), before precompute_rb.h, whose rise, noon and
+ * set lookups read the cache.
+ */
+#ifndef CALC_SUN_SHM_RB_H
+#define CALC_SUN_SHM_RB_H
+
+#include <errno.h>
+#include "shm_cache.h"
+
+static VALUE cSharedCache;
+static ID id_shared_cache;
+
+static void
+shared_free(void *p){
+  shm_cache_close((shm_cache *)p);
+}
+
+static size_t
+shared_memsize(const void *p){
+  /* the segment is the host's, not this process's */
+  return p ? sizeof(void *) : 0;
+}
+
+static const rb_data_type_t shared_type = {
+  "CalcSun::SharedCache",
+  {0, shared_free, shared_memsize,},
+  0, 0,
+  RUBY_TYPED_FREE_IMMEDIATELY,
+};
+
+static VALUE
+shared_alloc(VALUE klass){
+  return TypedData_Wrap_Struct(klass, &shared_type, 0);
+}
+
+static shm_cache *
+get_shared(VALUE vcache){
+  shm_cache *c = rb_check_typeddata(vcache, &shared_type);
+  if (!c) rb_raise(rb_eArgError, "uninitialized CalcSun::SharedCache");
+  return c;
+}
+/*
+ * rise, transit and set of the day of d from the shared
+ * cache of self, computed and stored there on a miss.
+ * returns 0 when self has none.
+ */
+static int
+shared_rts(VALUE self, double d, double lat, double lon, int mode,
+           double v[3]){
+  VALUE vcache = rb_attr_get(self, id_shared_cache);
+  if (NIL_P(vcache)) return 0;
+  shm_cache_rts(get_shared(vcache), d, lat, lon, mode, v);
+  return 1;
+}
+/*
+ * call-seq:
+ *  CalcSun::SharedCache.new(name, slots = 1 << 20, quantum = 1e-4)
+ *
+ * opens the POSIX shared memory segment name, like
+ * "/calc_sun", creating it with room for slots days of
+ * sites when no process has yet. the processes of a host
+ * that open the same name, forked workers included, share
+ * one another's rise, transit and set results. sites are
+ * rounded to a grid of quantum degrees, and the values are
+ * those of the grid point; 1e-4 degrees is about 11 metres
+ * and changes rise and set by well under a second.
+ * an existing segment keeps the slots and quantum it was
+ * made with.
+ *
+ */
+static VALUE shared_init(int argc, VALUE *argv, VALUE self){
+  VALUE vname, vslots, vquantum;
+  shm_cache *c;
+  long slots;
+  if (DATA_PTR(self)) rb_raise(rb_eTypeError, "already initialized cache");
+  rb_scan_args(argc, argv, "12", &vname, &vslots, &vquantum);
+  slots = NIL_P(vslots) ? 1L << 20 : NUM2LONG(vslots);
+  if (slots <= 0) rb_raise(rb_eArgError, "slots must be positive");
+  c = shm_cache_open(StringValueCStr(vname), (size_t)slots,
+                     NIL_P(vquantum) ? 1e-4 : NUM2DBL(vquantum));
+  if (!c){
+    if (errno == EINVAL)
+      rb_raise(rb_eArgError, "quantum must be in [1e-7, 1], or %s is not a cache",
+               RSTRING_PTR(vname));
+    rb_syserr_fail_str(errno, vname);
+  }
+  DATA_PTR(self) = c;
+  return self;
+}
+/*
+ * call-seq:
+ *  CalcSun::SharedCache.unlink(name)
+ *
+ * removes the segment name. processes that have it open
+ * keep using it; the next open makes a new one.
+ *
+ */
+static VALUE shared_s_unlink(VALUE klass, VALUE vname){
+  if (shm_cache_unlink(StringValueCStr(vname)) != 0)
+    rb_syserr_fail_str(errno, vname);
+  return Qnil;
+}
+/*
+ * call-seq:
+ *  slots
+ *
+ * entries the segment holds.
+ *
+ */
+static VALUE shared_slots(VALUE self){
+  return SIZET2NUM(shm_cache_slots(get_shared(self)));
+}
+/*
+ * call-seq:
+ *  quantum
+ *
+ * grid step of cached sites, in degrees.
+ *
+ */
+static VALUE shared_quantum(VALUE self){
+  return DBL2NUM(shm_cache_quantum(get_shared(self)));
+}
+/*
+ * call-seq:
+ *  cached(ajd, lat, lon, precision = :legacy)
+ *
+ * [rise, transit, set] ajds of the day of ajd at the grid
+ * point of lat, lon, as some process stored them, or nil.
+ *
+ */
+static VALUE shared_cached(int argc, VALUE *argv, VALUE self){
+  VALUE vajd, vlat, vlon, vprec;
+  double v[3];
+  rb_scan_args(argc, argv, "31", &vajd, &vlat, &vlon, &vprec);
+  if (!shm_cache_get(get_shared(self), get_days(vajd), NUM2DBL(vlat),
+                     NUM2DBL(vlon), prec_mode(vprec), v))
+    return Qnil;
+  return rb_ary_new3(3, DBL2NUM(v[0]), DBL2NUM(v[1]), DBL2NUM(v[2]));
+}
+/*
+ * call-seq:
+ *  shared_cache = cache
+ *
+ * makes rise, rise_jd, noon, noon_jd, set, set_jd and
+ * rise_set_batch read a CalcSun::SharedCache, and fill it
+ * on a miss, after any precompute_async table. nil stops.
+ *
+ */
+static VALUE func_set_shared_cache(VALUE self, VALUE vcache){
+  if (!NIL_P(vcache)) get_shared(vcache);
+  rb_ivar_set(self, id_shared_cache, vcache);
+  return vcache;
+}
+/*
+ * call-seq:
+ *  shared_cache
+ *
+ * the CalcSun::SharedCache in use, or nil.
+ *
+ */
+static VALUE func_get_shared_cache(VALUE self){
+  return rb_attr_get(self, id_shared_cache);
+}
+
+static void
+init_shared(VALUE cCalcSun){
+  id_shared_cache = rb_intern("@shared_cache");
+  cSharedCache = rb_define_class_under(cCalcSun, "SharedCache", rb_cObject);
+  rb_define_alloc_func(cSharedCache, shared_alloc);
+  rb_define_singleton_method(cSharedCache, "unlink", shared_s_unlink, 1);
+  rb_define_method(cSharedCache, "initialize", shared_init, -1);
+  rb_define_method(cSharedCache, "cached", shared_cached, -1);
+  rb_define_method(cSharedCache, "quantum", shared_quantum, 0);
+  rb_define_method(cSharedCache, "slots", shared_slots, 0);
+}
+
+#endif
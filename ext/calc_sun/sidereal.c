@@ -0,0 +1,51 @@
+#include <math.h>
+#include "sidereal.h"
+
+double
+sidereal_gmsa(double d){
+  return sidereal_gmsa_inline(d);
+}
+
+double
+sidereal_gmst(double d){
+  return sidereal_gmsa(d) / 15.0;
+}
+
+double
+sidereal_lmst(double d, double lon){
+  return sidereal_rev360(sidereal_gmsa(d) + lon) / 15.0;
+}
+
+void
+sidereal_gmst_batch(const double *d, double *gmst, size_t n){
+  size_t i;
+  for (i = 0; i < n; i++)
+    gmst[i] = sidereal_gmsa_inline(d[i]) / 15.0;
+}
+
+void
+sidereal_lmst_batch(const double *d, const double *lon,
+                    size_t lon_stride, double *lmst, size_t n){
+  size_t i;
+  for (i = 0; i < n; i++)
+    lmst[i] = sidereal_rev360(sidereal_gmsa_inline(d[i]) + lon[i * lon_stride]) / 15.0;
+}
+
+void
+sidereal_gmst_steps(double d0, double step, double *gmst, size_t n){
+  size_t i = 0;
+  while (i < n){
+    size_t k;
+    size_t m = n - i < SIDEREAL_BLOCK ? n - i : SIDEREAL_BLOCK;
+    double da = d0 + step * (double)i;
+    double db = d0 + step * (double)(i + m);
+    double a0 = sidereal_gmsa(da);
+    /* linear rate plus the mean slope of the slow terms over the block */
+    double rate =
+    SIDEREAL_RATE * step +
+    (sidereal_slow_terms(db) - sidereal_slow_terms(da)) / (double)m;
+    for (k = 0; k < m; k++)
+      gmst[i + k] = sidereal_rev360(a0 + rate * (double)k) / 15.0;
+    i += m;
+  }
+}
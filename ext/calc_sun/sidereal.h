@@ -0,0 +1,79 @@
+/*
+ * sidereal.h
+ *
+ * Sidereal time core shared by the CalcSun and
+ * SideTime extensions. No Ruby dependency.
+ *
+ * Times are given as days from J2000 (ajd - 2451545.0),
+ * longitudes in degrees, positive east.
+ * Results are raw doubles, not rounded.
+ */
+#ifndef CALC_SUN_SIDEREAL_H
+#define CALC_SUN_SIDEREAL_H
+
+#include <stddef.h>
+#include <math.h>
+#include "fast_trig.h"
+
+/* mean sidereal rate in degrees per day */
+#define SIDEREAL_RATE 360.98564736629
+/* steps between exact evaluations in sidereal_gmst_steps() */
+#define SIDEREAL_BLOCK 256
+
+/* slowly varying part of the GMST polynomial in degrees */
+static inline double
+sidereal_slow_terms(double d){
+  double t = d / 36525.0;
+  return t * t * (0.000387933 - t / 38710000.0);
+}
+
+static inline double
+sidereal_rev360(double a){
+  return a - 360.0 * ft_floor(a / 360.0);
+}
+/* GMST angle in degrees, inlined for the batch kernels */
+static inline double
+sidereal_gmsa_inline(double d){
+  /* 360.98564736629 * d split so the whole
+  * turns drop out before the sum is formed
+  */
+  double a =
+  280.46061837 +
+  360.0 * (d - ft_floor(d)) +
+  (SIDEREAL_RATE - 360.0) * d +
+  sidereal_slow_terms(d);
+  return sidereal_rev360(a);
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Greenwich Mean Sidereal Time as angle in degrees, 0 to 360 */
+double sidereal_gmsa(double d);
+/* Greenwich Mean Sidereal Time in hours, 0 to 24 */
+double sidereal_gmst(double d);
+/* Local Mean Sidereal Time in hours, 0 to 24 */
+double sidereal_lmst(double d, double lon);
+
+/* GMST in hours for n instants */
+void sidereal_gmst_batch(const double *d, double *gmst, size_t n);
+/*
+ * LMST in hours for n instants. lon is read with
+ * lon_stride, so a stride of 0 applies one longitude to all.
+ */
+void sidereal_lmst_batch(const double *d, const double *lon,
+                         size_t lon_stride, double *lmst, size_t n);
+/*
+ * GMST in hours for the fixed step stream d0 + i * step,
+ * i = 0 .. n-1. The polynomial is evaluated once per
+ * SIDEREAL_BLOCK steps and the angle advanced by the rate
+ * in between.
+ */
+void sidereal_gmst_steps(double d0, double step, double *gmst, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ * sidereal_rb.h
+ *
+ * Ruby glue for the batch sidereal entry points,
+ * shared by the CalcSun and SideTime extensions.
+ * The including file defines SIDEREAL_RB_DAYS(v)
+ * to read an ajd argument as days from J2000.
+ */
+#ifndef CALC_SUN_SIDEREAL_RB_H
+#define CALC_SUN_SIDEREAL_RB_H
+
+#include "sidereal.h"
+
+#ifndef SIDEREAL_RB_DAYS
+# define SIDEREAL_RB_DAYS(v) (NUM2DBL(v) - 2451545.0)
+#endif
+
+/* Array of Floats from n doubles */
+static VALUE
+sidereal_rb_ary(const double *v, long n){
+  long i;
+  VALUE vary = rb_ary_new2(n);
+  for (i = 0; i < n; i++)
+    rb_ary_push(vary, DBL2NUM(v[i]));
+  return vary;
+}
+/*
+ * call-seq:
+ *  gmst_batch(ajds)
+ *
+ * given an Array of Astronomical Julian Day Numbers
+ * returns an Array of Greenwich Mean Sidereal Times in hours.
+ * not rounded.
+ *
+ */
+static VALUE func_gmst_batch(VALUE self, VALUE vajds){
+  long i, n;
+  double *d;
+  VALUE vtmp, vary;
+  Check_Type(vajds, T_ARRAY);
+  n = RARRAY_LEN(vajds);
+  d = ALLOCV_N(double, vtmp, 2 * n + 1);
+  for (i = 0; i < n; i++)
+    d[i] = SIDEREAL_RB_DAYS(rb_ary_entry(vajds, i));
+  sidereal_gmst_batch(d, d + n, (size_t)n);
+  vary = sidereal_rb_ary(d + n, n);
+  ALLOCV_END(vtmp);
+  return vary;
+}
+/*
+ * call-seq:
+ *  lmst_batch(ajds, lons)
+ *
+ * given an Array of Astronomical Julian Day Numbers and
+ * an Array of Longitudes, or one Longitude for all,
+ * returns an Array of Local Mean Sidereal Times in hours.
+ * not rounded.
+ *
+ */
+static VALUE func_lmst_batch(VALUE self, VALUE vajds, VALUE vlons){
+  long i, n;
+  size_t stride = 1;
+  double *d, *lon;
+  VALUE vtmp, vary;
+  Check_Type(vajds, T_ARRAY);
+  n = RARRAY_LEN(vajds);
+  d = ALLOCV_N(double, vtmp, 3 * n + 1);
+  lon = d + 2 * n;
+  if (RB_TYPE_P(vlons, T_ARRAY)){
+    if (RARRAY_LEN(vlons) != n){
+      ALLOCV_END(vtmp);
+      rb_raise(rb_eArgError, "ajds and lons differ in length");
+    }
+    for (i = 0; i < n; i++)
+      lon[i] = NUM2DBL(rb_ary_entry(vlons, i));
+  }
+  else{
+    lon[0] = NUM2DBL(vlons);
+    stride = 0;
+  }
+  for (i = 0; i < n; i++)
+    d[i] = SIDEREAL_RB_DAYS(rb_ary_entry(vajds, i));
+  sidereal_lmst_batch(d, lon, stride, d + n, (size_t)n);
+  vary = sidereal_rb_ary(d + n, n);
+  ALLOCV_END(vtmp);
+  return vary;
+}
+/*
+ * call-seq:
+ *  gmst_steps(ajd, step, count)
+ *
+ * given a starting Astronomical Julian Day Number,
+ * a step in days and a count,
+ * returns an Array of Greenwich Mean Sidereal Times in hours
+ * for the evenly spaced stream.
+ * not rounded.
+ *
+ */
+static VALUE func_gmst_steps(VALUE self, VALUE vajd, VALUE vstep, VALUE vcount){
+  long n = NUM2LONG(vcount);
+  double *gmst;
+  VALUE vtmp, vary;
+  if (n < 0) rb_raise(rb_eArgError, "negative count");
+  gmst = ALLOCV_N(double, vtmp, n + 1);
+  sidereal_gmst_steps(SIDEREAL_RB_DAYS(vajd), NUM2DBL(vstep), gmst, (size_t)n);
+  vary = sidereal_rb_ary(gmst, n);
+  ALLOCV_END(vtmp);
+  return vary;
+}
+
+#endif
@@ -0,0 +1,199 @@
+/*
+ * solar.cpp
+ *
+ * The C functions of solar.h, each one instantiating
+ * calc_sun::chain<double> from calc_sun.hpp with the
+ * rounding of its mode. SOLAR_ROUND12 runs the raw chain,
+ * the caller rounds the final value.
+ *
+ * The functions of whole days, rise, transit, set and their
+ * parts, read the site free state of their day from a
+ * process wide table filled on first touch, a segment of
+ * SEGMENT_DAYS days at a time. A segment is published by a
+ * compare and swap of its pointer, the loser of a race
+ * dropping its copy, so readers on any thread take no lock.
+ * Segments live as long as the process. Values are the
+ * chain's to the bit, the table only skips recomputing
+ * them.
+ */
+#include <atomic>
+#include <cstdlib>
+#include "solar.h"
+#include "calc_sun.hpp"
+
+typedef calc_sun::chain<double, calc_sun::raw> raw_chain;
+typedef calc_sun::chain<double, calc_sun::legacy> legacy_chain;
+
+namespace {
+
+/* days from J2000 the table covers, half each way, about 1435 years */
+const long TABLE_DAYS = 1L << 20;
+const long SEGMENT_DAYS = 32;
+const long SEGMENTS = TABLE_DAYS / SEGMENT_DAYS;
+
+template <class Chain>
+struct day_table {
+  struct entry {
+    typename Chain::day_state s;
+    double dec, rv, eot, gmst0;
+  };
+  struct segment {
+    entry e[SEGMENT_DAYS];
+  };
+
+  static std::atomic<segment *> segments[SEGMENTS];
+  static std::atomic<long> filled;
+
+  static void fill(entry &e, double jd){
+    e.s = Chain::day(jd);
+    e.dec = Chain::declination(jd);
+    e.rv = Chain::rv(jd);
+    e.eot = Chain::eot(jd);
+    e.gmst0 = Chain::gmst0(jd);
+  }
+
+  /* the entry of the day of d, NULL outside the table or out of memory */
+  static const entry *at(double d){
+    double jd = std::floor(d);
+    long k, i;
+    segment *seg, *mine;
+    if (!(jd >= -TABLE_DAYS / 2 && jd < TABLE_DAYS / 2)) return NULL;
+    k = (long)jd + TABLE_DAYS / 2;
+    std::atomic<segment *> &slot = segments[k / SEGMENT_DAYS];
+    seg = slot.load(std::memory_order_acquire);
+    if (!seg){
+      /* malloc, so C programs link libcalcsun.a without libstdc++ */
+      if (!(mine = (segment *)std::malloc(sizeof *mine))) return NULL;
+      for (i = 0; i < SEGMENT_DAYS; i++)
+        fill(mine->e[i], (double)(k - k % SEGMENT_DAYS + i - TABLE_DAYS / 2));
+      if (slot.compare_exchange_strong(seg, mine, std::memory_order_acq_rel,
+                                       std::memory_order_acquire)){
+        seg = mine;
+        filled.fetch_add(1, std::memory_order_relaxed);
+      }
+      else
+        std::free(mine);
+    }
+    return &seg->e[k % SEGMENT_DAYS];
+  }
+
+  static typename Chain::day_state state(double d){
+    const entry *e = at(d);
+    return e ? e->s : Chain::day(d);
+  }
+};
+
+template <class Chain>
+std::atomic<typename day_table<Chain>::segment *>
+day_table<Chain>::segments[SEGMENTS];
+
+template <class Chain>
+std::atomic<long> day_table<Chain>::filled(0);
+
+typedef day_table<raw_chain> raw_table;
+typedef day_table<legacy_chain> legacy_table;
+
+}
+
+#define SOLAR_FN1(name) \
+  double solar_##name(double d, int mode){ \
+    return mode == SOLAR_LEGACY ? \
+      legacy_chain::name(d) : raw_chain::name(d); \
+  }
+#define SOLAR_FN2(name, a) \
+  double solar_##name(double d, double a, int mode){ \
+    return mode == SOLAR_LEGACY ? \
+      legacy_chain::name(d, a) : raw_chain::name(d, a); \
+  }
+#define SOLAR_FN3(name) \
+  double solar_##name(double d, double lat, double lon, int mode){ \
+    return mode == SOLAR_LEGACY ? \
+      legacy_chain::name(d, lat, lon) : raw_chain::name(d, lat, lon); \
+  }
+/* from the table at whole days d, field f of the entry */
+#define SOLAR_WHOLE1(name, f) \
+  double solar_##name(double d, int mode){ \
+    if (d == std::floor(d)){ \
+      if (mode == SOLAR_LEGACY){ \
+        const legacy_table::entry *e = legacy_table::at(d); \
+        if (e) return e->f; \
+      } \
+      else{ \
+        const raw_table::entry *e = raw_table::at(d); \
+        if (e) return e->f; \
+      } \
+    } \
+    return mode == SOLAR_LEGACY ? \
+      legacy_chain::name(d) : raw_chain::name(d); \
+  }
+/* from the state of the day of d in the table */
+#define SOLAR_DAY2(name, a) \
+  double solar_##name(double d, double a, int mode){ \
+    return mode == SOLAR_LEGACY ? \
+      legacy_chain::name(legacy_table::state(d), a) : \
+      raw_chain::name(raw_table::state(d), a); \
+  }
+#define SOLAR_DAY3(name) \
+  double solar_##name(double d, double lat, double lon, int mode){ \
+    return mode == SOLAR_LEGACY ? \
+      legacy_chain::name(legacy_table::state(d), lat, lon) : \
+      raw_chain::name(raw_table::state(d), lat, lon); \
+  }
+#define SOLAR_JD3(name) \
+  double solar_##name(double d, double lat, double lon, int mode){ \
+    return mode == SOLAR_LEGACY ? \
+      legacy_chain::name(d, legacy_table::state(d), lat, lon) : \
+      raw_chain::name(d, raw_table::state(d), lat, lon); \
+  }
+
+SOLAR_FN1(mean_anomaly)
+SOLAR_FN1(eccentricity)
+SOLAR_FN1(equation_of_center)
+SOLAR_FN1(true_anomaly)
+SOLAR_FN1(mean_longitude)
+SOLAR_FN1(eccentric_anomaly)
+SOLAR_FN1(obliquity_of_ecliptic)
+SOLAR_FN1(longitude_of_perihelion)
+SOLAR_FN1(xv)
+SOLAR_FN1(yv)
+SOLAR_FN1(true_anomaly1)
+SOLAR_FN1(true_longitude)
+SOLAR_WHOLE1(mean_sidetime, s.mst)
+SOLAR_FN1(gmsa0)
+SOLAR_FN1(gmsa)
+SOLAR_WHOLE1(gmst0, gmst0)
+SOLAR_FN1(gmst)
+SOLAR_WHOLE1(rv, rv)
+SOLAR_FN1(ecliptic_x)
+SOLAR_FN1(ecliptic_y)
+SOLAR_WHOLE1(right_ascension, s.ra)
+SOLAR_FN1(gha)
+SOLAR_WHOLE1(declination, dec)
+SOLAR_FN2(local_sidetime, lon)
+SOLAR_DAY2(cos_h0, lat)
+SOLAR_DAY2(dlt, lat)
+SOLAR_DAY2(diurnal_arc, lat)
+SOLAR_DAY2(t_south, lon)
+SOLAR_DAY3(t_rise)
+SOLAR_DAY3(t_mid_day)
+SOLAR_DAY3(t_set)
+SOLAR_JD3(rise_jd)
+SOLAR_JD3(noon_jd)
+SOLAR_JD3(set_jd)
+SOLAR_FN2(days_from_2000, lon)
+SOLAR_WHOLE1(eot, eot)
+SOLAR_FN1(eot_jd)
+SOLAR_FN1(eot_min)
+SOLAR_FN2(lha, lon)
+SOLAR_FN3(altitude)
+SOLAR_FN3(azimuth)
+SOLAR_FN3(rise_az)
+SOLAR_FN3(noon_az)
+SOLAR_FN3(set_az)
+
+size_t
+solar_day_table_size(void){
+  return (size_t)(raw_table::filled.load(std::memory_order_relaxed) +
+                  legacy_table::filled.load(std::memory_order_relaxed)) *
+    sizeof(raw_table::segment);
+}
@@ -0,0 +1,125 @@
+/*
+ * solar.h
+ *
+ * The CalcSun solar chain as plain C functions, no Ruby
+ * dependency. Implemented in solar.cpp over the templates
+ * of calc_sun.hpp.
+ *
+ * Every function takes d, the days from J2000
+ * (ajd - 2451545.0), and returns the same units as the
+ * CalcSun method of the same name.
+ *
+ * mode selects how values are rounded:
+ *  SOLAR_RAW     no rounding at all, fastest
+ *  SOLAR_ROUND12 no rounding inside the chain; the
+ *                caller rounds final values with solar_round12()
+ *  SOLAR_LEGACY  every hop rounded through single precision
+ *                roundf(v * RND12) / RND12 exactly as
+ *                calc_sun 1.2 did, for identical results
+ */
+#ifndef CALC_SUN_SOLAR_H
+#define CALC_SUN_SOLAR_H
+
+#include <math.h>
+#include <stddef.h>
+
+/* if PI's not defined, define it */
+#ifndef PI
+#define PI 3.1415926535897932384626433832795028841971L
+#endif
+# define PI2 PI * 2.0
+# define R2D 57.295779513082320876798154814105L
+# define D2R 0.017453292519943295769236907684886L
+# define M2PI M_PI * 2.0
+# define INV24 1.0 / 24.0
+# define INV360 1.0 / 360.0
+# define DJ00 2451545.0L
+# define RND12 1000000000000.0L
+
+enum {
+  SOLAR_RAW,
+  SOLAR_ROUND12,
+  SOLAR_LEGACY
+};
+
+/* macro for normalizing
+* angles into 0-2pie range
+*/
+static inline double
+anp(double angle){
+  double w = fmod(angle, M2PI);
+  if (w < 0) w += M2PI;
+  return w;
+}
+/* exact rounding to 12 decimal places in double */
+static inline double
+solar_round12(double v){
+  return round(v * 1e12) / 1e12;
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+double solar_mean_anomaly(double d, int mode);
+double solar_eccentricity(double d, int mode);
+double solar_equation_of_center(double d, int mode);
+double solar_true_anomaly(double d, int mode);
+double solar_mean_longitude(double d, int mode);
+double solar_eccentric_anomaly(double d, int mode);
+double solar_obliquity_of_ecliptic(double d, int mode);
+double solar_longitude_of_perihelion(double d, int mode);
+double solar_xv(double d, int mode);
+double solar_yv(double d, int mode);
+double solar_true_anomaly1(double d, int mode);
+double solar_true_longitude(double d, int mode);
+double solar_mean_sidetime(double d, int mode);
+double solar_gmsa0(double d, int mode);
+double solar_gmsa(double d, int mode);
+double solar_gmst0(double d, int mode);
+double solar_gmst(double d, int mode);
+double solar_rv(double d, int mode);
+double solar_ecliptic_x(double d, int mode);
+double solar_ecliptic_y(double d, int mode);
+double solar_right_ascension(double d, int mode);
+double solar_gha(double d, int mode);
+double solar_declination(double d, int mode);
+double solar_local_sidetime(double d, double lon, int mode);
+/*
+ * cosine of the hour angle of rise and set that solar_dlt()
+ * takes the arc of: past 1 when the Sun stays down all day,
+ * past -1 when it stays up, dlt NaN in both
+ */
+double solar_cos_h0(double d, double lat, int mode);
+double solar_dlt(double d, double lat, int mode);
+double solar_diurnal_arc(double d, double lat, int mode);
+double solar_t_south(double d, double lon, int mode);
+double solar_t_rise(double d, double lat, double lon, int mode);
+double solar_t_mid_day(double d, double lat, double lon, int mode);
+double solar_t_set(double d, double lat, double lon, int mode);
+/* these three return an ajd */
+double solar_rise_jd(double d, double lat, double lon, int mode);
+double solar_noon_jd(double d, double lat, double lon, int mode);
+double solar_set_jd(double d, double lat, double lon, int mode);
+double solar_days_from_2000(double d, double lon, int mode);
+double solar_eot(double d, int mode);
+double solar_eot_jd(double d, int mode);
+double solar_eot_min(double d, int mode);
+double solar_lha(double d, double lon, int mode);
+double solar_altitude(double d, double lat, double lon, int mode);
+double solar_azimuth(double d, double lat, double lon, int mode);
+double solar_rise_az(double d, double lat, double lon, int mode);
+double solar_noon_az(double d, double lat, double lon, int mode);
+double solar_set_az(double d, double lat, double lon, int mode);
+
+/*
+ * bytes held by the table of day states solar.cpp fills as
+ * days are first touched, both precisions
+ */
+size_t solar_day_table_size(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
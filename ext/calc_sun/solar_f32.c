@@ -0,0 +1,70 @@
+#include <math.h>
+#include "solar_f32.h"
+#include "sidereal.h"
+#include "fast_trig.h"
+
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+# define SOLAR_F32_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+# define SOLAR_F32_CLONES
+#endif
+
+#define D2R_F 0.017453292519943295f
+
+/* degrees reduced to one turn, in double */
+static inline double
+rev(double a){
+  return a - 360.0 * ft_floor(a * (1.0 / 360.0));
+}
+
+SOLAR_F32_CLONES void
+solar_altaz_f32(const double *d, const float *lat, const float *lon,
+                float *alt, float *az, size_t n){
+  size_t i;
+  for (i = 0; i < n; i++){
+    double dd = d[i];
+    double t = dd / 36525.0;
+    /* growing terms reduced in double */
+    float ma = (float)rev(357.52910918 + t * (35999.05029113889 +
+      t * (1.0 / -6507.592190889371))) * D2R_F;
+    float ml = (float)rev(280.4664567 + 0.9856473601037645 * dd) * D2R_F;
+    float gmst = (float)sidereal_gmsa_inline(dd) * D2R_F;
+    float e = (float)(0.016709 - 1.151e-9 * dd);
+    float ooe = (float)(23.439291 - 3.563E-7 * dd) * D2R_F;
+    float s1, c1, s2, c2, s3, s4, c4, s5;
+    float eoc, stl, ctl, se, ce, ra, sdec, cdec;
+    float slat, clat, sh, ch, hx, hy, hz;
+    /* multiple angles of the mean anomaly */
+    ft_sincosf(ma, &s1, &c1);
+    s2 = 2.0f * s1 * c1;
+    c2 = c1 * c1 - s1 * s1;
+    s3 = s2 * c1 + c2 * s1;
+    s4 = 2.0f * s2 * c2;
+    c4 = c2 * c2 - s2 * s2;
+    s5 = s4 * c1 + c4 * s1;
+    /* equation of center as in solar_equation_of_center() */
+    eoc = e * (s1 * 2.0f + e * (s2 * 1.25f + e * (
+      (s3 * 13.0f / 12.0f - s1 * 0.25f) + e * (
+      (s4 * 103.0f / 96.0f - s2 * 11.0f / 24.0f) + e * (
+      s5 * 1097.0f / 960.0f + s1 * 5.0f / 96.0f - s3 * 43.0f / 64.0f)))));
+    ft_sincosf(ml + eoc, &stl, &ctl);
+    ft_sincosf(ooe, &se, &ce);
+    ra = ft_atan2f(stl * ce, ctl);
+    /* declination as solar_declination() forms it,
+    * atan2(ecliptic y * sin(ooe), radius vector)
+    */
+    cdec = 1.0f / sqrtf(1.0f + stl * se * stl * se);
+    sdec = stl * se * cdec;
+    ft_sincosf(lat[i] * D2R_F, &slat, &clat);
+    ft_sincosf(gmst + lon[i] * D2R_F - ra, &sh, &ch);
+    /* horizon frame components, altitude from atan2 of them
+    * stays well conditioned near the zenith
+    */
+    hx = cdec * sh;
+    hy = cdec * ch * slat - sdec * clat;
+    hz = slat * sdec + clat * cdec * ch;
+    alt[i] = ft_atan2f(hz, sqrtf(hx * hx + hy * hy)) * (180.0f / FT_PI_F);
+    /* tan(dec) folded into the atan2 arguments by cos(dec) */
+    az[i] = ft_atan2f(hx, hy) * (180.0f / FT_PI_F) + 180.0f;
+  }
+}
@@ -0,0 +1,48 @@
+/*
+ * solar_f32.h
+ *
+ * Single precision batch kernel of the solar chain,
+ * mean anomaly through declination to altitude and azimuth,
+ * for visualization where ~0.01 degree is plenty.
+ * No Ruby dependency.
+ *
+ * Terms that grow with time (mean anomaly, mean longitude,
+ * sidereal angle) are reduced to one turn in double precision
+ * before dropping to float, so accuracy does not decay away
+ * from J2000. Trig comes from fast_trig.h and the loop is
+ * built for AVX-512, AVX2 and baseline, picked at load time
+ * where the compiler supports it.
+ *
+ * Error against the double chain (SOLAR_RAW), random sweep
+ * of 800k samples over 1900 to 2100, latitudes -89 to 89
+ * and all longitudes:
+ *  altitude  < 0.0003 degrees
+ *  azimuth   < 0.0015 degrees below 85 degrees altitude,
+ *            growing as 1 / cos(altitude) above it
+ *            (0.003 at 88, 0.01 at 89.5)
+ */
+#ifndef CALC_SUN_SOLAR_F32_H
+#define CALC_SUN_SOLAR_F32_H
+
+#include <stddef.h>
+
+/* error bounds above, in degrees */
+#define SOLAR_F32_ALT_ERR 0.0003
+#define SOLAR_F32_AZ_ERR 0.0015
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * altitude and azimuth in degrees for n samples of
+ * d days from J2000 at lat, lon in degrees.
+ */
+void solar_altaz_f32(const double *d, const float *lat, const float *lon,
+                     float *alt, float *az, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
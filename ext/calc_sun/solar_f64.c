@@ -0,0 +1,100 @@
+#include <math.h>
+#include "solar_f64.h"
+#include "sidereal.h"
+#include "fast_trig.h"
+
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+# define SOLAR_F64_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+# define SOLAR_F64_CLONES
+#endif
+
+#define D2R_D 0.017453292519943295769
+#define R2D_D 57.295779513082320877
+
+/* degrees reduced to one turn */
+static inline double
+rev(double a){
+  return a - 360.0 * ft_floor(a * (1.0 / 360.0));
+}
+
+/* trig of the tier, trig is a constant once inlined */
+static inline void
+sincos_deg(double x, double *s, double *c, const int trig){
+  if (trig == FT_TRIG_FULL){
+    *s = sin(x * D2R_D);
+    *c = cos(x * D2R_D);
+  }
+  else
+    ft_sincosd(x, s, c);
+}
+
+static inline double
+atan2_tier(double y, double x, const int trig){
+  return trig == FT_TRIG_FULL ? atan2(y, x) : ft_atan2(y, x);
+}
+
+static inline void
+altaz_loop(const double *d, const double *lat, const double *lon,
+           double *alt, double *az, size_t n, const int trig){
+  size_t i;
+  for (i = 0; i < n; i++){
+    double dd = d[i];
+    double t = dd / 36525.0;
+    double ma = rev(357.52910918 + t * (35999.05029113889 +
+      t * (1.0 / -6507.592190889371)));
+    double ml = rev(280.4664567 + 0.9856473601037645 * dd);
+    double gmst = sidereal_gmsa_inline(dd);
+    double e = 0.016709 - 1.151e-9 * dd;
+    double ooe = 23.439291 - 3.563E-7 * dd;
+    double s1, c1, s2, c2, s3, s4, c4, s5;
+    double eoc, stl, ctl, se, ce, ra, sdec, cdec;
+    double slat, clat, sh, ch, hx, hy, hz;
+    /* multiple angles of the mean anomaly */
+    sincos_deg(ma, &s1, &c1, trig);
+    s2 = 2.0 * s1 * c1;
+    c2 = c1 * c1 - s1 * s1;
+    s3 = s2 * c1 + c2 * s1;
+    s4 = 2.0 * s2 * c2;
+    c4 = c2 * c2 - s2 * s2;
+    s5 = s4 * c1 + c4 * s1;
+    /* equation of center as in solar_equation_of_center() */
+    eoc = e * (s1 * 2.0 + e * (s2 * 1.25 + e * (
+      (s3 * 13.0 / 12.0 - s1 * 0.25) + e * (
+      (s4 * 103.0 / 96.0 - s2 * 11.0 / 24.0) + e * (
+      s5 * 1097.0 / 960.0 + s1 * 5.0 / 96.0 - s3 * 43.0 / 64.0)))));
+    sincos_deg(ml + eoc * R2D_D, &stl, &ctl, trig);
+    sincos_deg(ooe, &se, &ce, trig);
+    ra = atan2_tier(stl * ce, ctl, trig) * R2D_D;
+    cdec = 1.0 / sqrt(1.0 + stl * se * stl * se);
+    sdec = stl * se * cdec;
+    sincos_deg(lat[i], &slat, &clat, trig);
+    sincos_deg(gmst + lon[i] - ra, &sh, &ch, trig);
+    hx = cdec * sh;
+    hy = cdec * ch * slat - sdec * clat;
+    hz = slat * sdec + clat * cdec * ch;
+    alt[i] = atan2_tier(hz, sqrt(hx * hx + hy * hy), trig) * R2D_D;
+    az[i] = atan2_tier(hx, hy, trig) * R2D_D + 180.0;
+  }
+}
+
+SOLAR_F64_CLONES static void
+altaz_fast(const double *d, const double *lat, const double *lon,
+           double *alt, double *az, size_t n){
+  altaz_loop(d, lat, lon, alt, az, n, FT_TRIG_1E9);
+}
+
+static void
+altaz_full(const double *d, const double *lat, const double *lon,
+           double *alt, double *az, size_t n){
+  altaz_loop(d, lat, lon, alt, az, n, FT_TRIG_FULL);
+}
+
+void
+solar_altaz_f64(const double *d, const double *lat, const double *lon,
+                double *alt, double *az, size_t n, int trig){
+  if (trig == FT_TRIG_FULL)
+    altaz_full(d, lat, lon, alt, az, n);
+  else
+    altaz_fast(d, lat, lon, alt, az, n);
+}
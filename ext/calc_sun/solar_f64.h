@@ -0,0 +1,37 @@
+/*
+ * solar_f64.h
+ *
+ * Double precision batch kernel of the solar chain, the
+ * same steps as solar_f32.h with the trig tier chosen by
+ * the caller from fast_trig.h. No Ruby dependency.
+ *
+ * Error against the double chain (SOLAR_RAW), random sweep
+ * of 800k samples over 1900 to 2100, latitudes -89 to 89
+ * and all longitudes:
+ *  FT_TRIG_1E9   altitude < 3e-8, azimuth < 5e-7 degrees
+ *  FT_TRIG_FULL  altitude < 2e-9, azimuth < 1e-7 degrees
+ * azimuth below 85 degrees altitude, growing as
+ * 1 / cos(altitude) above it. FT_TRIG_1E6 gives FT_TRIG_1E9.
+ */
+#ifndef CALC_SUN_SOLAR_F64_H
+#define CALC_SUN_SOLAR_F64_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * altitude and azimuth in degrees for n samples of
+ * d days from J2000 at lat, lon in degrees, trig one of
+ * the FT_TRIG_ tiers.
+ */
+void solar_altaz_f64(const double *d, const double *lat, const double *lon,
+                     double *alt, double *az, size_t n, int trig);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -199,6 +199,24 @@ double topocentric_zenith_angle(double e);
 double topocentric_azimuth_angle_astro(double h_prime, double latitude, double delta_prime);
 double topocentric_azimuth_angle(double azimuth_astro);
 
+//-------------- Rise/transit/set steps, for spa_rts.c --------------
+int    validate_inputs(spa_data *spa);
+double julian_day (int year, int month, int day, int hour, int minute, double second,
+                   double dut1, double tz);
+double julian_century(double jd);
+double greenwich_mean_sidereal_time (double jd, double jc);
+double greenwich_sidereal_time (double nu0, double delta_psi, double epsilon);
+double limit_degrees180pm(double degrees);
+double dayfrac_to_local_hr(double dayfrac, double timezone);
+double approx_sun_transit_time(double alpha_zero, double longitude, double nu);
+double sun_hour_angle_at_rise_set(double latitude, double delta_zero, double h0_prime);
+void   approx_sun_rise_and_set(double *m_rts, double h0);
+double rts_alpha_delta_prime(double *ad, double n);
+double rts_sun_altitude(double latitude, double delta_prime, double h_prime);
+double sun_rise_and_set(double *m_rts,   double *h_rts,   double *delta_prime, double latitude,
+                        double *h_prime, double h0_prime, int sun);
+void   calculate_geocentric_sun_right_ascension_and_declination(spa_data *spa);
+
 
 //Calculate SPA output values (in structure) based on input values passed in structure
 int spa_calculate(spa_data *spa);
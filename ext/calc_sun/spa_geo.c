@@ -0,0 +1,84 @@
+#include <math.h>
+#include "spa_geo.h"
+
+/* as in spa.c, so results match it to the bit */
+#define PI         3.1415926535897932384626433832795028841971
+#define SUN_RADIUS 0.26667
+#define GEO_D2R    (PI/180.0)
+#define GEO_R2D    (180.0/PI)
+
+static inline double
+geo_limit_degrees(double degrees){
+  double limited;
+  degrees /= 360.0;
+  limited = 360.0 * (degrees - floor(degrees));
+  if (limited < 0) limited += 360.0;
+  return limited;
+}
+
+int
+spa_geo_at(spa_geo *g, double jd, double delta_t){
+  spa_data sd;
+  if (fabs(delta_t) > 8000) return 7;
+  sd.jd = jd;
+  sd.delta_t = delta_t;
+  calculate_geocentric_sun_right_ascension_and_declination(&sd);
+  g->jd = jd;
+  g->jde = sd.jde;
+  g->nu = sd.nu;
+  g->alpha = sd.alpha;
+  g->delta = sd.delta;
+  g->r = sd.r;
+  g->del_psi = sd.del_psi;
+  g->epsilon = sd.epsilon;
+  g->xi = 8.794 / (3600.0 * sd.r);
+  return 0;
+}
+
+/*
+ * the topocentric half of spa_calculate() with the terms
+ * that only depend on the instant taken out of the loop
+ */
+void
+spa_observe(const spa_geo *g, const spa_atmos *atm, size_t n,
+            const double *lat, const double *lon, const double *elev,
+            double *e0, double *e, double *azimuth){
+  const double xi_rad = GEO_D2R * g->xi;
+  const double delta_rad = GEO_D2R * g->delta;
+  const double sin_xi = sin(xi_rad);
+  const double sin_delta = sin(delta_rad);
+  const double cos_delta = cos(delta_rad);
+  const double refract_min = -1 * (SUN_RADIUS + atm->atmos_refract);
+  const double refract_k = (atm->pressure / 1010.0) *
+                           (283.0 / (273.0 + atm->temperature)) * 1.02;
+  size_t i;
+  for (i = 0; i < n; i++){
+    double lat_rad = GEO_D2R * lat[i];
+    double sin_lat = sin(lat_rad), cos_lat = cos(lat_rad);
+    double h = geo_limit_degrees(g->nu + lon[i] - g->alpha);
+    double h_rad = GEO_D2R * h;
+    double el = elev ? elev[i] : 0.0;
+    double u = atan(0.99664719 * tan(lat_rad));
+    double y = 0.99664719 * sin(u) + el * sin_lat / 6378140.0;
+    double x = cos(u) + el * cos_lat / 6378140.0;
+    double den = cos_delta - x * sin_xi * cos(h_rad);
+    double del_alpha_rad = atan2(-x * sin_xi * sin(h_rad), den);
+    double dp = GEO_R2D * atan2((sin_delta - y * sin_xi) * cos(del_alpha_rad), den);
+    double dp_rad = GEO_D2R * dp;
+    double hp_rad = GEO_D2R * (h - GEO_R2D * del_alpha_rad);
+    double ee = GEO_R2D * asin(sin_lat * sin(dp_rad) +
+                               cos_lat * cos(dp_rad) * cos(hp_rad));
+    if (e0) e0[i] = ee;
+    if (e){
+      double del_e = 0;
+      if (ee >= refract_min)
+        del_e = refract_k / (60.0 * tan(GEO_D2R * (ee + 10.3 / (ee + 5.11))));
+      e[i] = ee + del_e;
+    }
+    if (azimuth){
+      double az = geo_limit_degrees(GEO_R2D * atan2(sin(hp_rad),
+                    cos(hp_rad) * sin_lat - tan(dp_rad) * cos_lat));
+      azimuth[i] = geo_limit_degrees(az + 180.0);
+    }
+  }
+}
@@ -0,0 +1,65 @@
+/*
+ * spa_geo.h
+ *
+ * NREL SPA split in two: the geocentric Sun of one instant,
+ * then the topocentric position for any number of observers.
+ * No Ruby dependency.
+ *
+ * spa_calculate() redoes the heliocentric and nutation
+ * series for every observer. spa_geo_at() does them once
+ * and spa_observe() walks arrays of observers with only
+ * the per site trig left, giving the same values as
+ * spa_calculate() with elevation, pressure, temperature
+ * and atmos_refract the same.
+ */
+#ifndef CALC_SUN_SPA_GEO_H
+#define CALC_SUN_SPA_GEO_H
+
+#include <stddef.h>
+#include "spa.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  double jd;         /* Julian day, UT1 */
+  double jde;        /* Julian ephemeris day */
+  double nu;         /* apparent Greenwich sidereal time [degrees] */
+  double alpha;      /* geocentric right ascension [degrees] */
+  double delta;      /* geocentric declination [degrees] */
+  double r;          /* earth radius vector [AU] */
+  double del_psi;    /* nutation longitude [degrees] */
+  double epsilon;    /* true obliquity [degrees] */
+  double xi;         /* equatorial horizontal parallax [degrees] */
+} spa_geo;
+
+/*
+ * geocentric Sun at Julian day jd (UT1, as spa.c's
+ * julian_day() gives it) and delta_t seconds.
+ * returns 0, or 7 as spa_calculate() for delta_t out of range.
+ */
+int spa_geo_at(spa_geo *g, double jd, double delta_t);
+
+/* surroundings shared by the observers of one spa_observe() */
+typedef struct {
+  double pressure;      /* millibars, spa_data's default 1010 */
+  double temperature;   /* degrees Celsius */
+  double atmos_refract; /* degrees, 0.5667 typical */
+} spa_atmos;
+
+/*
+ * topocentric Sun for n observers at lat[i], lon[i] and
+ * elev[i] meters (NULL for sea level) into e0 (elevation
+ * without refraction), e (with) and azimuth (eastward from
+ * north), all degrees. Any output may be NULL.
+ */
+void spa_observe(const spa_geo *g, const spa_atmos *atm, size_t n,
+                 const double *lat, const double *lon, const double *elev,
+                 double *e0, double *e, double *azimuth);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,98 @@
+#include <string.h>
+#include "spa_rts.h"
+
+/* as in spa.c */
+#define SUN_RADIUS 0.26667
+enum {JD_MINUS, JD_ZERO, JD_PLUS, JD_COUNT};
+enum {SUN_TRANSIT, SUN_RISE, SUN_SET, SUN_COUNT};
+
+void
+spa_rts_init(spa_rts_window *w){
+  memset(w, 0, sizeof *w);
+}
+
+/* geocentric Sun at 0h UT jd, delta_t 0 like spa.c's RTS days */
+static void
+eval_day(spa_rts_window *w, int i, double jd){
+  spa_data sd;
+  sd.jd = jd;
+  sd.delta_t = 0.0;
+  calculate_geocentric_sun_right_ascension_and_declination(&sd);
+  w->alpha[i] = sd.alpha;
+  w->delta[i] = sd.delta;
+  w->del_psi[i] = sd.del_psi;
+  w->epsilon[i] = sd.epsilon;
+  w->evals++;
+}
+
+/* hold jd - 1, jd and jd + 1, reusing what the window has */
+static void
+slide_to(spa_rts_window *w, double jd){
+  int i;
+  if (w->filled == JD_COUNT && jd == w->jd)
+    return;
+  if (w->filled == JD_COUNT && jd == w->jd + 1.0){
+    for (i = 0; i < JD_PLUS; i++){
+      w->alpha[i] = w->alpha[i + 1];
+      w->delta[i] = w->delta[i + 1];
+      w->del_psi[i] = w->del_psi[i + 1];
+      w->epsilon[i] = w->epsilon[i + 1];
+    }
+    eval_day(w, JD_PLUS, jd + 1.0);
+  }
+  else{
+    for (i = 0; i < JD_COUNT; i++)
+      eval_day(w, i, jd - 1.0 + i);
+    w->filled = JD_COUNT;
+  }
+  w->jd = jd;
+}
+
+int
+spa_rts_day(spa_rts_window *w, spa_data *spa){
+  double m_rts[SUN_COUNT], nu_rts[SUN_COUNT], h_rts[SUN_COUNT];
+  double alpha_prime[SUN_COUNT], delta_prime[SUN_COUNT], h_prime[SUN_COUNT];
+  double h0_prime = -1 * (SUN_RADIUS + spa->atmos_refract);
+  double jd, nu, h0, n;
+  int i, rc = validate_inputs(spa);
+  if (rc) return rc;
+  jd = julian_day(spa->year, spa->month, spa->day, 0, 0, 0.0, 0.0, 0.0);
+  slide_to(w, jd);
+  nu = greenwich_sidereal_time(greenwich_mean_sidereal_time(jd, julian_century(jd)),
+                               w->del_psi[JD_ZERO], w->epsilon[JD_ZERO]);
+  /* the rest follows calculate_eot_and_sun_rise_transit_set() */
+  m_rts[SUN_TRANSIT] = approx_sun_transit_time(w->alpha[JD_ZERO], spa->longitude, nu);
+  h0 = sun_hour_angle_at_rise_set(spa->latitude, w->delta[JD_ZERO], h0_prime);
+  /* with no rise or set the Sun still transits, unlike spa_calculate() */
+  approx_sun_rise_and_set(m_rts, h0 < 0 ? 0.0 : h0);
+  for (i = 0; i < SUN_COUNT; i++){
+    nu_rts[i] = nu + 360.985647 * m_rts[i];
+    n = m_rts[i] + spa->delta_t / 86400.0;
+    alpha_prime[i] = rts_alpha_delta_prime(w->alpha, n);
+    delta_prime[i] = rts_alpha_delta_prime(w->delta, n);
+    h_prime[i] = limit_degrees180pm(nu_rts[i] + spa->longitude - alpha_prime[i]);
+    h_rts[i] = rts_sun_altitude(spa->latitude, delta_prime[i], h_prime[i]);
+  }
+  spa->sta = h_rts[SUN_TRANSIT];
+  spa->suntransit = dayfrac_to_local_hr(m_rts[SUN_TRANSIT] - h_prime[SUN_TRANSIT] / 360.0,
+                                        spa->timezone);
+  if (h0 < 0){
+    spa->srha = spa->ssha = spa->sunrise = spa->sunset = -99999;
+    return 0;
+  }
+  spa->srha = h_prime[SUN_RISE];
+  spa->ssha = h_prime[SUN_SET];
+  spa->sunrise = dayfrac_to_local_hr(sun_rise_and_set(m_rts, h_rts, delta_prime,
+                   spa->latitude, h_prime, h0_prime, SUN_RISE), spa->timezone);
+  spa->sunset = dayfrac_to_local_hr(sun_rise_and_set(m_rts, h_rts, delta_prime,
+                  spa->latitude, h_prime, h0_prime, SUN_SET), spa->timezone);
+  return 0;
+}
+
+int
+spa_rts_polar(const spa_rts_window *w, const spa_data *spa){
+  double h0_prime = -1 * (SUN_RADIUS + spa->atmos_refract);
+  if (sun_hour_angle_at_rise_set(spa->latitude, w->delta[JD_ZERO], h0_prime) >= 0)
+    return 0;
+  return rts_sun_altitude(spa->latitude, w->delta[JD_ZERO], 0.0) > h0_prime ? 1 : -1;
+}
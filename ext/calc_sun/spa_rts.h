@@ -0,0 +1,60 @@
+/*
+ * spa_rts.h
+ *
+ * NREL SPA sunrise, transit and sunset over runs of days.
+ * No Ruby dependency.
+ *
+ * spa_calculate() evaluates the geocentric Sun four times
+ * for every rise/transit/set: once at the instant for
+ * sidereal time and once each for 0h UT of the day before,
+ * the day and the day after. A spa_rts_window keeps the
+ * three days' right ascension, declination and nutation,
+ * so stepping to the next day costs one evaluation.
+ *
+ * Sidereal time takes its nutation from the 0h UT evaluation
+ * of the day instead of one delta_t later, which moves
+ * results by under 1e-7 hours against spa_calculate().
+ */
+#ifndef CALC_SUN_SPA_RTS_H
+#define CALC_SUN_SPA_RTS_H
+
+#include "spa.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  double jd;           /* 0h UT of the middle day */
+  int filled;          /* days held, 0 to 3 */
+  long evals;          /* geocentric evaluations so far */
+  double alpha[3], delta[3], del_psi[3], epsilon[3];
+} spa_rts_window;
+
+/* empty window */
+void spa_rts_init(spa_rts_window *w);
+
+/*
+ * rise, transit and set of the date in spa (year, month,
+ * day, timezone, longitude, latitude, atmos_refract and
+ * delta_t) into srha, ssha, sta, suntransit, sunrise and
+ * sunset. When the Sun does not rise or set srha, ssha,
+ * sunrise and sunset are -99999; sta and suntransit are
+ * still given, where spa_calculate() flags them too.
+ * returns 0 or the spa_calculate() error code.
+ */
+int spa_rts_day(spa_rts_window *w, spa_data *spa);
+
+/*
+ * for the date spa_rts_day() last took, 0 when the Sun
+ * rises and sets, else by its altitude at transit 1 when
+ * it stays above the altitude of rise and set and -1 when
+ * it stays below
+ */
+int spa_rts_polar(const spa_rts_window *w, const spa_data *spa);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
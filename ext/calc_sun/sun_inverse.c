@@ -0,0 +1,281 @@
+#include <math.h>
+#include "sun_inverse.h"
+#include "solar.h"
+
+/* the rates of the mean longitude and of sidereal time, degrees a day */
+#define INVERSE_ML1 0.9856473601037645
+#define INVERSE_SIDEREAL (360.0 * 1.00273790935)
+/* azimuths closer than this, degrees, are a hit */
+#define INVERSE_AZ_HIT 1e-3
+/* samples of the day scanned when the first guesses miss */
+#define INVERSE_SCAN 48
+
+typedef struct {
+  double lon;
+  double sl, cl;       /* sine and cosine of the latitude */
+  double hr;           /* rate of the hour angle, radians a day */
+  double dk;           /* rate of tan(dec), radians a day */
+  double target;       /* degrees */
+  double dec;          /* declination at the last evaluation, radians */
+  double tol;          /* days */
+  int mode;
+} inverse_ctx;
+
+/* altitude and azimuth at t, degrees, with their rates, degrees a day */
+typedef struct {
+  double alt, dalt, d2alt;
+  double az, daz;
+} inverse_sky;
+
+/*
+ * the rates at t. the true longitude runs at the mean
+ * motion times (1 + e cos v)^2 / (1 - e^2)^1.5; right
+ * ascension follows it through the obliquity, the hour
+ * angle at sidereal rate less that. the chain takes
+ * tan(dec) = sin(eps) sin(lambda), which runs at
+ * sin(eps) cos(lambda).
+ */
+static void
+rates(inverse_ctx *c, double t){
+  double lam = solar_true_longitude(t, c->mode);
+  double eps = solar_obliquity_of_ecliptic(t, c->mode);
+  double e = solar_eccentricity(t, c->mode);
+  double q = 1.0 + e * cos(solar_true_anomaly(t, c->mode));
+  double lr = INVERSE_ML1 * D2R * q * q / pow(1.0 - e * e, 1.5);
+  double cl = cos(lam), sl = sin(lam), ce = cos(eps);
+  c->hr = INVERSE_SIDEREAL * D2R - ce * lr / (cl * cl + ce * ce * sl * sl);
+  c->dk = sin(eps) * cl * lr;
+}
+
+/* the altitude and azimuth formulas of CalcSun#altitude, #azimuth, differentiated */
+static void
+sky(inverse_ctx *c, double t, inverse_sky *s){
+  double dec = solar_declination(t, c->mode) * D2R;
+  double ha = solar_lha(t, c->lon, c->mode) * D2R;
+  double sd = sin(dec), cd = cos(dec), sh = sin(ha), ch = cos(ha);
+  double dd = c->dk * cd * cd, hr = c->hr;
+  double z = c->sl * sd + c->cl * cd * ch;
+  double dz = (c->sl * cd - c->cl * sd * ch) * dd - c->cl * cd * sh * hr;
+  double d2z = -z * dd * dd + 2.0 * c->cl * sd * sh * hr * dd -
+    c->cl * cd * ch * hr * hr;
+  double ca, y = sh, x = ch * c->sl - sd / cd * c->cl;
+  double dy = ch * hr, dx = -sh * c->sl * hr - c->cl * dd / (cd * cd);
+  c->dec = dec;
+  if (z > 1.0) z = 1.0;
+  if (z < -1.0) z = -1.0;
+  ca = sqrt(1.0 - z * z);
+  s->alt = asin(z) * R2D;
+  if (ca > 0.0){
+    s->dalt = dz / ca * R2D;
+    s->d2alt = (d2z / ca + z * dz * dz / (ca * ca * ca)) * R2D;
+  }
+  else
+    s->dalt = s->d2alt = 0.0;
+  s->az = atan2(y, x) * R2D + 180.0;
+  s->daz = x * x + y * y > 0.0 ? (x * dy - y * dx) / (x * x + y * y) * R2D : 0.0;
+}
+
+typedef double (*inverse_fn)(inverse_ctx *c, double t, double *df);
+
+static double
+alt_fn(inverse_ctx *c, double t, double *df){
+  inverse_sky s;
+  sky(c, t, &s);
+  *df = s.dalt;
+  return s.alt - c->target;
+}
+
+/* degrees past the target azimuth, -180 to 180 */
+static double
+az_fn(inverse_ctx *c, double t, double *df){
+  inverse_sky s;
+  sky(c, t, &s);
+  *df = s.daz;
+  return remainder(s.az - c->target, 360.0);
+}
+
+/*
+ * the root of fn between lo, where it is negative, and hi,
+ * where it is not, by Newton from t, bisecting whenever a
+ * step would leave the bracket or fails to halve f
+ */
+static double
+newton(inverse_ctx *c, inverse_fn fn, double lo, double hi, double t){
+  double df, f, dx = fabs(hi - lo), dxold = dx;
+  int i;
+  if (!((t - lo) * (t - hi) < 0.0)) t = 0.5 * (lo + hi);
+  f = fn(c, t, &df);
+  for (i = 0; i < 64 && f != 0.0; i++){
+    dxold = dx;
+    if (((t - hi) * df - f) * ((t - lo) * df - f) > 0.0 ||
+        fabs(2.0 * f) > fabs(dxold * df)){
+      dx = 0.5 * (hi - lo);
+      t = lo + dx;
+    }
+    else{
+      dx = f / df;
+      t -= dx;
+    }
+    if (fabs(dx) < c->tol || fabs(hi - lo) < c->tol) break;
+    f = fn(c, t, &df);
+    if (f < 0.0)
+      lo = t;
+    else
+      hi = t;
+  }
+  return t;
+}
+
+/* the transit of the day of d, days from J2000, NaN for bad input */
+static double
+setup(inverse_ctx *c, double d, double lat, double lon, int mode){
+  double tr;
+  if (isnan(d) || isnan(lon) || !(fabs(lat) <= 90.0)) return NAN;
+  c->lon = lon;
+  c->sl = sin(lat * D2R);
+  c->cl = cos(lat * D2R);
+  c->mode = mode;
+  c->tol = mode == SOLAR_LEGACY ? SUN_INVERSE_LEGACY_TOL : SUN_INVERSE_TOL;
+  tr = solar_noon_jd(d, lat, lon, mode) - DJ00;
+  if (!isnan(tr)) rates(c, tr);
+  return tr;
+}
+
+/* Newton on the rate of altitude from the transit, kept in its day */
+static double
+peak(inverse_ctx *c, double tr){
+  inverse_sky s;
+  double t = tr, dx;
+  int i;
+  for (i = 0; i < 32; i++){
+    sky(c, t, &s);
+    if (!(s.d2alt < 0.0)) break;
+    dx = s.dalt / s.d2alt;
+    if (dx > 0.25) dx = 0.25;
+    if (dx < -0.25) dx = -0.25;
+    t -= dx;
+    if (t < tr - 0.5) t = tr - 0.5;
+    if (t > tr + 0.5) t = tr + 0.5;
+    if (fabs(dx) < c->tol) break;
+  }
+  return t;
+}
+
+double
+sun_max_altitude(double d, double lat, double lon, int mode, double *alt){
+  inverse_ctx c;
+  double t, tr = setup(&c, d, lat, lon, mode);
+  if (isnan(tr)){
+    *alt = NAN;
+    return NAN;
+  }
+  t = peak(&c, tr);
+  *alt = solar_altitude(t, lat, lon, mode);
+  return t;
+}
+
+double
+sun_altitude_time(double d, double lat, double lon, double alt, int rising,
+                  int mode){
+  inverse_ctx c;
+  double top, edge, ch, df, dec, t, tr = setup(&c, d, lat, lon, mode);
+  if (isnan(tr) || isnan(alt)) return NAN;
+  c.target = alt;
+  /* the transit, or the true peak minutes off it when that is close */
+  top = tr;
+  if (alt_fn(&c, top, &df) < 0.0){
+    top = peak(&c, tr);
+    if (alt_fn(&c, top, &df) < 0.0) return NAN;
+  }
+  dec = c.dec;
+  edge = rising ? top - 0.5 : top + 0.5;
+  if (alt_fn(&c, edge, &df) >= 0.0) return NAN;
+  /* first guess, the hour angle of alt at the declination of the peak */
+  ch = (sin(alt * D2R) - c.sl * sin(dec)) / (c.cl * cos(dec));
+  t = fabs(ch) <= 1.0 ? top + (rising ? -acos(ch) : acos(ch)) / c.hr :
+    0.5 * (top + edge);
+  return newton(&c, alt_fn, edge, top, t);
+}
+
+/* Newton on the azimuth from t, NaN unless it lands on it in [lo, hi] */
+static double
+polish(inverse_ctx *c, double t, double lo, double hi){
+  double f, df, dx;
+  int i;
+  for (i = 0; i < 16; i++){
+    f = az_fn(c, t, &df);
+    if (df == 0.0) return NAN;
+    dx = f / df;
+    if (fabs(dx) > 0.1) dx = dx > 0.0 ? 0.1 : -0.1;
+    t -= dx;
+    if (!(t >= lo && t <= hi)) return NAN;
+    if (fabs(dx) < c->tol) return fabs(f) < INVERSE_AZ_HIT ? t : NAN;
+  }
+  return NAN;
+}
+
+/* the earliest crossing of the azimuth among samples of [lo, hi] */
+static double
+scan(inverse_ctx *c, double lo, double hi){
+  double df, a = lo, fa = az_fn(c, lo, &df);
+  int i;
+  for (i = 1; i <= INVERSE_SCAN; i++){
+    double b = lo + (hi - lo) * i / INVERSE_SCAN, fb = az_fn(c, b, &df);
+    /* a change of sign, not the jump half way round */
+    if ((fa < 0.0) != (fb < 0.0) && fabs(fa - fb) < 180.0)
+      return fa < 0.0 ? newton(c, az_fn, a, b, 0.5 * (a + b)) :
+        newton(c, az_fn, b, a, 0.5 * (a + b));
+    a = b;
+    fa = fb;
+  }
+  return NAN;
+}
+
+double
+sun_azimuth_time(double d, double lat, double lon, double az, int mode){
+  inverse_ctx c;
+  double p, q, r, r0, a, psi, base, m, best = NAN;
+  double tr = setup(&c, d, lat, lon, mode);
+  int k, missed = 0;
+  if (isnan(tr) || isnan(az)) return NAN;
+  c.target = az;
+  c.dec = solar_declination(tr, mode) * D2R;
+  /*
+   * first guesses: with the declination of transit held,
+   * azimuth az - 180 from the south, a, is met where
+   * cos(a) sin(H) - sin(a) sin(lat) cos(H) =
+   * -sin(a) tan(dec) cos(lat), twice a day at most, or
+   * else at az + 180, which is dropped
+   */
+  a = (az - 180.0) * D2R;
+  p = cos(a);
+  q = -sin(a) * c.sl;
+  r = -sin(a) * tan(c.dec) * c.cl;
+  r0 = hypot(p, q);
+  if (r0 > 0.0 && fabs(r) <= r0){
+    psi = atan2(q, p);
+    base = asin(r / r0);
+    for (k = 0; k < 2; k++){
+      double h = remainder((k ? PI - base : base) - psi, PI2), t;
+      t = atan2(sin(h), cos(h) * c.sl - tan(c.dec) * c.cl) * R2D + 180.0;
+      if (fabs(remainder(t - az, 360.0)) > 90.0) continue;
+      t = polish(&c, tr + h / c.hr, tr - 0.5, tr + 0.5);
+      if (isnan(t))
+        missed = 1;
+      else if (isnan(best) || t < best)
+        best = t;
+    }
+  }
+  /*
+   * tan(dec) moves by up to 0.5 dk in half a day, enough to
+   * bring a guess that was not there, near a tangency or a
+   * pass overhead; look for it then, or when Newton missed
+   */
+  m = 0.5 * fabs(c.dk) * c.cl;
+  if (missed || fabs(fabs(r) - r0) <= m ||
+      fabs(tan(c.dec) * c.cl - c.sl) <= m){
+    double t = scan(&c, tr - 0.5, tr + 0.5);
+    if (isnan(best) || t < best) best = t;
+  }
+  return best;
+}
@@ -0,0 +1,64 @@
+/*
+ * sun_inverse.h
+ *
+ * Inverse queries on the CalcSun chain: the time the Sun
+ * reaches an azimuth, the time it crosses an altitude
+ * rising or setting, and the time and value of its highest
+ * altitude. No Ruby dependency.
+ *
+ * Each is a Newton iteration on the altitude and azimuth
+ * formulas of CalcSun#altitude and #azimuth, fed the
+ * chain's declination and local hour angle, with the time
+ * derivatives taken analytically: the hour angle moves at
+ * the sidereal rate less that of the right ascension, and
+ * both right ascension and declination follow the true
+ * longitude, whose rate comes from the eccentricity and
+ * true anomaly. Steps that leave the bracket of a root are
+ * replaced by bisection. An answer takes two to six
+ * evaluations of declination and hour angle where bisection
+ * takes thirty or more; an azimuth the first guesses miss,
+ * near a pass overhead, falls back to a scan of the day.
+ *
+ * The day of d is the solar day centred on the chain's
+ * transit noon_jd(d), half a day either way. Times are
+ * days from J2000, NaN when the Sun does not get there
+ * that day. Altitudes are geometric, no refraction.
+ */
+#ifndef CALC_SUN_SUN_INVERSE_H
+#define CALC_SUN_SUN_INVERSE_H
+
+/*
+ * times are refined to this many days, about 0.1 ms, or
+ * in SOLAR_LEGACY mode, whose single precision hops leave
+ * steps of some 3e-8 days, to about 9 ms
+ */
+#define SUN_INVERSE_TOL 1e-9
+#define SUN_INVERSE_LEGACY_TOL 1e-7
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * when in the day of d the Sun at lat, lon stands at
+ * azimuth az (degrees east of north); the earliest when it
+ * passes az twice, as it can in the tropics
+ */
+double sun_azimuth_time(double d, double lat, double lon, double az,
+                        int mode);
+/*
+ * when in the day of d the Sun crosses altitude alt
+ * (degrees) before its highest point (rising set) or
+ * after it
+ */
+double sun_altitude_time(double d, double lat, double lon, double alt,
+                         int rising, int mode);
+/* when in the day of d the Sun is highest, and *alt that altitude */
+double sun_max_altitude(double d, double lat, double lon, int mode,
+                        double *alt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,169 @@
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include "sun_window.h"
+#include "solar.h"
+
+typedef struct {
+  const sun_window *w;
+  double lat, lon;
+  double width;        /* of the azimuth window, 360 for any */
+} window_ctx;
+
+/* degrees az lies inside the window, negative outside */
+static double
+az_margin(const window_ctx *c, double az){
+  double o = fmod(az - c->w->az_from, 360.0);
+  if (o < 0.0) o += 360.0;
+  if (o <= c->width) return fmin(o, c->width - o);
+  return -fmin(o - c->width, 360.0 - o);
+}
+
+/* at or above zero inside the window, continuous in t */
+static double
+inside(const window_ctx *c, double t){
+  double g = solar_altitude(t, c->lat, c->lon, c->w->mode) - c->w->altitude;
+  if (c->width < 360.0){
+    double m = az_margin(c, solar_azimuth(t, c->lat, c->lon, c->w->mode));
+    if (m < g) g = m;
+  }
+  return g;
+}
+
+/* the change of state in [a, b], Illinois, bisecting once it stalls */
+static double
+crossing(const window_ctx *c, double a, double ga, double b, double gb){
+  int i, side = 0;
+  for (i = 0; i < 64 && b - a > SUN_WINDOW_TOL; i++){
+    double t = (a * gb - b * ga) / (gb - ga), gt;
+    if (i >= 12 || !(t > a && t < b)) t = 0.5 * (a + b);
+    gt = inside(c, t);
+    if ((gt >= 0.0) == (ga >= 0.0)){
+      a = t;
+      ga = gt;
+      if (side < 0) gb *= 0.5;
+      side = -1;
+    }
+    else{
+      b = t;
+      gb = gt;
+      if (side > 0) ga *= 0.5;
+      side = 1;
+    }
+  }
+  return 0.5 * (a + b);
+}
+
+/* appends start, end, merged into a pair of this site, those past base */
+static int
+push(double **spans, size_t *n, size_t *cap, size_t base, double start,
+     double end){
+  if (!(end > start)) return 0;
+  if (*n > base && (*spans)[2 * *n - 1] >= start){
+    (*spans)[2 * *n - 1] = end;
+    return 0;
+  }
+  if (*n == *cap){
+    size_t m = *cap ? 2 * *cap : 16;
+    double *p = realloc(*spans, 2 * m * sizeof *p);
+    if (!p){
+      errno = ENOMEM;
+      return -1;
+    }
+    *spans = p;
+    *cap = m;
+  }
+  (*spans)[2 * *n] = start;
+  (*spans)[2 * *n + 1] = end;
+  (*n)++;
+  return 0;
+}
+
+/* transits and the midnights half a day on, in turn */
+typedef struct {
+  const window_ctx *c;
+  long k;
+  int half;
+  double t;
+  double last;         /* the transit before t */
+  double ahead;        /* a transit read but not yet reached, or NaN */
+} extremes;
+
+static void
+next_extreme(extremes *x){
+  double tr;
+  if (x->half){
+    x->t += 0.5;
+    x->half = 0;
+    return;
+  }
+  if (isnan(x->ahead)){
+    x->k++;
+    tr = solar_noon_jd((double)x->k, x->c->lat, x->c->lon, x->c->w->mode) - DJ00;
+  }
+  else
+    tr = x->ahead;
+  x->ahead = NAN;
+  /*
+   * near 180 degrees of longitude the transit falls on the
+   * edge of the chain's day, and two days can give the same
+   * one while the next skips a day; that skipped transit
+   * lies half way between its neighbours
+   */
+  if (tr - x->last > 1.5){
+    x->ahead = tr;
+    tr = 0.5 * (x->last + tr);
+  }
+  x->t = x->last = tr;
+  x->half = 1;
+}
+
+int
+sun_window_spans(const sun_window *w, double d0, double d1, double lat,
+                 double lon, double **spans, size_t *n, size_t *cap){
+  window_ctx c;
+  extremes x;
+  double t = d0, g, start = d0, width = w->az_to - w->az_from;
+  size_t base = *n;
+  long i = 1;
+  int in;
+  if (!(w->step > 0.0) || !(d1 >= d0) || !(d1 - d0 < 1e7) || isnan(lat) ||
+      isnan(lon) || isnan(w->altitude) || isnan(width)){
+    errno = EINVAL;
+    return -1;
+  }
+  c.w = w;
+  c.lat = lat;
+  c.lon = lon;
+  if (fabs(width) >= 360.0)
+    c.width = 360.0;
+  else
+    c.width = width < 0.0 ? width + 360.0 : width;
+  x.c = &c;
+  x.k = (long)floor(d0) - 2;
+  x.half = 0;
+  x.last = x.ahead = NAN;
+  do next_extreme(&x); while (x.t <= d0);
+  g = inside(&c, t);
+  in = g >= 0.0;
+  while (t < d1){
+    double grid = d0 + (double)i * w->step, nt, gn;
+    if (grid > d1) grid = d1;
+    /* a transit repeated falls before the midnight passed */
+    while (x.t <= t) next_extreme(&x);
+    nt = x.t < grid ? x.t : grid;
+    if (x.t <= nt) next_extreme(&x);
+    if (grid <= nt) i++;
+    gn = inside(&c, nt);
+    if ((gn >= 0.0) != in){
+      double cx = crossing(&c, t, g, nt, gn);
+      if (in && push(spans, n, cap, base, start, cx) != 0) return -1;
+      start = cx;
+      in = !in;
+    }
+    t = nt;
+    g = gn;
+  }
+  if (in && push(spans, n, cap, base, start, d1) != 0) return -1;
+  return 0;
+}
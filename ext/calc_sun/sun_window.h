@@ -0,0 +1,60 @@
+/*
+ * sun_window.h
+ *
+ * The spans of time the Sun of the CalcSun chain stays at
+ * or above an altitude and, optionally, inside a window of
+ * azimuths, at a site over a range of time. No Ruby
+ * dependency.
+ *
+ * The solver samples every step days, plus every transit
+ * and the midnight half a day from it, where altitude peaks
+ * and bottoms, so a span that holds either is never missed.
+ * Each change of state between two samples is refined on
+ * the continuous function min(altitude - lowest, degrees
+ * inside the azimuth window) by the Illinois variant of
+ * regula falsi, to SUN_WINDOW_TOL days. Altitudes are
+ * geometric, no refraction, as CalcSun#altitude gives
+ * them. A span shorter than step that holds neither a
+ * transit nor a midnight, such as a pass through a window
+ * of a few degrees of azimuth, can be missed.
+ */
+#ifndef CALC_SUN_SUN_WINDOW_H
+#define CALC_SUN_SUN_WINDOW_H
+
+#include <stddef.h>
+
+/* crossings are refined to this many days, about 9 ms */
+#define SUN_WINDOW_TOL 1e-7
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  double altitude;     /* lowest altitude, degrees */
+  /*
+   * azimuths east of north, degrees, clockwise from az_from
+   * to az_to, wrapping through north when az_from > az_to;
+   * a window of 360 or more takes every azimuth
+   */
+  double az_from, az_to;
+  double step;         /* sampling step, days */
+  int mode;            /* precision, as in solar.h */
+} sun_window;
+
+/*
+ * the spans of [d0, d1] (days from J2000) when the Sun at
+ * lat, lon is inside w, as start and end pairs appended to
+ * *spans, which holds *n pairs in room for *cap and is
+ * grown with realloc. spans that touch are merged; the
+ * first and last are cut at d0 and d1.
+ * returns 0, or -1 with errno set (EINVAL, ENOMEM).
+ */
+int sun_window_spans(const sun_window *w, double d0, double d1, double lat,
+                     double lon, double **spans, size_t *n, size_t *cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,153 @@
+/*
+ * Ported from SUNRISET.C, (c) Paul Schlyter, 1989, 1992,
+ * released to the public domain by Paul Schlyter, December 1992.
+ * http://stjarnhimlen.se/comp/sunriset.c
+ */
+#include <math.h>
+#include "sunriset.h"
+
+#define SR_PI     3.1415926535897932384
+#define RADEG     (180.0 / SR_PI)
+#define DEGRAD    (SR_PI / 180.0)
+#define INV360    (1.0 / 360.0)
+#define SR_DJ00   2451545.0
+/* days from J2000 to days from 2000 Jan 0.0 of the original */
+#define JAN0(d)   ((d) + 1.5)
+
+#define sind(x)     sin((x) * DEGRAD)
+#define cosd(x)     cos((x) * DEGRAD)
+#define acosd(x)    (RADEG * acos(x))
+#define atan2d(y,x) (RADEG * atan2(y, x))
+
+/* angle reduced to 0..360 degrees */
+static inline double
+revolution(double x){
+  return x - 360.0 * floor(x * INV360);
+}
+
+/* angle reduced to -180..180 degrees */
+static inline double
+rev180(double x){
+  return x - 360.0 * floor(x * INV360 + 0.5);
+}
+
+void
+sunriset_sunpos(double d, double *lon, double *r){
+  double m, w, e, ea, x, y, v;
+  /* mean anomaly, longitude of perihelion and eccentricity */
+  d = JAN0(d);
+  m = revolution(356.0470 + 0.9856002585 * d);
+  w = 282.9404 + 4.70935E-5 * d;
+  e = 0.016709 - 1.151E-9 * d;
+  /* one step of Kepler's equation, true anomaly and radius */
+  ea = m + e * RADEG * sind(m) * (1.0 + e * cosd(m));
+  x = cosd(ea) - e;
+  y = sqrt(1.0 - e * e) * sind(ea);
+  *r = sqrt(x * x + y * y);
+  v = atan2d(y, x);
+  *lon = revolution(v + w);
+}
+
+void
+sunriset_ra_dec(double d, double *ra, double *dec, double *r){
+  double lon, obl_ecl, x, y, z;
+  sunriset_sunpos(d, &lon, r);
+  /* ecliptic rectangular coordinates, z = 0 */
+  x = *r * cosd(lon);
+  y = *r * sind(lon);
+  obl_ecl = 23.4393 - 3.563E-7 * JAN0(d);
+  /* to equatorial, x is unchanged */
+  z = y * sind(obl_ecl);
+  y = y * cosd(obl_ecl);
+  *ra = atan2d(y, x);
+  *dec = atan2d(z, sqrt(x * x + y * y));
+}
+
+double
+sunriset_gmst0(double d){
+  /* the Sun's mean longitude, M + w of sunpos(), plus 180 */
+  return revolution((180.0 + 356.0470 + 282.9404) +
+                    (0.9856002585 + 4.70935E-5) * JAN0(d));
+}
+
+int
+sunriset_rise_set(double d, double lat, double lon, double altit,
+                  int upper_limb, double *rise, double *set){
+  double sidtime, sra, sdec, sr, tsouth, t, cost;
+  int rc = 0;
+  /* d of 12h local mean solar time of the day */
+  d = floor(d) - lon / 360.0;
+  sidtime = revolution(sunriset_gmst0(d) + 180.0 + lon);
+  sunriset_ra_dec(d, &sra, &sdec, &sr);
+  tsouth = 12.0 - rev180(sidtime - sra) / 15.0;
+  /* the Sun's apparent radius */
+  if (upper_limb) altit -= 0.2666 / sr;
+  cost = (sind(altit) - sind(lat) * sind(sdec)) / (cosd(lat) * cosd(sdec));
+  if (cost >= 1.0)
+    rc = -1, t = 0.0;
+  else if (cost <= -1.0)
+    rc = +1, t = 12.0;
+  else
+    t = acosd(cost) / 15.0;
+  *rise = tsouth - t;
+  *set = tsouth + t;
+  return rc;
+}
+
+double
+sunriset_daylen(double d, double lat, double lon, double altit,
+                int upper_limb){
+  double obl_ecl, sr, slon, sin_sdecl, cos_sdecl, cost;
+  d = floor(d) - lon / 360.0;
+  obl_ecl = 23.4393 - 3.563E-7 * JAN0(d);
+  sunriset_sunpos(d, &slon, &sr);
+  sin_sdecl = sind(obl_ecl) * sind(slon);
+  cos_sdecl = sqrt(1.0 - sin_sdecl * sin_sdecl);
+  if (upper_limb) altit -= 0.2666 / sr;
+  cost = (sind(altit) - sind(lat) * sin_sdecl) / (cosd(lat) * cos_sdecl);
+  if (cost >= 1.0) return 0.0;
+  if (cost <= -1.0) return 24.0;
+  return (2.0 / 15.0) * acosd(cost);
+}
+
+void
+sunriset_alt_az(double d, double lat, double lon, double *alt, double *az){
+  double sra, sdec, sr, ut, h, sh, ch, sl, cl, sd, cd;
+  sunriset_ra_dec(d, &sra, &sdec, &sr);
+  /* GMST = GMST0 + UT, d counts from noon */
+  ut = (d + 0.5 - floor(d + 0.5)) * 360.0;
+  h = (sunriset_gmst0(d) + ut + lon - sra) * DEGRAD;
+  sh = sin(h);
+  ch = cos(h);
+  sl = sind(lat);
+  cl = cosd(lat);
+  sd = sind(sdec);
+  cd = cosd(sdec);
+  *alt = RADEG * asin(sl * sd + cl * cd * ch);
+  *az = atan2d(cd * sh, cd * ch * sl - sd * cl) + 180.0;
+}
+
+void
+sunriset_rise_set_n(size_t n, const double *d, const double *lat,
+                    const double *lon, double altit, int upper_limb,
+                    double *rise, double *transit, double *set,
+                    double *daylen){
+  size_t i;
+  for (i = 0; i < n; i++){
+    double start = floor(d[i]) + SR_DJ00 - 0.5;
+    double r, s;
+    int rc = sunriset_rise_set(d[i], lat[i], lon[i], altit, upper_limb, &r, &s);
+    if (transit) transit[i] = start + (r + s) / 48.0;
+    if (rise) rise[i] = rc ? NAN : start + r / 24.0;
+    if (set) set[i] = rc ? NAN : start + s / 24.0;
+    if (daylen) daylen[i] = sunriset_daylen(d[i], lat[i], lon[i], altit, upper_limb);
+  }
+}
+
+void
+sunriset_alt_az_n(size_t n, const double *d, const double *lat,
+                  const double *lon, double *alt, double *az){
+  size_t i;
+  for (i = 0; i < n; i++)
+    sunriset_alt_az(d[i], lat[i], lon[i], alt + i, az + i);
+}
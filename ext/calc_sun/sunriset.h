@@ -0,0 +1,73 @@
+/*
+ * sunriset.h
+ *
+ * Paul Schlyter's SUNRISET.C (public domain, 1989, 1992) as
+ * a third engine beside the CalcSun chain and NREL SPA. No
+ * Ruby dependency. A cheap, low precision algorithm: one
+ * Kepler step for the Sun's position and rise and set from
+ * the position at local noon, good to a few minutes.
+ *
+ * Every function takes d, the days from J2000
+ * (ajd - 2451545.0), as the chain does, and counts from
+ * 2000 Jan 0.0 inside as the original. The mean anomaly
+ * is the original linear one, not the polynomial tried in
+ * example/sunriset.c, whose terms run off by degrees a
+ * century from J2000.
+ *
+ * altit is the altitude in degrees the Sun crosses:
+ * SUNRISET_RISE_SET with upper_limb set for rise and set,
+ * the twilight altitudes with upper_limb clear.
+ */
+#ifndef CALC_SUN_SUNRISET_H
+#define CALC_SUN_SUNRISET_H
+
+#include <stddef.h>
+
+#define SUNRISET_RISE_SET    (-35.0 / 60.0)
+#define SUNRISET_CIVIL       (-6.0)
+#define SUNRISET_NAUTICAL    (-12.0)
+#define SUNRISET_ASTRONOMICAL (-18.0)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ecliptic longitude in degrees and distance in AU */
+void sunriset_sunpos(double d, double *lon, double *r);
+/* right ascension and declination in degrees, distance in AU */
+void sunriset_ra_dec(double d, double *ra, double *dec, double *r);
+/* GMST0 in degrees, Schlyter's generalized GMST - UT */
+double sunriset_gmst0(double d);
+
+/*
+ * rise and set of the day of d in hours UT from its 0h,
+ * computed at local mean noon. returns 0 when the Sun
+ * crosses altit, +1 when it stays above and -1 below;
+ * then rise and set are transit -/+ 12 and transit.
+ */
+int sunriset_rise_set(double d, double lat, double lon, double altit,
+                      int upper_limb, double *rise, double *set);
+/* hours from rise to set of the day of d, 0 to 24 */
+double sunriset_daylen(double d, double lat, double lon, double altit,
+                       int upper_limb);
+/* geocentric altitude and azimuth in degrees at instant d */
+void sunriset_alt_az(double d, double lat, double lon,
+                     double *alt, double *az);
+
+/*
+ * batch forms for n samples. rise, transit and set as ajds
+ * of the day of each d, rise and set NaN when the Sun does
+ * not cross altit; daylen in hours. Any output may be NULL.
+ */
+void sunriset_rise_set_n(size_t n, const double *d, const double *lat,
+                         const double *lon, double altit, int upper_limb,
+                         double *rise, double *transit, double *set,
+                         double *daylen);
+void sunriset_alt_az_n(size_t n, const double *d, const double *lat,
+                       const double *lon, double *alt, double *az);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
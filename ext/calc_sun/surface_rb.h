@@ -0,0 +1,150 @@
+/*
+ * surface_rb.h
+ *
+ * Ruby glue for CalcSun::RiseSurface.
+ * Included by calc_sun.c after prec_mode() and fill_f64().
+ */
+#ifndef CALC_SUN_SURFACE_RB_H
+#define CALC_SUN_SURFACE_RB_H
+
+#include <errno.h>
+#include "rise_surface.h"
+
+static void
+surface_free(void *p){
+  rise_surface_free((rise_surface *)p);
+}
+
+static size_t
+surface_memsize(const void *p){
+  return p ? rise_surface_size((const rise_surface *)p) : 0;
+}
+
+static const rb_data_type_t surface_type = {
+  "CalcSun::RiseSurface",
+  {0, surface_free, surface_memsize,},
+  0, 0,
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+  RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_FROZEN_SHAREABLE,
+#else
+  RUBY_TYPED_FREE_IMMEDIATELY,
+#endif
+};
+
+static VALUE
+surface_alloc(VALUE klass){
+  return TypedData_Wrap_Struct(klass, &surface_type, 0);
+}
+
+static const rise_surface *
+get_surface(VALUE vsurf){
+  rise_surface *s = rb_check_typeddata(vsurf, &surface_type);
+  if (!s) rb_raise(rb_eArgError, "uninitialized CalcSun::RiseSurface");
+  return s;
+}
+/*
+ * call-seq:
+ *  CalcSun::RiseSurface.new(jd, days, lat_step = 0.1,
+ *                           tolerance = 1.0, precision = :raw)
+ *
+ * precomputes rise, transit and set of the CalcSun chain
+ * for days Julian Day Numbers from jd on, at latitudes
+ * every lat_step degrees. Grid cells whose interpolation
+ * misses the chain by more than tolerance seconds, along
+ * the polar day and night edges, are computed directly.
+ * the surface is frozen and can be shared between Ractors
+ * without a copy.
+ *
+ */
+static VALUE surface_init(int argc, VALUE *argv, VALUE self){
+  VALUE vjd, vdays, vstep, vtol, vprec;
+  long days;
+  rise_surface *s;
+  if (DATA_PTR(self)) rb_raise(rb_eTypeError, "already initialized surface");
+  rb_scan_args(argc, argv, "23", &vjd, &vdays, &vstep, &vtol, &vprec);
+  days = NUM2LONG(vdays);
+  if (days <= 0) rb_raise(rb_eArgError, "days must be positive");
+  s = rise_surface_build(NUM2LONG(vjd), (size_t)days,
+                         NIL_P(vstep) ? 0.1 : NUM2DBL(vstep),
+                         (NIL_P(vtol) ? 1.0 : NUM2DBL(vtol)) / 3600.0,
+                         NIL_P(vprec) ? SOLAR_RAW : prec_mode(vprec));
+  if (!s){
+    if (errno == EINVAL)
+      rb_raise(rb_eArgError, "lat_step must be in (0, 90], tolerance positive");
+    rb_memerror();
+  }
+  DATA_PTR(self) = s;
+  return rb_obj_freeze(self);
+}
+/*
+ * call-seq:
+ *  rise_set(jds, lats, lons)
+ *
+ * given an Array of Julian Day Numbers and local Latitudes
+ * and Longitudes, each an Array as long as jds or one
+ * Numeric, returns [rises, transits, sets] as Astronomical
+ * Julian Day Numbers, nil where the Sun does not rise or
+ * set, within max_error of the chain.
+ *
+ */
+static VALUE surface_rise_set(VALUE self, VALUE vjds, VALUE vlats, VALUE vlons){
+  const rise_surface *s = get_surface(self);
+  long i, n;
+  long *jdn;
+  double *buf;
+  VALUE vtmp, vr, vt, vs;
+  Check_Type(vjds, T_ARRAY);
+  n = RARRAY_LEN(vjds);
+  buf = ALLOCV(vtmp, n * (5 * sizeof(double) + sizeof(long)) + 1);
+  jdn = (long *)(buf + 5 * n);
+  fill_f64(buf, vlats, n, "jds and lats");
+  fill_f64(buf + n, vlons, n, "jds and lons");
+  for (i = 0; i < n; i++)
+    jdn[i] = NUM2LONG(rb_ary_entry(vjds, i));
+  rise_surface_eval(s, (size_t)n, jdn, buf, buf + n,
+                    buf + 2 * n, buf + 3 * n, buf + 4 * n);
+  vr = rb_ary_new2(n);
+  vt = rb_ary_new2(n);
+  vs = rb_ary_new2(n);
+  for (i = 0; i < n; i++){
+    double r = buf[2 * n + i], st = buf[4 * n + i];
+    rb_ary_push(vr, isnan(r) ? Qnil : DBL2NUM(r));
+    rb_ary_push(vt, DBL2NUM(buf[3 * n + i]));
+    rb_ary_push(vs, isnan(st) ? Qnil : DBL2NUM(st));
+  }
+  ALLOCV_END(vtmp);
+  return rb_ary_new3(3, vr, vt, vs);
+}
+/*
+ * call-seq:
+ *  max_error
+ *
+ * the largest difference from the chain, in seconds,
+ * of the interpolated cells, measured at their midpoints.
+ *
+ */
+static VALUE surface_max_error(VALUE self){
+  return DBL2NUM(rise_surface_max_error(get_surface(self)) * 3600.0);
+}
+/*
+ * call-seq:
+ *  flagged
+ *
+ * the number of grid cells computed with the chain.
+ *
+ */
+static VALUE surface_flagged(VALUE self){
+  return SIZET2NUM(rise_surface_flagged(get_surface(self)));
+}
+
+static void
+init_surface(VALUE cCalcSun){
+  VALUE cSurface = rb_define_class_under(cCalcSun, "RiseSurface", rb_cObject);
+  rb_define_alloc_func(cSurface, surface_alloc);
+  rb_define_method(cSurface, "initialize", surface_init, -1);
+  rb_define_method(cSurface, "flagged", surface_flagged, 0);
+  rb_define_method(cSurface, "max_error", surface_max_error, 0);
+  rb_define_method(cSurface, "rise_set", surface_rise_set, 3);
+}
+
+#endif
@@ -0,0 +1,399 @@
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ajd_parse.h"
+#include "tzif.h"
+
+#define TZIF_DIR "/usr/share/zoneinfo"
+/* JDN of 1970-01-01 and the ajd of its midnight */
+#define UNIX_JDN 2440588L
+#define UNIX_AJD 2440587.5
+
+typedef struct {
+  long utoff;
+  int isdst;
+  int abbr;        /* index into chars */
+} tz_type;
+
+/* footer rule date: kind 'J', 'D' (zero based day) or 'M' */
+typedef struct {
+  char kind;
+  int m, w, d;     /* month, week, weekday, or day in d */
+  long secs;       /* local time of day of the change */
+} tz_date;
+
+typedef struct {
+  int present, has_dst;
+  long std_off, dst_off;
+  char std_abbr[16], dst_abbr[16];
+  tz_date start, end;
+} tz_rule;
+
+struct tzif_zone {
+  size_t ntrans, ntypes;
+  long long *trans;
+  unsigned char *idx;
+  tz_type *types;
+  char *chars;
+  tz_rule rule;
+};
+
+static long long
+be(const unsigned char *p, int n){
+  unsigned long long v = 0;
+  int i;
+  for (i = 0; i < n; i++)
+    v = (v << 8) | p[i];
+  /* sign extend */
+  if (n < 8 && (v >> (8 * n - 1)) & 1)
+    v |= ~0ULL << (8 * n);
+  return (long long)v;
+}
+
+/* [+-]hh[:mm[:ss]], returns seconds, p advanced */
+static int
+parse_hms(const char **pp, long *secs){
+  const char *p = *pp;
+  long sign = 1, h = 0, m = 0, s = 0;
+  if (*p == '+' || *p == '-') sign = *p++ == '-' ? -1 : 1;
+  if (*p < '0' || *p > '9') return 0;
+  while (*p >= '0' && *p <= '9') h = h * 10 + (*p++ - '0');
+  if (*p == ':'){
+    p++;
+    while (*p >= '0' && *p <= '9') m = m * 10 + (*p++ - '0');
+    if (*p == ':'){
+      p++;
+      while (*p >= '0' && *p <= '9') s = s * 10 + (*p++ - '0');
+    }
+  }
+  *secs = sign * (h * 3600 + m * 60 + s);
+  *pp = p;
+  return 1;
+}
+
+static int
+parse_abbr(const char **pp, char *out){
+  const char *p = *pp;
+  size_t n = 0;
+  if (*p == '<'){
+    p++;
+    while (*p && *p != '>' && n < 15) out[n++] = *p++;
+    if (*p++ != '>') return 0;
+  }
+  else{
+    while (((*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z')) && n < 15)
+      out[n++] = *p++;
+  }
+  out[n] = '\0';
+  *pp = p;
+  return n >= 3;
+}
+
+static int
+parse_date(const char **pp, tz_date *dt){
+  const char *p = *pp;
+  long n = 0;
+  if (*p == 'M'){
+    dt->kind = 'M';
+    p++;
+    dt->m = (int)strtol(p, (char **)&p, 10);
+    if (*p++ != '.') return 0;
+    dt->w = (int)strtol(p, (char **)&p, 10);
+    if (*p++ != '.') return 0;
+    dt->d = (int)strtol(p, (char **)&p, 10);
+    if (dt->m < 1 || dt->m > 12 || dt->w < 1 || dt->w > 5 ||
+        dt->d < 0 || dt->d > 6) return 0;
+  }
+  else{
+    dt->kind = 'D';
+    if (*p == 'J'){
+      dt->kind = 'J';
+      p++;
+    }
+    if (*p < '0' || *p > '9') return 0;
+    while (*p >= '0' && *p <= '9') n = n * 10 + (*p++ - '0');
+    dt->d = (int)n;
+  }
+  dt->secs = 7200;
+  if (*p == '/'){
+    p++;
+    if (!parse_hms(&p, &dt->secs)) return 0;
+  }
+  *pp = p;
+  return 1;
+}
+
+/* POSIX TZ string of the footer, offsets west positive there */
+static int
+parse_rule(const char *p, tz_rule *r){
+  long off;
+  memset(r, 0, sizeof *r);
+  if (!*p) return 1;
+  if (!parse_abbr(&p, r->std_abbr) || !parse_hms(&p, &off)) return 0;
+  r->present = 1;
+  r->std_off = -off;
+  if (!*p) return 1;
+  if (!parse_abbr(&p, r->dst_abbr)) return 0;
+  r->has_dst = 1;
+  r->dst_off = r->std_off + 3600;
+  if (*p && *p != ','){
+    if (!parse_hms(&p, &off)) return 0;
+    r->dst_off = -off;
+  }
+  /* without rules POSIX leaves them implementation defined, use US */
+  r->start.kind = r->end.kind = 'M';
+  r->start.m = 3;
+  r->start.w = 2;
+  r->end.m = 11;
+  r->end.w = 1;
+  r->start.d = r->end.d = 0;
+  r->start.secs = r->end.secs = 7200;
+  if (*p == ','){
+    p++;
+    if (!parse_date(&p, &r->start) || *p++ != ',' ||
+        !parse_date(&p, &r->end)) return 0;
+  }
+  return *p == '\0';
+}
+
+/* JDN of a rule date in year */
+static long
+rule_jdn(const tz_date *dt, long year){
+  long jan1 = ajd_civil_to_jdn(year, 1, 1);
+  int leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+  long first, last, day;
+  switch (dt->kind){
+  case 'J':
+    return jan1 + dt->d - 1 + (leap && dt->d >= 60);
+  case 'D':
+    return jan1 + dt->d;
+  default:
+    first = ajd_civil_to_jdn(year, dt->m, 1);
+    last = (dt->m == 12 ? ajd_civil_to_jdn(year + 1, 1, 1) :
+            ajd_civil_to_jdn(year, dt->m + 1, 1)) - 1;
+    /* (jdn + 1) % 7 is the weekday, 0 for Sunday */
+    day = first + ((dt->d - (first + 1) % 7) + 7) % 7 + 7 * (dt->w - 1);
+    while (day > last) day -= 7;
+    return day;
+  }
+}
+
+static long long
+rule_utc(const tz_date *dt, long year, long utoff){
+  return (long long)(rule_jdn(dt, year) - UNIX_JDN) * 86400 + dt->secs - utoff;
+}
+
+static long
+rule_utoff(const tz_rule *r, long long t, int *isdst, const char **abbr){
+  long jdn, y;
+  int m, d, in_dst;
+  long long s, e;
+  if (!r->has_dst){
+    if (isdst) *isdst = 0;
+    if (abbr) *abbr = r->std_abbr;
+    return r->std_off;
+  }
+  jdn = UNIX_JDN + (long)(t >= 0 ? t / 86400 : -((-t + 86399) / 86400));
+  ajd_jdn_to_civil(jdn, &y, &m, &d);
+  /* start is given in standard time, end in daylight time */
+  s = rule_utc(&r->start, y, r->std_off);
+  e = rule_utc(&r->end, y, r->dst_off);
+  in_dst = s < e ? (t >= s && t < e) : (t >= s || t < e);
+  if (isdst) *isdst = in_dst;
+  if (abbr) *abbr = in_dst ? r->dst_abbr : r->std_abbr;
+  return in_dst ? r->dst_off : r->std_off;
+}
+
+static long
+type_utoff(const tzif_zone *z, size_t type, int *isdst, const char **abbr){
+  const tz_type *tt = &z->types[type];
+  if (isdst) *isdst = tt->isdst;
+  if (abbr) *abbr = z->chars + tt->abbr;
+  return tt->utoff;
+}
+
+/* index of the last transition at or before t, ntrans for none */
+static size_t
+find_trans(const tzif_zone *z, long long t){
+  size_t lo = 0, hi = z->ntrans;
+  if (!z->ntrans || t < z->trans[0]) return z->ntrans;
+  while (hi - lo > 1){
+    size_t mid = (lo + hi) / 2;
+    if (t < z->trans[mid]) hi = mid; else lo = mid;
+  }
+  return lo;
+}
+
+static long
+utoff_at(const tzif_zone *z, size_t i, long long t, int *isdst,
+         const char **abbr){
+  if (i == z->ntrans){
+    /* before the first transition, or none listed */
+    if (z->ntrans == 0 && z->rule.present)
+      return rule_utoff(&z->rule, t, isdst, abbr);
+    return type_utoff(z, 0, isdst, abbr);
+  }
+  if (i == z->ntrans - 1 && z->rule.present)
+    return rule_utoff(&z->rule, t, isdst, abbr);
+  return type_utoff(z, z->idx[i], isdst, abbr);
+}
+
+long
+tzif_utoff(const tzif_zone *z, long long t, int *isdst, const char **abbr){
+  return utoff_at(z, find_trans(z, t), t, isdst, abbr);
+}
+
+void
+tzif_utoff_batch(const tzif_zone *z, const double *ajd, long *utoff, size_t n){
+  size_t k, i = z->ntrans;
+  for (k = 0; k < n; k++){
+    long long t = (long long)floor((ajd[k] - UNIX_AJD) * 86400.0 + 0.5);
+    /* reuse the period of the previous sample when t is still in it */
+    int hit = i < z->ntrans ? t >= z->trans[i] &&
+      (i + 1 == z->ntrans || t < z->trans[i + 1]) :
+      z->ntrans == 0 || t < z->trans[0];
+    if (!hit) i = find_trans(z, t);
+    utoff[k] = utoff_at(z, i, t, NULL, NULL);
+  }
+}
+
+double
+tzif_day_start(const tzif_zone *z, long jdn){
+  long long wall = (long long)(jdn - UNIX_JDN) * 86400;
+  long o1 = tzif_utoff(z, wall - tzif_utoff(z, wall, NULL, NULL), NULL, NULL);
+  long long u = wall - o1;
+  long o2 = tzif_utoff(z, u, NULL, NULL);
+  if (o2 != o1){
+    /* midnight falls in a gap, the day starts at the change */
+    long long lo = wall - (o1 > o2 ? o1 : o2);
+    long long hi = wall - (o1 > o2 ? o2 : o1);
+    while (hi - lo > 1){
+      long long mid = lo + (hi - lo) / 2;
+      if (mid + tzif_utoff(z, mid, NULL, NULL) >= wall) hi = mid; else lo = mid;
+    }
+    u = hi;
+  }
+  return UNIX_AJD + (double)u / 86400.0;
+}
+
+static tzif_zone *
+parse_tzif(const unsigned char *buf, size_t len){
+  const unsigned char *p = buf;
+  const unsigned char *end = buf + len;
+  long long cnt[6];
+  size_t i, tsize = 4, need;
+  int version;
+  tzif_zone *z;
+  if (len < 44 || memcmp(p, "TZif", 4) != 0) return NULL;
+  version = p[4] ? p[4] - '0' : 1;
+  for (;;){
+    for (i = 0; i < 6; i++){
+      cnt[i] = be(p + 20 + 4 * i, 4);
+      if (cnt[i] < 0) return NULL;
+    }
+    /* isutcnt isstdcnt leapcnt timecnt typecnt charcnt */
+    need = cnt[3] * (tsize + 1) + cnt[4] * 6 + cnt[5] +
+      cnt[2] * (tsize + 4) + cnt[1] + cnt[0];
+    if (cnt[4] < 1 || (size_t)(end - p) < 44 + need) return NULL;
+    if (version < 2 || tsize == 8) break;
+    /* skip the 32 bit block for the 64 bit one */
+    p += 44 + need;
+    tsize = 8;
+    if ((size_t)(end - p) < 44 || memcmp(p, "TZif", 4) != 0) return NULL;
+  }
+  z = calloc(1, sizeof *z);
+  if (!z) return NULL;
+  z->ntrans = (size_t)cnt[3];
+  z->ntypes = (size_t)cnt[4];
+  z->trans = malloc((z->ntrans + 1) * sizeof *z->trans);
+  z->idx = malloc(z->ntrans + 1);
+  z->types = malloc(z->ntypes * sizeof *z->types);
+  z->chars = malloc((size_t)cnt[5] + 1);
+  if (!z->trans || !z->idx || !z->types || !z->chars){
+    tzif_free(z);
+    return NULL;
+  }
+  p += 44;
+  for (i = 0; i < z->ntrans; i++, p += tsize)
+    z->trans[i] = be(p, (int)tsize);
+  for (i = 0; i < z->ntrans; i++, p++){
+    z->idx[i] = *p;
+    if (*p >= z->ntypes){
+      tzif_free(z);
+      return NULL;
+    }
+  }
+  for (i = 0; i < z->ntypes; i++, p += 6){
+    z->types[i].utoff = (long)be(p, 4);
+    z->types[i].isdst = p[4];
+    z->types[i].abbr = p[5] < cnt[5] ? p[5] : 0;
+  }
+  memcpy(z->chars, p, (size_t)cnt[5]);
+  z->chars[cnt[5]] = '\0';
+  p += cnt[5] + cnt[2] * (tsize + 4) + cnt[1] + cnt[0];
+  /* footer: newline, POSIX TZ string, newline */
+  if (tsize == 8 && p < end && *p == '\n'){
+    const unsigned char *q = memchr(p + 1, '\n', (size_t)(end - p - 1));
+    if (q){
+      char tz[128];
+      size_t n = (size_t)(q - p - 1);
+      if (n < sizeof tz){
+        memcpy(tz, p + 1, n);
+        tz[n] = '\0';
+        parse_rule(tz, &z->rule);
+      }
+    }
+  }
+  return z;
+}
+
+tzif_zone *
+tzif_load(const char *name){
+  char path[1024];
+  const char *dir = getenv("TZDIR");
+  unsigned char *buf = NULL;
+  size_t len = 0, cap = 0, got;
+  tzif_zone *z;
+  FILE *f;
+  if (name[0] == '/')
+    snprintf(path, sizeof path, "%s", name);
+  else{
+    if (strstr(name, "..")){
+      errno = EINVAL;
+      return NULL;
+    }
+    snprintf(path, sizeof path, "%s/%s", dir && *dir ? dir : TZIF_DIR, name);
+  }
+  if (!(f = fopen(path, "rb"))) return NULL;
+  do{
+    if (len == cap){
+      unsigned char *nb = realloc(buf, cap = cap ? 2 * cap : 8192);
+      if (!nb){
+        free(buf);
+        fclose(f);
+        errno = ENOMEM;
+        return NULL;
+      }
+      buf = nb;
+    }
+    got = fread(buf + len, 1, cap - len, f);
+    len += got;
+  } while (got);
+  fclose(f);
+  z = parse_tzif(buf, len);
+  free(buf);
+  if (!z) errno = EINVAL;
+  return z;
+}
+
+void
+tzif_free(tzif_zone *z){
+  if (!z) return;
+  free(z->trans);
+  free(z->idx);
+  free(z->types);
+  free(z->chars);
+  free(z);
+}
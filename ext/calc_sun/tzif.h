@@ -0,0 +1,48 @@
+/*
+ * tzif.h
+ *
+ * Time zones from zoneinfo TZif files (RFC 8536), versions
+ * 1 to 4, including the POSIX TZ rule in the footer that
+ * covers instants after the last listed transition.
+ * No Ruby dependency.
+ *
+ * A zone is parsed once by tzif_load() and then only read,
+ * so one zone may serve any number of threads.
+ * Times are Unix seconds or ajds, offsets seconds east of UTC.
+ */
+#ifndef CALC_SUN_TZIF_H
+#define CALC_SUN_TZIF_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct tzif_zone tzif_zone;
+
+/*
+ * load name relative to $TZDIR or /usr/share/zoneinfo,
+ * or an absolute path. returns NULL with errno set on
+ * failure, EINVAL when the file is not TZif.
+ */
+tzif_zone *tzif_load(const char *name);
+void tzif_free(tzif_zone *z);
+
+/* offset from UTC at Unix time t, isdst and abbr if given */
+long tzif_utoff(const tzif_zone *z, long long t, int *isdst,
+                const char **abbr);
+/*
+ * offsets for n ajds (UT). Consecutive ajds in the same
+ * period skip the search, so sorted input costs O(1) each.
+ */
+void tzif_utoff_batch(const tzif_zone *z, const double *ajd,
+                      long *utoff, size_t n);
+/* ajd (UT) of the first instant of the local civil day jdn */
+double tzif_day_start(const tzif_zone *z, long jdn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,147 @@
+/*
+ * window_rb.h
+ *
+ * Ruby glue for CalcSun#sun_intervals, the spans the Sun
+ * spends above an altitude and inside a window of
+ * azimuths, solved for many sites outside the GVL.
+ * Included by calc_sun.c after get_days() and get_mode().
+ */
+#ifndef CALC_SUN_WINDOW_RB_H
+#define CALC_SUN_WINDOW_RB_H
+
+#include <ruby/thread.h>
+#include "sun_window.h"
+
+/* sampling step unless given, days */
+#define WINDOW_RB_STEP (10.0 / 1440.0)
+
+typedef struct {
+  sun_window w;
+  double d0, d1;
+  const double *lat, *lon;
+  long nsites, next;   /* next site to solve */
+  size_t *ends;        /* pairs after site i, by site */
+  double *spans;
+  size_t n, cap;
+  int r, err;
+  volatile int stop;   /* set by window_ubf() */
+} window_job;
+
+static void
+window_ubf(void *arg){
+  ((window_job *)arg)->stop = 1;
+}
+
+static void *
+window_nogvl(void *arg){
+  window_job *j = arg;
+  for (; j->next < j->nsites && !j->stop; j->next++){
+    long i = j->next;
+    if (sun_window_spans(&j->w, j->d0, j->d1, j->lat[i], j->lon[i],
+                         &j->spans, &j->n, &j->cap) != 0){
+      j->r = -1;
+      j->err = errno;
+      return NULL;
+    }
+    j->ends[i] = j->n;
+  }
+  return NULL;
+}
+
+static VALUE
+window_free(VALUE arg){
+  free(((window_job *)arg)->spans);
+  return Qnil;
+}
+
+static VALUE
+window_body(VALUE arg){
+  window_job *j = (window_job *)arg;
+  VALUE vsites;
+  size_t k = 0;
+  long i;
+  for (;;){
+    rb_thread_call_without_gvl(window_nogvl, j, window_ubf, j);
+    if (!j->stop) break;
+    /* raises for a kill or an exception, else goes on from j->next */
+    rb_thread_check_ints();
+    j->stop = 0;
+  }
+  if (j->r){
+    if (j->err == EINVAL) rb_raise(rb_eArgError, "bad range, step or site");
+    rb_syserr_fail(j->err, "sun_intervals");
+  }
+  vsites = rb_ary_new2(j->nsites);
+  for (i = 0; i < j->nsites; i++){
+    VALUE vspans = rb_ary_new2((long)(j->ends[i] - k));
+    for (; k < j->ends[i]; k++)
+      rb_ary_push(vspans, rb_assoc_new(DBL2NUM(j->spans[2 * k] + DJ00),
+                                       DBL2NUM(j->spans[2 * k + 1] + DJ00)));
+    rb_ary_push(vsites, vspans);
+  }
+  return vsites;
+}
+/*
+ * call-seq:
+ *  sun_intervals(sites, ajds, altitude, azimuths = nil,
+ *                step = 10.0 / 1440)
+ *
+ * given an Array of [lat, lon] sites and a Range of
+ * Astronomical Julian Day Numbers, returns for each site
+ * the Array of [from, to] ajds when the Sun stands at
+ * altitude degrees or higher, and, given a Range of
+ * azimuths in degrees east of north like 90..270, or
+ * 300..60 through north, inside it, merged and cut to
+ * ajds. the altitude and azimuth of the chain are sampled
+ * every step days and at every transit and midnight, and
+ * each crossing is refined on the continuous functions to
+ * well under a second, outside the GVL. a span shorter
+ * than step away from transit and midnight, like a pass
+ * through a narrow window of azimuths, can be missed.
+ * altitudes are geometric, without refraction.
+ *
+ */
+static VALUE func_sun_intervals(int argc, VALUE *argv, VALUE self){
+  VALUE vsites, vrange, valt, vaz, vstep, vtmp, vbeg, vend, vret;
+  window_job j;
+  long i, n;
+  double *buf;
+  int excl;
+  rb_scan_args(argc, argv, "32", &vsites, &vrange, &valt, &vaz, &vstep);
+  Check_Type(vsites, T_ARRAY);
+  if (!rb_range_values(vrange, &vbeg, &vend, &excl))
+    rb_raise(rb_eTypeError, "ajds must be a Range");
+  memset(&j, 0, sizeof j);
+  j.d0 = get_days(vbeg);
+  j.d1 = get_days(vend);
+  j.w.altitude = NUM2DBL(valt);
+  j.w.az_from = 0.0;
+  j.w.az_to = 360.0;
+  if (!NIL_P(vaz)){
+    VALUE vfrom, vto;
+    if (!rb_range_values(vaz, &vfrom, &vto, &excl))
+      rb_raise(rb_eTypeError, "azimuths must be a Range");
+    j.w.az_from = NUM2DBL(vfrom);
+    j.w.az_to = NUM2DBL(vto);
+  }
+  j.w.step = NIL_P(vstep) ? WINDOW_RB_STEP : NUM2DBL(vstep);
+  j.w.mode = get_mode(self);
+  n = RARRAY_LEN(vsites);
+  buf = ALLOCV(vtmp, 2 * n * sizeof(double) + (n + 1) * sizeof(size_t));
+  for (i = 0; i < n; i++){
+    VALUE vsite = rb_ary_entry(vsites, i);
+    Check_Type(vsite, T_ARRAY);
+    if (RARRAY_LEN(vsite) != 2) rb_raise(rb_eArgError, "sites must be [lat, lon]");
+    buf[i] = NUM2DBL(rb_ary_entry(vsite, 0));
+    buf[n + i] = NUM2DBL(rb_ary_entry(vsite, 1));
+  }
+  j.lat = buf;
+  j.lon = buf + n;
+  j.nsites = n;
+  j.ends = (size_t *)(buf + 2 * n);
+  vret = rb_ensure(window_body, (VALUE)&j, window_free, (VALUE)&j);
+  ALLOCV_END(vtmp);
+  return vret;
+}
+
+#endif
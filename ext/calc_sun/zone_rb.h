@@ -0,0 +1,304 @@
+/*
+ * zone_rb.h
+ *
+ * Ruby glue for CalcSun::Zone and the local day tables.
+ * Included by calc_sun.c after get_ajd(), get_mode()
+ * and the solar.h declarations.
+ */
+#ifndef CALC_SUN_ZONE_RB_H
+#define CALC_SUN_ZONE_RB_H
+
+#include <errno.h>
+#include <ruby/st.h>
+#include <ruby/thread_native.h>
+#include <ruby/util.h>
+#include "tzif.h"
+
+static VALUE cZone;
+static ID id_name;
+/* name => frozen Zone of Zone[], shared by every Ractor */
+static st_table *zone_cache;
+static rb_nativethread_lock_t zone_lock;
+
+static void
+zone_free(void *p){
+  tzif_free((tzif_zone *)p);
+}
+
+static const rb_data_type_t zone_type = {
+  "CalcSun::Zone",
+  {0, zone_free, 0,},
+  0, 0,
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+  RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_FROZEN_SHAREABLE,
+#else
+  RUBY_TYPED_FREE_IMMEDIATELY,
+#endif
+};
+
+static VALUE
+zone_alloc(VALUE klass){
+  return TypedData_Wrap_Struct(klass, &zone_type, 0);
+}
+
+static const tzif_zone *
+get_zone(VALUE vzone){
+  tzif_zone *z = rb_check_typeddata(vzone, &zone_type);
+  if (!z) rb_raise(rb_eArgError, "uninitialized CalcSun::Zone");
+  return z;
+}
+/* Unix seconds of an ajd, rounded to the second */
+static long long
+zone_unix(double ajd){
+  return (long long)floor((ajd - 2440587.5) * 86400.0 + 0.5);
+}
+/*
+ * call-seq:
+ *  CalcSun::Zone.new(name)
+ *
+ * loads the zoneinfo file name, like 'America/Chicago',
+ * from $TZDIR or /usr/share/zoneinfo, or an absolute path.
+ * raises SystemCallError when it cannot be read and
+ * ArgumentError for a name with .. or a file that is not TZif.
+ * the zone is frozen and can be shared between Ractors.
+ *
+ */
+static VALUE zone_init(VALUE self, VALUE vname){
+  const char *name;
+  tzif_zone *z;
+  if (DATA_PTR(self)) rb_raise(rb_eTypeError, "already initialized zone");
+  FilePathValue(vname);
+  name = StringValueCStr(vname);
+  z = tzif_load(name);
+  if (!z){
+    if (errno == EINVAL) rb_raise(rb_eArgError, "not a TZif zone: %s", name);
+    rb_sys_fail(name);
+  }
+  DATA_PTR(self) = z;
+  rb_ivar_set(self, id_name, rb_str_new_frozen(vname));
+  return rb_obj_freeze(self);
+}
+/*
+ * call-seq:
+ *  CalcSun::Zone[name]
+ *
+ * the zone for name, loaded on first use and
+ * kept for the life of the process. every Ractor
+ * gets the same Zone.
+ *
+ */
+static VALUE zone_s_aref(VALUE klass, VALUE vname){
+  const char *name;
+  st_data_t v;
+  VALUE vzone;
+  int found;
+  FilePathValue(vname);
+  name = StringValueCStr(vname);
+  rb_nativethread_lock_lock(&zone_lock);
+  found = st_lookup(zone_cache, (st_data_t)name, &v);
+  rb_nativethread_lock_unlock(&zone_lock);
+  if (found) return (VALUE)v;
+  /* loaded outside the lock; a Ractor that loses the race
+  * to insert takes the winner's zone
+  */
+  vzone = rb_class_new_instance(1, &vname, klass);
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+  rb_ractor_make_shareable(vzone);
+#endif
+  rb_nativethread_lock_lock(&zone_lock);
+  if (st_lookup(zone_cache, (st_data_t)name, &v))
+    found = 1;
+  else
+    st_insert(zone_cache, (st_data_t)ruby_strdup(name), (st_data_t)vzone);
+  rb_nativethread_lock_unlock(&zone_lock);
+  if (found) return (VALUE)v;
+  rb_gc_register_mark_object(vzone);
+  return vzone;
+}
+/*
+ * call-seq:
+ *  name
+ *
+ * the name the zone was loaded by.
+ *
+ */
+static VALUE zone_name(VALUE self){
+  return rb_attr_get(self, id_name);
+}
+/*
+ * call-seq:
+ *  utc_offset(ajd)
+ * or
+ *  utc_offset([ajd, ...])
+ *
+ * given an Astronomical Julian Day Number (UT),
+ * returns the zone's offset from UTC in seconds.
+ * An Array gives an Array, fastest when sorted.
+ *
+ */
+static VALUE zone_utc_offset(VALUE self, VALUE vajd){
+  const tzif_zone *z = get_zone(self);
+  long i, n;
+  double *ajd;
+  long *off;
+  VALUE vtmp, vary;
+  if (!RB_TYPE_P(vajd, T_ARRAY))
+    return LONG2NUM(tzif_utoff(z, zone_unix(get_ajd(vajd)), NULL, NULL));
+  n = RARRAY_LEN(vajd);
+  ajd = ALLOCV(vtmp, n * (sizeof(double) + sizeof(long)) + 1);
+  off = (long *)(ajd + n);
+  for (i = 0; i < n; i++)
+    ajd[i] = get_ajd(rb_ary_entry(vajd, i));
+  tzif_utoff_batch(z, ajd, off, (size_t)n);
+  vary = rb_ary_new2(n);
+  for (i = 0; i < n; i++)
+    rb_ary_push(vary, LONG2NUM(off[i]));
+  ALLOCV_END(vtmp);
+  return vary;
+}
+/*
+ * call-seq:
+ *  local(ajd)
+ * or
+ *  local([ajd, ...])
+ *
+ * given an Astronomical Julian Day Number (UT),
+ * returns the local wall clock time as an ajd,
+ * daylight saving included.
+ * An Array gives an Array, fastest when sorted.
+ *
+ */
+static VALUE zone_local(VALUE self, VALUE vajd){
+  const tzif_zone *z = get_zone(self);
+  long i, n;
+  double *ajd;
+  long *off;
+  VALUE vtmp, vary;
+  if (!RB_TYPE_P(vajd, T_ARRAY)){
+    double a = get_ajd(vajd);
+    return DBL2NUM(a + tzif_utoff(z, zone_unix(a), NULL, NULL) / 86400.0);
+  }
+  n = RARRAY_LEN(vajd);
+  ajd = ALLOCV(vtmp, n * (sizeof(double) + sizeof(long)) + 1);
+  off = (long *)(ajd + n);
+  for (i = 0; i < n; i++)
+    ajd[i] = get_ajd(rb_ary_entry(vajd, i));
+  tzif_utoff_batch(z, ajd, off, (size_t)n);
+  vary = rb_ary_new2(n);
+  for (i = 0; i < n; i++)
+    rb_ary_push(vary, DBL2NUM(ajd[i] + off[i] / 86400.0));
+  ALLOCV_END(vtmp);
+  return vary;
+}
+/*
+ * call-seq:
+ *  dst?(ajd)
+ *
+ * given an Astronomical Julian Day Number (UT),
+ * returns true when daylight saving time is in effect.
+ *
+ */
+static VALUE zone_dst_p(VALUE self, VALUE vajd){
+  int isdst;
+  tzif_utoff(get_zone(self), zone_unix(get_ajd(vajd)), &isdst, NULL);
+  return isdst ? Qtrue : Qfalse;
+}
+/*
+ * call-seq:
+ *  abbreviation(ajd)
+ *
+ * given an Astronomical Julian Day Number (UT),
+ * returns the zone abbreviation in use, like 'CDT'.
+ *
+ */
+static VALUE zone_abbreviation(VALUE self, VALUE vajd){
+  const char *abbr = "";
+  tzif_utoff(get_zone(self), zone_unix(get_ajd(vajd)), NULL, &abbr);
+  return rb_str_new_cstr(abbr);
+}
+/*
+ * call-seq:
+ *  day_start(jd)
+ *
+ * given the Julian Day Number of a local civil date,
+ * returns the Astronomical Julian Day Number (UT) of its
+ * first instant, local midnight or the end of a
+ * daylight saving gap that swallows midnight.
+ *
+ */
+static VALUE zone_day_start(VALUE self, VALUE vjd){
+  return DBL2NUM(tzif_day_start(get_zone(self), NUM2LONG(vjd)));
+}
+/* local wall ajd of the first event of the UT days
+* jdn - 1 to jdn + 1 that falls in [s0, s1), or nil
+*/
+static VALUE
+local_event(const tzif_zone *z,
+            double (*ev)(double, double, double, int),
+            long jdn, double s0, double s1,
+            double lat, double lon, int mode){
+  long k;
+  for (k = jdn - 1; k <= jdn + 1; k++){
+    double t = ev((double)k - DJ00, lat, lon, mode);
+    if (t >= s0 && t < s1)
+      return DBL2NUM(t + tzif_utoff(z, zone_unix(t), NULL, NULL) / 86400.0);
+  }
+  return Qnil;
+}
+/*
+ * call-seq:
+ *  local_day_table(zone, jd, days, lat, lon)
+ *
+ * given a CalcSun::Zone, the Julian Day Number of the
+ * first local civil date, a number of days and
+ * local Latitude and Longitude,
+ * returns an Array with one [jd, rise, noon, set] per
+ * local date. The times are local wall clock ajds and
+ * fall between that date's midnights in the zone, so
+ * days of 23 or 25 hours are honored. nil where the
+ * event does not happen on the date.
+ *
+ */
+static VALUE func_local_day_table(VALUE self, VALUE vzone, VALUE vjd,
+                                  VALUE vdays, VALUE vlat, VALUE vlon){
+  const tzif_zone *z = get_zone(vzone);
+  int mode = get_mode(self);
+  long jdn = NUM2LONG(vjd), days = NUM2LONG(vdays);
+  double lat = NUM2DBL(vlat), lon = NUM2DBL(vlon);
+  double s0, s1;
+  long i;
+  VALUE vary;
+  if (days < 0) rb_raise(rb_eArgError, "negative day count");
+  vary = rb_ary_new2(days);
+  s1 = tzif_day_start(z, jdn);
+  for (i = 0; i < days; i++, jdn++){
+    VALUE vrow = rb_ary_new2(4);
+    s0 = s1;
+    s1 = tzif_day_start(z, jdn + 1);
+    rb_ary_push(vrow, LONG2NUM(jdn));
+    rb_ary_push(vrow, local_event(z, solar_rise_jd, jdn, s0, s1, lat, lon, mode));
+    rb_ary_push(vrow, local_event(z, solar_noon_jd, jdn, s0, s1, lat, lon, mode));
+    rb_ary_push(vrow, local_event(z, solar_set_jd, jdn, s0, s1, lat, lon, mode));
+    rb_ary_push(vary, vrow);
+  }
+  return vary;
+}
+
+static void
+init_zone(VALUE cCalcSun){
+  id_name = rb_intern("@name");
+  zone_cache = st_init_strtable();
+  rb_nativethread_lock_initialize(&zone_lock);
+  cZone = rb_define_class_under(cCalcSun, "Zone", rb_cObject);
+  rb_define_alloc_func(cZone, zone_alloc);
+  rb_define_singleton_method(cZone, "[]", zone_s_aref, 1);
+  rb_define_method(cZone, "initialize", zone_init, 1);
+  rb_define_method(cZone, "abbreviation", zone_abbreviation, 1);
+  rb_define_method(cZone, "day_start", zone_day_start, 1);
+  rb_define_method(cZone, "dst?", zone_dst_p, 1);
+  rb_define_method(cZone, "local", zone_local, 1);
+  rb_define_method(cZone, "name", zone_name, 0);
+  rb_define_method(cZone, "utc_offset", zone_utc_offset, 1);
+}
+
+#endif
@@ -2,4 +2,10 @@
 require 'mkmf'
 extension_name = 'side_time/side_time'
 dir_config(extension_name)
+# the sidereal core lives with calc_sun and is built into both
+$VPATH << '$(srcdir)/../calc_sun'
+$INCFLAGS << ' -I$(srcdir)/../calc_sun'
+$srcs = ['side_time.c', 'sidereal.c']
+# Ruby 3.0 and later run the extension in any Ractor
+have_func('rb_ext_ractor_safe', 'ruby.h')
 create_makefile(extension_name)
\ No newline at end of file
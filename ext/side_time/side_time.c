@@ -16,6 +16,17 @@
 # define DJ00 2451545.0L
 # define RND12 1000000000000.0
 
+static ID id_ajd;
+/* ajd of a Numeric, or of a Date or DateTime */
+static double
+get_ajd(VALUE vdate){
+  if (rb_obj_is_kind_of(vdate, rb_cNumeric))
+    return NUM2DBL(vdate);
+  return NUM2DBL(rb_funcall(vdate, id_ajd, 0));
+}
+#define SIDEREAL_RB_DAYS(v) (get_ajd(v) - DJ00)
+#include "sidereal_rb.h"
+
 /*
  * call-seq:
  *  initialize()
@@ -57,35 +68,27 @@ static VALUE func_get_jd(VALUE self, VALUE vdate){
  *
  */
 static VALUE func_get_ajd(VALUE self, VALUE vdate){
-  double ajd = NUM2DBL(rb_funcall(vdate, rb_intern("ajd"), 0));
+  double ajd = get_ajd(vdate);
   return DBL2NUM(ajd);
 }
 /*
  * call-seq:
  *  gmst(date)
+ * or
+ *  gmst(ajd)
  *
  * calculate Greenwhich Mean Sidereal Time.
  *
  */
 static VALUE func_mean_sidetime(VALUE self, VALUE vdate){
-  double ajd = NUM2DBL(func_get_ajd(self, vdate));
-  long double sidereal;
-  long double t;
-  t = (ajd - 2451545.0) / 36525.0;
-  /* calc mean angle */
-  sidereal =
-  280.46061837 +
-  (360.98564736629 * (ajd - 2451545.0)) +
-  (0.000387933 * t * t) -
-  (t * t * t / 38710000.0);
-  sidereal = fmod(sidereal, 360.0);
-  /* change to hours */
-  sidereal *= 24.0 / 360.0;
+  double sidereal = sidereal_gmst(get_ajd(vdate) - DJ00);
   return DBL2NUM(roundf(sidereal * RND12) / RND12);
 }
 /*
  * call-seq:
- *  lmst(date)
+ *  lmst(date, lon)
+ * or
+ *  lmst(ajd, lon)
  *
  * calculate Local Mean Sidereal Time.
  *
@@ -104,11 +107,19 @@ static VALUE func_local_sidetime(VALUE self, VALUE vdate, VALUE vlon){
 
 void Init_side_time(void){
   VALUE cSideTime = rb_define_class("SideTime", rb_cObject);
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+  /* no state beyond the interned ID */
+  rb_ext_ractor_safe(true);
+#endif
   rb_require("date");
+  id_ajd = rb_intern("ajd");
   rb_define_method(cSideTime, "initialize", t_init, 0);
   rb_define_method(cSideTime, "ajd", func_get_ajd, 1);
   rb_define_method(cSideTime, "s_datetime", func_set_datetime, 1);
   rb_define_method(cSideTime, "jd", func_get_jd, 1);
   rb_define_method(cSideTime, "lmst", func_local_sidetime, 2);
   rb_define_method(cSideTime, "gmst", func_mean_sidetime, 1);
+  rb_define_method(cSideTime, "gmst_batch", func_gmst_batch, 1);
+  rb_define_method(cSideTime, "gmst_steps", func_gmst_steps, 3);
+  rb_define_method(cSideTime, "lmst_batch", func_lmst_batch, 2);
 }
\ No newline at end of file
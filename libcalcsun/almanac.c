@@ -0,0 +1,596 @@
+/*
+ * almanac.c
+ *
+ * Rise, transit, set and day length for a file of sites
+ * over a date range, computed on all cores with libcalcsun.
+ *
+ *  almanac [-j threads] [-o file] [-a [-b rows]] [-s | -r]
+ *          [-d delta_t] [-i iers_finals] [-z zone]
+ *          sites first last
+ *
+ * sites holds one site per line, "name lat lon" separated by
+ * blanks or commas, lat and lon in degrees, east positive;
+ * '#' starts a comment. first and last are ISO-8601 dates.
+ * -s uses NREL SPA instead of the CalcSun chain. Its
+ * delta_t (TT - UT, seconds) comes from -d, or per day from
+ * the built in model and the IERS finals file given with -i.
+ * -r uses Paul Schlyter's sunriset, the cheapest and good
+ * to a couple of minutes.
+ * -z gives times on the wall clock of a zoneinfo zone, like
+ * America/Chicago, for the zone's civil dates.
+ *
+ * Output is CSV in site, then date order, times in UT or -z:
+ *  site,date,rise,transit,set,day_length
+ * rise and set are empty when the Sun stays up or down all
+ * day (day_length 24:00:00 or 00:00:00).
+ *
+ * -a writes an Apache Arrow IPC stream instead, in record
+ * batches of -b rows, 65536 by default, with the columns
+ *  site (utf8), date (date32), rise, transit, set
+ *  (timestamp[ms], UTC, or wall clock with no zone under -z,
+ *  each the event's own instant, which for rise and set may
+ *  fall on the date before or after), day_length (float64,
+ *  hours), status (int8)
+ * status 0 for a day with rise and set, 1 when the Sun stays
+ * up, 2 when it stays down; missing times are null.
+ */
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ajd_parse.h"
+#include "arrow_ipc.h"
+#include "delta_t.h"
+#include "solar.h"
+#include "spa_rts.h"
+#include "sunriset.h"
+#include "tzif.h"
+
+/* days computed per unit of work */
+#define ALMANAC_BLOCK 32
+/* units in flight per thread before workers wait for the writer */
+#define ALMANAC_SLOTS 4
+/* longest output row */
+#define ALMANAC_ROW 160
+/* default rows per Arrow record batch */
+#define ALMANAC_BATCH 65536
+
+typedef struct {
+  char name[64];
+  double lat, lon;
+} site_t;
+
+enum {
+  ENGINE_CHAIN,
+  ENGINE_SPA,
+  ENGINE_SUNRISET
+};
+
+typedef struct {
+  char *buf;
+  double *vals;   /* -a: rise, transit, set ajds, day_length per day */
+  size_t len;
+  int done;
+} slot_t;
+
+typedef struct {
+  const site_t *sites;
+  long first, ndays, nblocks, nunits;
+  int engine;     /* ENGINE_ above */
+  double delta_t;
+  const tzif_zone *zone;
+  int arrow;      /* -a */
+  slot_t *slots;
+  long nslots;
+  long next;      /* next unit to hand out */
+  long written;   /* units written so far */
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+} job_t;
+
+static void
+usage(void){
+  fputs("usage: almanac [-j threads] [-o file] [-a [-b rows]] [-s | -r] "
+        "[-d delta_t] [-i iers_finals] [-z zone] sites first last\n", stderr);
+  exit(2);
+}
+
+static site_t *
+read_sites(const char *path, long *count){
+  FILE *f = fopen(path, "r");
+  char line[256];
+  site_t *sites = NULL;
+  long n = 0, cap = 0, lineno = 0;
+  if (!f){
+    fprintf(stderr, "almanac: %s: %s\n", path, strerror(errno));
+    exit(1);
+  }
+  while (fgets(line, sizeof line, f)){
+    char *p;
+    site_t s;
+    lineno++;
+    if ((p = strchr(line, '#'))) *p = '\0';
+    for (p = line; *p; p++)
+      if (*p == ',') *p = ' ';
+    if (sscanf(line, "%63s", s.name) != 1) continue;
+    if (sscanf(line, "%*s %lf %lf", &s.lat, &s.lon) != 2 ||
+        fabs(s.lat) > 90.0 || fabs(s.lon) > 180.0){
+      fprintf(stderr, "almanac: %s:%ld: expected name lat lon\n", path, lineno);
+      exit(1);
+    }
+    if (n == cap){
+      cap = cap ? 2 * cap : 64;
+      sites = realloc(sites, (size_t)cap * sizeof *sites);
+      if (!sites){
+        perror("almanac");
+        exit(1);
+      }
+    }
+    sites[n++] = s;
+  }
+  fclose(f);
+  *count = n;
+  return sites;
+}
+
+static long
+parse_jdn(const char *s){
+  double ajd;
+  if (ajd_parse(s, strlen(s), &ajd) != AJD_PARSE_OK){
+    fprintf(stderr, "almanac: bad date '%s'\n", s);
+    exit(2);
+  }
+  return (long)floor(ajd + 0.5);
+}
+
+/* hours as HH:MM:SS, empty for NaN */
+static int
+put_hms(char *p, double h){
+  long s;
+  if (isnan(h)) return 0;
+  s = lround(h * 3600.0);
+  return sprintf(p, "%02ld:%02ld:%02ld", s / 3600, s / 60 % 60, s % 60);
+}
+
+/* UT hour of the day of an ajd, 0 to 24 */
+static double
+ajd_hours(double ajd){
+  double h = fmod((ajd + 0.5) * 24.0, 24.0);
+  return h < 0.0 ? h + 24.0 : h;
+}
+
+/* wall clock ajd of an event on civil date jdn of zone z,
+* taken from the UT days around it, NaN when it misses the date
+*/
+static double
+zone_ajd(const tzif_zone *z, const site_t *s, long jdn,
+         double (*ev)(double, double, double, int)){
+  double s0 = tzif_day_start(z, jdn), s1 = tzif_day_start(z, jdn + 1);
+  long k;
+  for (k = jdn - 1; k <= jdn + 1; k++){
+    double t = ev((double)k - DJ00, s->lat, s->lon, SOLAR_RAW);
+    if (t >= s0 && t < s1){
+      long long u = (long long)floor((t - 2440587.5) * 86400.0 + 0.5);
+      return t + tzif_utoff(z, u, NULL, NULL) / 86400.0;
+    }
+  }
+  return NAN;
+}
+
+/*
+ * the day functions give rise, transit and set as ajds, of
+ * the UT instant or under -z of the wall clock time, each
+ * on the day the engine gives it, which for rise and set
+ * may be the UT date before or after jdn; the CSV prints
+ * their hours, the Arrow stream the ajds
+ */
+static void
+chain_day(const site_t *s, long jdn, const tzif_zone *z, double *rise,
+          double *noon, double *set, double *len){
+  double d = (double)jdn - DJ00;
+  if (z)
+    *noon = zone_ajd(z, s, jdn, solar_noon_jd);
+  else
+    *noon = solar_noon_jd(d, s->lat, s->lon, SOLAR_RAW);
+  *len = solar_dlt(d, s->lat, SOLAR_RAW);
+  if (isnan(*len)){
+    /* acos out of range, up all day past -1, down past 1 */
+    *len = solar_cos_h0(d, s->lat, SOLAR_RAW) < 0.0 ? 24.0 : 0.0;
+    *rise = *set = NAN;
+    return;
+  }
+  if (z){
+    *rise = zone_ajd(z, s, jdn, solar_rise_jd);
+    *set = zone_ajd(z, s, jdn, solar_set_jd);
+    return;
+  }
+  *rise = solar_rise_jd(d, s->lat, s->lon, SOLAR_RAW);
+  *set = solar_set_jd(d, s->lat, s->lon, SOLAR_RAW);
+}
+
+/* sunriset events as ajds, in the form zone_hours() takes */
+static double
+sunriset_event(double d, double lat, double lon, int which){
+  double e[3];
+  sunriset_rise_set_n(1, &d, &lat, &lon, SUNRISET_RISE_SET, 1,
+                      e, e + 1, e + 2, NULL);
+  return e[which];
+}
+
+static double
+sunriset_rise_jd(double d, double lat, double lon, int mode){
+  (void)mode;
+  return sunriset_event(d, lat, lon, 0);
+}
+
+static double
+sunriset_noon_jd(double d, double lat, double lon, int mode){
+  (void)mode;
+  return sunriset_event(d, lat, lon, 1);
+}
+
+static double
+sunriset_set_jd(double d, double lat, double lon, int mode){
+  (void)mode;
+  return sunriset_event(d, lat, lon, 2);
+}
+
+static void
+sunriset_day(const site_t *s, long jdn, const tzif_zone *z, double *rise,
+             double *noon, double *set, double *len){
+  double d = (double)jdn - DJ00, r, t, st;
+  sunriset_rise_set_n(1, &d, &s->lat, &s->lon, SUNRISET_RISE_SET, 1,
+                      &r, &t, &st, len);
+  if (isnan(r)){
+    *rise = *set = NAN;
+    *noon = z ? zone_ajd(z, s, jdn, sunriset_noon_jd) : t;
+    return;
+  }
+  if (z){
+    *rise = zone_ajd(z, s, jdn, sunriset_rise_jd);
+    *noon = zone_ajd(z, s, jdn, sunriset_noon_jd);
+    *set = zone_ajd(z, s, jdn, sunriset_set_jd);
+    return;
+  }
+  *rise = r;
+  *noon = t;
+  *set = st;
+}
+
+static void
+spa_day(spa_rts_window *w, const site_t *s, long jdn, double delta_t,
+        const tzif_zone *z, double *rise, double *noon, double *set,
+        double *len){
+  spa_data sd;
+  double start = (double)jdn - 0.5;
+  long y;
+  memset(&sd, 0, sizeof sd);
+  ajd_jdn_to_civil(jdn, &y, &sd.month, &sd.day);
+  sd.year = (int)y;
+  if (isnan(delta_t)){
+    sd.delta_t = delta_t_ajd((double)jdn - 0.5);
+    sd.delta_ut1 = delta_t_dut1((double)jdn - 0.5);
+  }
+  else
+    sd.delta_t = delta_t;
+  /* SPA takes one fixed offset, the zone's at noon UT of the date */
+  if (z)
+    sd.timezone = tzif_utoff(z, (long long)(jdn - 2440588) * 86400 + 43200,
+                             NULL, NULL) / 3600.0;
+  sd.longitude = s->lon;
+  sd.latitude = s->lat;
+  sd.pressure = 1010.0;
+  sd.temperature = 10.0;
+  sd.atmos_refract = 0.5667;
+  sd.function = SPA_ZA_RTS;
+  *rise = *noon = *set = *len = NAN;
+  if (spa_rts_day(w, &sd) != 0) return;
+  /* hours of the date in SPA's timezone */
+  *noon = start + sd.suntransit / 24.0;
+  if (sd.sunrise < 0.0 || sd.sunset < 0.0){
+    /* spa_rts_day() flags no rise or set with -99999 */
+    *len = spa_rts_polar(w, &sd) > 0 ? 24.0 : 0.0;
+    return;
+  }
+  *len = sd.sunset - sd.sunrise;
+  if (*len < 0.0) *len += 24.0;
+  /*
+   * SPA wraps a rise before its midnight and a set after
+   * the next into the date, put them back on their own day
+   */
+  *rise = start + (sd.sunrise > sd.suntransit ? sd.sunrise - 24.0 :
+                   sd.sunrise) / 24.0;
+  *set = start + (sd.sunset < sd.suntransit ? sd.sunset + 24.0 :
+                  sd.sunset) / 24.0;
+}
+
+static void
+run_unit(job_t *job, long u, slot_t *slot){
+  const site_t *s = &job->sites[u / job->nblocks];
+  long b = u % job->nblocks;
+  long j0 = job->first + b * ALMANAC_BLOCK;
+  long j1 = j0 + ALMANAC_BLOCK;
+  long jdn;
+  char *p = slot->buf;
+  /* the block's days are consecutive, one SPA ephemeris call a day */
+  spa_rts_window w;
+  spa_rts_init(&w);
+  if (j1 > job->first + job->ndays) j1 = job->first + job->ndays;
+  for (jdn = j0; jdn < j1; jdn++){
+    double rise, noon, set, len;
+    long y;
+    int m, d;
+    switch (job->engine){
+    case ENGINE_SPA:
+      spa_day(&w, s, jdn, job->delta_t, job->zone, &rise, &noon, &set, &len);
+      break;
+    case ENGINE_SUNRISET:
+      sunriset_day(s, jdn, job->zone, &rise, &noon, &set, &len);
+      break;
+    default:
+      chain_day(s, jdn, job->zone, &rise, &noon, &set, &len);
+    }
+    if (job->arrow){
+      double *v = slot->vals + 4 * (jdn - j0);
+      v[0] = rise;
+      v[1] = noon;
+      v[2] = set;
+      v[3] = len;
+      continue;
+    }
+    ajd_jdn_to_civil(jdn, &y, &m, &d);
+    p += sprintf(p, "%s,%04ld-%02d-%02d,", s->name, y, m, d);
+    p += put_hms(p, ajd_hours(rise));
+    *p++ = ',';
+    p += put_hms(p, ajd_hours(noon));
+    *p++ = ',';
+    p += put_hms(p, ajd_hours(set));
+    *p++ = ',';
+    p += put_hms(p, len);
+    *p++ = '\n';
+  }
+  slot->len = job->arrow ? (size_t)(j1 - j0) : (size_t)(p - slot->buf);
+}
+
+static void *
+worker(void *arg){
+  job_t *job = arg;
+  for (;;){
+    long u;
+    slot_t *slot;
+    pthread_mutex_lock(&job->lock);
+    u = job->next;
+    if (u >= job->nunits){
+      pthread_mutex_unlock(&job->lock);
+      return NULL;
+    }
+    job->next++;
+    /* the slot frees once the writer is within nslots of u */
+    while (u >= job->written + job->nslots)
+      pthread_cond_wait(&job->cond, &job->lock);
+    pthread_mutex_unlock(&job->lock);
+    slot = &job->slots[u % job->nslots];
+    run_unit(job, u, slot);
+    pthread_mutex_lock(&job->lock);
+    slot->done = 1;
+    pthread_cond_broadcast(&job->cond);
+    pthread_mutex_unlock(&job->lock);
+  }
+}
+
+/* -a: the columns of the record batch being gathered */
+typedef struct {
+  long n, rows;
+  const char **site;
+  double *date, *rise, *noon, *set, *len;
+  signed char *status;
+  arrow_field fields[7];
+} batch_t;
+
+static void
+batch_init(batch_t *b, long rows, const tzif_zone *z){
+  const char *tz = z ? NULL : "UTC";
+  const arrow_field f[7] = {
+    {"site", ARROW_UTF8, NULL}, {"date", ARROW_DATE32, NULL},
+    {"rise", ARROW_TIMESTAMP, tz}, {"transit", ARROW_TIMESTAMP, tz},
+    {"set", ARROW_TIMESTAMP, tz}, {"day_length", ARROW_FLOAT64, NULL},
+    {"status", ARROW_INT8, NULL}
+  };
+  memcpy(b->fields, f, sizeof f);
+  b->n = 0;
+  b->rows = rows;
+  b->site = malloc((size_t)rows * sizeof *b->site);
+  b->date = malloc(5 * (size_t)rows * sizeof *b->date);
+  b->status = malloc((size_t)rows);
+  if (!b->site || !b->date || !b->status){
+    perror("almanac");
+    exit(1);
+  }
+  b->rise = b->date + rows;
+  b->noon = b->rise + rows;
+  b->set = b->noon + rows;
+  b->len = b->set + rows;
+}
+
+static void
+batch_flush(batch_t *b, FILE *out){
+  const void *cols[7];
+  cols[0] = b->site;
+  cols[1] = b->date;
+  cols[2] = b->rise;
+  cols[3] = b->noon;
+  cols[4] = b->set;
+  cols[5] = b->len;
+  cols[6] = b->status;
+  if (b->n && arrow_write_batch(out, b->fields, 7, b->n, cols) != 0){
+    perror("almanac");
+    exit(1);
+  }
+  b->n = 0;
+}
+
+/* a day of a unit, its events already ajds */
+static void
+batch_add(batch_t *b, FILE *out, const site_t *s, long jdn, const double *v){
+  long k = b->n++;
+  b->site[k] = s->name;
+  b->date[k] = (double)jdn;
+  b->rise[k] = v[0];
+  b->noon[k] = v[1];
+  b->set[k] = v[2];
+  b->len[k] = v[3];
+  b->status[k] = !isnan(v[0]) ? 0 : v[3] == 24.0 ? 1 : v[3] == 0.0 ? 2 : 0;
+  if (b->n == b->rows) batch_flush(b, out);
+}
+
+int
+main(int argc, char **argv){
+  job_t job;
+  FILE *out = stdout;
+  const char *outpath = NULL;
+  long nsites, last, i, started = 0;
+  long nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+  pthread_t *threads;
+  tzif_zone *zone = NULL;
+  batch_t batch;
+  long rows = ALMANAC_BATCH;
+  int c;
+  memset(&job, 0, sizeof job);
+  job.delta_t = NAN;
+  while ((c = getopt(argc, argv, "j:o:ab:srd:i:z:")) != -1){
+    switch (c){
+    case 'j': nthreads = atol(optarg); break;
+    case 'o': outpath = optarg; break;
+    case 'a': job.arrow = 1; break;
+    case 'b': rows = atol(optarg); break;
+    case 's': job.engine = ENGINE_SPA; break;
+    case 'r': job.engine = ENGINE_SUNRISET; break;
+    case 'd': job.delta_t = atof(optarg); break;
+    case 'i':
+      if (delta_t_load_iers(optarg) <= 0){
+        fprintf(stderr, "almanac: %s: no UT1-UTC values\n", optarg);
+        return 1;
+      }
+      break;
+    case 'z':
+      if (!(zone = tzif_load(optarg))){
+        fprintf(stderr, "almanac: %s: %s\n", optarg,
+                errno == EINVAL ? "not a TZif zone" : strerror(errno));
+        return 1;
+      }
+      job.zone = zone;
+      break;
+    default: usage();
+    }
+  }
+  if (argc - optind != 3 || rows < 1) usage();
+  if (nthreads < 1) nthreads = 1;
+  job.sites = read_sites(argv[optind], &nsites);
+  job.first = parse_jdn(argv[optind + 1]);
+  last = parse_jdn(argv[optind + 2]);
+  if (last < job.first){
+    fputs("almanac: last date before first\n", stderr);
+    return 2;
+  }
+  if (outpath && !(out = fopen(outpath, "w"))){
+    fprintf(stderr, "almanac: %s: %s\n", outpath, strerror(errno));
+    return 1;
+  }
+  job.ndays = last - job.first + 1;
+  job.nblocks = (job.ndays + ALMANAC_BLOCK - 1) / ALMANAC_BLOCK;
+  job.nunits = nsites * job.nblocks;
+  job.nslots = nthreads * ALMANAC_SLOTS;
+  job.slots = calloc((size_t)job.nslots, sizeof *job.slots);
+  threads = calloc((size_t)nthreads, sizeof *threads);
+  if (!job.slots || !threads){
+    perror("almanac");
+    return 1;
+  }
+  for (i = 0; i < job.nslots; i++){
+    if (job.arrow)
+      job.slots[i].vals = malloc(4 * ALMANAC_BLOCK * sizeof(double));
+    else
+      job.slots[i].buf = malloc(ALMANAC_BLOCK * ALMANAC_ROW);
+    if (!job.slots[i].buf && !job.slots[i].vals){
+      perror("almanac");
+      return 1;
+    }
+  }
+  pthread_mutex_init(&job.lock, NULL);
+  pthread_cond_init(&job.cond, NULL);
+  for (i = 0; i < nthreads; i++)
+    if (pthread_create(&threads[started], NULL, worker, &job) == 0)
+      started++;
+
+  if (job.arrow){
+    batch_init(&batch, rows, job.zone);
+    if (arrow_write_schema(out, batch.fields, 7) != 0){
+      perror("almanac");
+      return 1;
+    }
+  }
+  else if (fputs("site,date,rise,transit,set,day_length\n", out) == EOF){
+    perror("almanac");
+    return 1;
+  }
+  /*
+   * write units in order as they complete; with no worker
+   * started, compute each here just before writing it
+   */
+  for (i = 0; i < job.nunits; i++){
+    slot_t *slot = &job.slots[i % job.nslots];
+    if (!started)
+      run_unit(&job, i, slot);
+    pthread_mutex_lock(&job.lock);
+    while (started && !slot->done)
+      pthread_cond_wait(&job.cond, &job.lock);
+    pthread_mutex_unlock(&job.lock);
+    if (job.arrow){
+      const site_t *s = &job.sites[i / job.nblocks];
+      long j0 = job.first + i % job.nblocks * ALMANAC_BLOCK, k;
+      for (k = 0; k < (long)slot->len; k++)
+        batch_add(&batch, out, s, j0 + k, slot->vals + 4 * k);
+    }
+    else if (fwrite(slot->buf, 1, slot->len, out) != slot->len){
+      perror("almanac");
+      return 1;
+    }
+    pthread_mutex_lock(&job.lock);
+    slot->done = 0;
+    job.written++;
+    pthread_cond_broadcast(&job.cond);
+    pthread_mutex_unlock(&job.lock);
+  }
+
+  if (job.arrow){
+    batch_flush(&batch, out);
+    if (arrow_write_end(out) != 0){
+      perror("almanac");
+      return 1;
+    }
+    free(batch.site);
+    free(batch.date);
+    free(batch.status);
+  }
+
+  for (i = 0; i < started; i++)
+    pthread_join(threads[i], NULL);
+  for (i = 0; i < job.nslots; i++){
+    free(job.slots[i].buf);
+    free(job.slots[i].vals);
+  }
+  free(job.slots);
+  free(threads);
+  free((void *)job.sites);
+  tzif_free(zone);
+  /* stdout too: a full disk or /dev/full shows only here */
+  if (fflush(out) != 0 || ferror(out) ||
+      (out != stdout && fclose(out) != 0)){
+    perror("almanac");
+    return 1;
+  }
+  return 0;
+}
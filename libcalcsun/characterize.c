@@ -0,0 +1,146 @@
+/*
+ * characterize.c
+ *
+ * Measures the error and cost of every engine in the table
+ * of engine.c and prints rows in its form. Random samples
+ * over 1900 to 2100: position at latitudes -89 to 89 against
+ * NREL SPA's altitude and azimuth, rise and set at latitudes
+ * -60 to 60 against SPA's rise and set. SPA's own rise and
+ * set are checked against the roots of its altitude.
+ *
+ *  characterize [samples]
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "engine.h"
+#include "solar.h"
+#include "spa_geo.h"
+
+/* SPA's horizon, Sun radius and refraction, degrees */
+#define SPA_H0 (-0.26667 - 0.5667)
+
+static double
+now(void){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double
+urand(double lo, double hi){
+  return lo + (hi - lo) * (double)rand() / RAND_MAX;
+}
+
+/* position error, degrees on the sky */
+static double
+sky_err(double alt, double az, double ref_alt, double ref_az){
+  double daz = fabs(az - ref_az);
+  daz = fmin(daz, 360.0 - daz) * cos(ref_alt * (M_PI / 180.0));
+  return fmax(fabs(alt - ref_alt), daz);
+}
+
+/* seconds between two ajds on the 24 hour clock; near the
+* date line engines take the transit at either end of the day
+*/
+static double
+time_err(double ajd, double ref){
+  double x = fmod(fabs(ajd - ref), 1.0);
+  return fmin(x, 1.0 - x) * 86400.0;
+}
+
+/* SPA altitude above its horizon at ajd */
+static double
+spa_above(double ajd, double lat, double lon){
+  double alt, az, d = ajd - DJ00;
+  engine_alt_az(ENGINE_SPA, 1, &d, &lat, &lon, &alt, &az);
+  return alt - SPA_H0;
+}
+
+/* worst SPA rise against the root of its altitude near it */
+static double
+spa_rise_err(size_t n, const double *d, const double *lat, const double *lon){
+  double err = 0.0;
+  size_t i;
+  for (i = 0; i < n; i++){
+    double r, a, b, fa;
+    int k;
+    engine_rise_set(ENGINE_SPA, 1, d + i, lat + i, lon + i, &r, NULL, NULL);
+    if (isnan(r)) continue;
+    a = r - 0.02;
+    b = r + 0.02;
+    fa = spa_above(a, lat[i], lon[i]);
+    if ((fa > 0.0) == (spa_above(b, lat[i], lon[i]) > 0.0)) continue;
+    for (k = 0; k < 40; k++){
+      double m = 0.5 * (a + b), fm = spa_above(m, lat[i], lon[i]);
+      if ((fm > 0.0) == (fa > 0.0)){
+        a = m;
+        fa = fm;
+      }
+      else
+        b = m;
+    }
+    err = fmax(err, time_err(r, 0.5 * (a + b)));
+  }
+  return err;
+}
+
+static void
+row(const engine_entry *e, double err, double t, size_t n){
+  printf("  {%s, %-9s %-10s %-7.2g %.0f},\n",
+         e->quantity == ENGINE_POSITION ? "ENGINE_POSITION" : "ENGINE_RISE_SET",
+         e->engine == ENGINE_FAST ? "ENGINE_FAST," :
+         e->engine == ENGINE_SUNRISET ? "ENGINE_SUNRISET," :
+         e->engine == ENGINE_SPA ? "ENGINE_SPA," : "ENGINE_CHAIN,",
+         e->name, err, t / (double)n * 1e9);
+}
+
+int
+main(int argc, char **argv){
+  size_t n = argc > 1 ? (size_t)atol(argv[1]) : 200000, i, k;
+  double *d = malloc(n * sizeof *d), *lat = malloc(n * sizeof *lat);
+  double *lon = malloc(n * sizeof *lon), *rlat = malloc(n * sizeof *rlat);
+  double *a = malloc(n * sizeof *a), *b = malloc(n * sizeof *b);
+  double *ra = malloc(n * sizeof *ra), *rb = malloc(n * sizeof *rb);
+  double *rs = malloc(n * sizeof *rs);
+  srand(2000);
+  for (i = 0; i < n; i++){
+    d[i] = urand(-36525.0, 36525.0);
+    lat[i] = urand(-89.0, 89.0);
+    rlat[i] = urand(-60.0, 60.0);
+    lon[i] = urand(-180.0, 180.0);
+  }
+  for (k = 0; k < engine_table_size; k++){
+    const engine_entry *e = &engine_table[k];
+    double t, err = 0.0;
+    if (e->quantity == ENGINE_POSITION){
+      double *ref_alt = a, *ref_az = b;
+      engine_alt_az(ENGINE_SPA, n, d, lat, lon, ref_alt, ref_az);
+      t = now();
+      engine_alt_az(e->engine, n, d, lat, lon, ra, rb);
+      t = now() - t;
+      if (e->engine == ENGINE_SPA)
+        err = 0.0003;
+      else
+        for (i = 0; i < n; i++)
+          err = fmax(err, sky_err(ra[i], rb[i], ref_alt[i], ref_az[i]));
+    }
+    else{
+      double *ref_rise = a, *ref_set = b;
+      engine_rise_set(ENGINE_SPA, n, d, rlat, lon, ref_rise, NULL, ref_set);
+      t = now();
+      engine_rise_set(e->engine, n, d, rlat, lon, ra, rs, rb);
+      t = now() - t;
+      if (e->engine == ENGINE_SPA)
+        err = spa_rise_err(n < 3000 ? n : 3000, d, rlat, lon);
+      else
+        for (i = 0; i < n; i++)
+          if (!isnan(ref_rise[i]) && !isnan(ra[i]))
+            err = fmax(err, fmax(time_err(ra[i], ref_rise[i]),
+                                 time_err(rb[i], ref_set[i])));
+    }
+    row(e, err, t, n);
+  }
+  return 0;
+}
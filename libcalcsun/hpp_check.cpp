@@ -0,0 +1,22 @@
+/*
+ * hpp_check.cpp
+ *
+ * Instantiates every member of the calc_sun.hpp templates
+ * the header documents, so that one not compiling for a
+ * scalar type fails the build. Compile only:
+ *   make hpp_check
+ */
+#include "calc_sun.hpp"
+
+using namespace calc_sun;
+
+template struct calc_sun::chain<double, raw>;
+template struct calc_sun::chain<double, legacy>;
+template struct calc_sun::chain<float, raw>;
+template struct calc_sun::chain<float, legacy>;
+template struct calc_sun::chain<pack<double, 4>, raw>;
+template struct calc_sun::chain<pack<float, 8>, raw>;
+template struct calc_sun::sun<simple, double>;
+template struct calc_sun::sun<simple, float>;
+template struct calc_sun::sun<simple, pack<double, 4> >;
+template struct calc_sun::sun<spa, double>;
@@ -0,0 +1,146 @@
+/*
+ * trig_check.c
+ *
+ * Proves the error bounds listed in fast_trig.h against libm.
+ * The single precision tier is swept over every float in its
+ * range, the double tier densely and at its reduction edges.
+ * Exits non zero when a bound is broken.
+ *
+ *  trig_check [-q]   -q checks every 257th float instead, and
+ *                    a fiftieth of the double samples
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fast_trig.h"
+
+static int failed;
+
+static void
+report(const char *name, double err, double bound){
+  int ok = err < bound;
+  printf("%-12s max error %.3g  bound %.0e  %s\n", name, err, bound,
+         ok ? "ok" : "FAIL");
+  fflush(stdout);
+  if (!ok) failed = 1;
+}
+
+/*
+ * the float of bits u; stepping u by 1 from 0 walks every
+ * non negative float upward
+ */
+static float
+f_of(uint32_t u){
+  float x;
+  memcpy(&x, &u, sizeof x);
+  return x;
+}
+
+static uint32_t
+bits_of(float x){
+  uint32_t u;
+  memcpy(&u, &x, sizeof u);
+  return u;
+}
+
+/* every stride-th float, each with both signs */
+static void
+check_f32(uint32_t stride){
+  double es = 0, ea = 0, et = 0;
+  uint32_t u, lim = bits_of((float)(8.0 * M_PI)), one = bits_of(1.0f);
+  for (u = 0; u < lim; u += stride){
+    float s, c, x = f_of(u);
+    ft_sincosf(x, &s, &c);
+    es = fmax(es, fmax(fabs(s - sin((double)x)), fabs(c - cos((double)x))));
+    ft_sincosf(-x, &s, &c);
+    es = fmax(es, fmax(fabs(s + sin((double)x)), fabs(c - cos((double)x))));
+  }
+  report("ft_sincosf", es, 1e-6);
+  for (u = 0; u <= one; u += stride){
+    float x = f_of(u);
+    ea = fmax(ea, fabs(ft_asinf(x) - asin((double)x)));
+    ea = fmax(ea, fabs(ft_asinf(-x) + asin((double)x)));
+  }
+  report("ft_asinf", ea, 2e-6);
+  /* atan2 depends on y / x alone, every ratio in [0, 1] in all
+  * octants covers it
+  */
+  for (u = 0; u <= one; u += stride){
+    float x = f_of(u);
+    et = fmax(et, fabs(ft_atan2f(x, 1.0f) - atan2((double)x, 1.0)));
+    et = fmax(et, fabs(ft_atan2f(1.0f, -x) - atan2(1.0, -(double)x)));
+    et = fmax(et, fabs(ft_atan2f(-1.0f, -x) - atan2(-1.0, -(double)x)));
+    et = fmax(et, fabs(ft_atan2f(-x, 1.0f) - atan2(-(double)x, 1.0)));
+  }
+  report("ft_atan2f", et, 2e-6);
+}
+
+static void
+check_f64(long n){
+  double es = 0, ed = 0, ea = 0, eas = 0, eac = 0, ep = 0;
+  long i, k;
+  for (i = 0; i < n; i++){
+    double u = (double)i / (double)n, s, c, x;
+    /* dense over the kernel range, then spread to 2^20 */
+    x = (u * 2.0 - 1.0) * 8.0 * M_PI;
+    ft_sincos(x, &s, &c);
+    es = fmax(es, fmax(fabs(s - sin(x)), fabs(c - cos(x))));
+    x = (u * 2.0 - 1.0) * 1048576.0;
+    ft_sincos(x, &s, &c);
+    es = fmax(es, fmax(fabs(s - sin(x)), fabs(c - cos(x))));
+    x = (u * 2.0 - 1.0) * 1099511627776.0;
+    ft_sincosd(x, &s, &c);
+    ed = fmax(ed, fmax(fabs(s - sin(fmod(x, 360.0) * (M_PI / 180.0))),
+                       fabs(c - cos(fmod(x, 360.0) * (M_PI / 180.0)))));
+    x = (u * 2.0 - 1.0) * 720.0;
+    ft_sincosd(x, &s, &c);
+    ed = fmax(ed, fmax(fabs(s - sin(x * (M_PI / 180.0))),
+                       fabs(c - cos(x * (M_PI / 180.0)))));
+    x = u * 2.0 - 1.0;
+    eas = fmax(eas, fabs(ft_asin(x) - asin(x)));
+    eac = fmax(eac, fabs(ft_acos(x) - acos(x)));
+    ea = fmax(ea, fabs(ft_atan2(u, 1.0) - atan2(u, 1.0)));
+    ea = fmax(ea, fabs(ft_atan2(1.0, -u) - atan2(1.0, -u)));
+    ea = fmax(ea, fabs(ft_atan2(-u, -1.0) - atan2(-u, -1.0)));
+    x = (u * 2.0 - 1.0) * 1e4;
+    ep = fmax(ep, fabs(ft_anp(x) - (fmod(x, 2 * M_PI) + (x < 0 ? 2 * M_PI : 0))) /
+                  fmax(fabs(x), 1.0));
+  }
+  /* the edges: quadrant boundaries and the atan shift point */
+  for (k = -4096; k <= 4096; k++){
+    double b = k * M_PI_4, s, c;
+    int j;
+    for (j = -64; j <= 64; j++){
+      double x = b + j * 1e-12 * fmax(fabs(b), 1.0);
+      ft_sincos(x, &s, &c);
+      es = fmax(es, fmax(fabs(s - sin(x)), fabs(c - cos(x))));
+      x = k * 45.0 + j * 1e-9;
+      ft_sincosd(x, &s, &c);
+      ed = fmax(ed, fmax(fabs(s - sin(x * (M_PI / 180.0))),
+                         fabs(c - cos(x * (M_PI / 180.0)))));
+    }
+  }
+  for (i = -100000; i <= 100000; i++){
+    double a = 0.26794919243112270 + i * 1e-12;
+    ea = fmax(ea, fabs(ft_atan2(a, 1.0) - atan(a)));
+    a = 1.0 - (i + 100000) * 1e-16;
+    eas = fmax(eas, fabs(ft_asin(a) - asin(a)));
+    eac = fmax(eac, fabs(ft_acos(a) - acos(a)));
+  }
+  report("ft_sincos", es, 1e-9);
+  report("ft_sincosd", ed, 1e-9);
+  report("ft_atan2", ea, 1e-9);
+  report("ft_asin", eas, 1e-9);
+  report("ft_acos", eac, 1e-9);
+  report("ft_anp", ep, 1e-15);
+}
+
+int
+main(int argc, char **argv){
+  int quick = argc > 1 && strcmp(argv[1], "-q") == 0;
+  check_f32(quick ? 257 : 1);
+  check_f64(quick ? 1000000 : 50000000);
+  return failed;
+}
@@ -0,0 +1,78 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+
+require 'date'
+# doc
+class TestParseAjd < Test::Unit::TestCase # MiniTest::Test
+  def setup
+    @t = CalcSun.new
+    @time = Time.new(2003, 10, 17, 12, 30, 30, '-07:00').getgm.to_datetime
+    @ajd = @time.ajd.to_f # 2_452_930.312847222
+  end
+
+  def test_extended
+    assert_in_delta(
+      @ajd,
+      @t.parse_ajd('2003-10-17T12:30:30-07:00'),
+      1e-9
+    )
+  end
+
+  def test_utc
+    assert_in_delta(
+      @ajd,
+      @t.parse_ajd('2003-10-17 19:30:30Z'),
+      1e-9
+    )
+  end
+
+  def test_basic
+    assert_in_delta(
+      DateTime.parse('20010203T040506+0700').ajd.to_f,
+      @t.parse_ajd('20010203T040506+0700'),
+      1e-9
+    )
+  end
+
+  def test_date_only
+    assert_equal(
+      Date.parse('2003-10-17').ajd.to_f,
+      @t.parse_ajd('2003-10-17')
+    )
+  end
+
+  def test_fraction
+    assert_in_delta(
+      @ajd + 0.25 / 86_400.0,
+      @t.parse_ajd('2003-10-17T19:30:30.25+00:00'),
+      1e-9
+    )
+  end
+
+  def test_invalid
+    assert_raise(ArgumentError) { @t.parse_ajd('2003-02-29') }
+    assert_raise(ArgumentError) { @t.parse_ajd('2003-10-17T25:00') }
+    assert_raise(ArgumentError) { @t.parse_ajd('2001-02-03T04:') }
+    assert_raise(ArgumentError) { @t.parse_ajd('2001-02-03T04:05:') }
+    assert_raise(ArgumentError) { @t.parse_ajd('2001-02-03T04:Z') }
+    assert_raise(ArgumentError) { @t.parse_ajd('3rd Feb 2001') }
+  end
+
+  def test_lines
+    ajds = @t.parse_ajd_lines(
+      "2003-10-17T12:30:30-07:00\r\n\n20010203T040506+0700\nbogus\n"
+    )
+    assert_equal(3, ajds.size)
+    assert_in_delta(@ajd, ajds[0], 1e-9)
+    assert_in_delta(
+      DateTime.parse('20010203T040506+0700').ajd.to_f, ajds[1], 1e-9
+    )
+    assert_nil(ajds[2])
+  end
+end
@@ -0,0 +1,202 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+require 'tmpdir'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+
+# reads back the flat streams CalcSun writes: schema, record
+# batches of fixed width columns, end of stream
+class ArrowStream
+  attr_reader :batches
+
+  def initialize(bytes)
+    @bytes = bytes
+    @batches = []
+    pos = 0
+    loop do
+      cont, len = @bytes.unpack("@#{pos}l<l<")
+      raise 'no continuation marker' unless cont == -1
+      break if len.zero?
+
+      meta = pos + 8
+      body = meta + len
+      pos = body + read_message(meta, body)
+    end
+    raise 'bytes past the end' unless pos + 8 == @bytes.bytesize
+  end
+
+  private
+
+  def u32(at)
+    @bytes.unpack1("@#{at}L<")
+  end
+
+  def i64(at)
+    @bytes.unpack1("@#{at}q<")
+  end
+
+  # position of field id of the table at t, nil when absent
+  def field(t, id)
+    vt = t - @bytes.unpack1("@#{t}l<")
+    return nil if 4 + 2 * id >= @bytes.unpack1("@#{vt}S<")
+
+    off = @bytes.unpack1("@#{vt + 4 + 2 * id}S<")
+    off.zero? ? nil : t + off
+  end
+
+  def deref(at)
+    at + u32(at)
+  end
+
+  def read_message(meta, body)
+    msg = deref(meta)
+    body_len = i64(field(msg, 3)) if field(msg, 3)
+    return 0 unless @bytes.getbyte(field(msg, 1)) == 3
+
+    batch = deref(field(msg, 2))
+    nodes = deref(field(batch, 1))
+    bufs = deref(field(batch, 2))
+    @batches << {
+      length: i64(field(batch, 0)),
+      nodes: Array.new(u32(nodes)) { |i| [i64(nodes + 4 + 16 * i), i64(nodes + 12 + 16 * i)] },
+      buffers: Array.new(u32(bufs)) do |i|
+        @bytes.byteslice(body + i64(bufs + 4 + 16 * i), i64(bufs + 12 + 16 * i))
+      end
+    }
+    body_len
+  end
+end
+
+# doc
+class TestArrow < Test::Unit::TestCase # MiniTest::Test
+  def setup
+    @t = CalcSun.new(:raw)
+    @dir = Dir.mktmpdir
+  end
+
+  def teardown
+    FileUtils.remove_entry(@dir)
+  end
+
+  def test_alt_az_arrow
+    path = File.join(@dir, 'pos.arrow')
+    ajd = 2_452_930.0
+    assert_equal(100, @t.alt_az_arrow(path, ajd, 1.0 / 24, 100, 39.74, -105.18, 0.05, 30))
+    s = ArrowStream.new(File.binread(path))
+    assert_equal([30, 30, 30, 10], s.batches.map { |b| b[:length] })
+    alts, azs = @t.alt_az_within((0...100).map { |i| ajd + i / 24.0 }, 39.74, -105.18, 0.05)
+    times = s.batches.flat_map { |b| b[:buffers][1].unpack('q<*') }
+    got_alts = s.batches.flat_map { |b| b[:buffers][3].unpack('E*') }
+    got_azs = s.batches.flat_map { |b| b[:buffers][5].unpack('E*') }
+    status = s.batches.flat_map { |b| b[:buffers][7].unpack('c*') }
+    assert_equal(((ajd - 2_440_587.5) * 86_400_000).round, times[0])
+    assert_equal(3_600_000, times[1] - times[0])
+    alts.each_index do |i|
+      assert_in_delta(alts[i], got_alts[i], 1e-6)
+      assert_in_delta(azs[i], got_azs[i], 1e-6)
+    end
+    alts.each_with_index do |alt, i|
+      want = [-0.8333, -6, -12, -18].index { |a| alt >= a } || 4
+      assert_equal(want, status[i])
+    end
+  end
+
+  def test_rise_set_arrow
+    path = File.join(@dir, 'days.arrow')
+    first = 2_457_540 # 2016-05-31
+    assert_equal(40, @t.rise_set_arrow(path, first...first + 40, 78.2, 15.6, 200))
+    s = ArrowStream.new(File.binread(path))
+    b = s.batches.first
+    assert_equal(1, s.batches.size)
+    assert_equal(first - 2_440_588, b[:buffers][1].unpack1('l<'))
+    rises = @t.rise_set_within((0...40).map { |i| first + i }, 78.2, 15.6, 200)[0]
+    nulls = rises.count(&:nil?)
+    assert_operator(nulls, :>, 0)
+    assert_equal([40, nulls], b[:nodes][1])
+    status = b[:buffers][-1].unpack('c*')
+    assert_equal(rises.map { |r| r ? 0 : 1 }, status)
+    valid = b[:buffers][2].unpack1('b*')
+    assert_equal(rises.map { |r| r ? '1' : '0' }.join, valid[0, 40])
+  end
+
+  def test_rise_set_arrow_polar_night
+    path = File.join(@dir, 'night.arrow')
+    first = 2_460_311 # 2024-01-01, polar night at Tromso
+    @t.rise_set_arrow(path, first...first + 20, 69.6, 18.9, 200)
+    b = ArrowStream.new(File.binread(path)).batches.first
+    status = b[:buffers][-1].unpack('c*')
+    rises = @t.rise_set_within((0...20).map { |i| first + i }, 69.6, 18.9, 200)[0]
+    assert_equal(rises.map { |r| r ? 0 : 2 }, status)
+    assert_includes(status, 2)
+  end
+
+  # the Sun transits on days it stays down, under SPA as under
+  # the chain
+  def test_rise_set_arrow_polar_transit
+    first = 2_460_311 # 2024-01-01, polar night at Tromso
+    days = [10, 200].map do |seconds|
+      path = File.join(@dir, "transit#{seconds}.arrow")
+      @t.rise_set_arrow(path, first...first + 20, 69.6, 18.9, seconds)
+      ArrowStream.new(File.binread(path)).batches.first
+    end
+    days.each { |b| assert_includes(b[:buffers][-1].unpack('c*'), 2) }
+    days.each { |b| assert_equal([20, 0], b[:nodes][2]) }
+    spa, chain = days.map { |b| b[:buffers][5].unpack('q<*') }
+    spa.zip(chain) { |a, b| assert_in_delta(b, a, 60_000) }
+  end
+
+  # almanac -a stamps each event with its own instant, which at
+  # far east rises and far west sets lies on the UT date before
+  # or after, the same instants rise_set_arrow writes
+  def test_almanac_matches_rise_set_arrow
+    almanac = File.expand_path('../../../libcalcsun/almanac', __FILE__)
+    omit('libcalcsun almanac not built') unless File.executable?(almanac)
+    sites = [['sydney', -33.9, 151.2], ['honolulu', 21.3, -157.8]]
+    list = File.join(@dir, 'sites')
+    File.write(list, sites.map { |s| s.join(' ') + "\n" }.join)
+    path = File.join(@dir, 'almanac.arrow')
+    assert(system(almanac, '-a', '-o', path, list, '2024-01-01', '2024-01-10'))
+    b = ArrowStream.new(File.binread(path)).batches.first
+    # site takes validity, offsets and data, then two per column
+    events = [6, 8, 10].map { |i| b[:buffers][i].unpack('q<20') }
+    first = 2_460_311 # 2024-01-01
+    sites.each_with_index do |(_, lat, lon), k|
+      one = File.join(@dir, "site#{k}.arrow")
+      @t.rise_set_arrow(one, first..first + 9, lat, lon, 200)
+      c = ArrowStream.new(File.binread(one)).batches.first
+      [3, 5, 7].each_with_index do |i, e|
+        assert_equal(c[:buffers][i].unpack('q<10'), events[e][10 * k, 10])
+      end
+    end
+  end
+
+  def test_trapped_signal_goes_on
+    omit('no SIGUSR1') unless Signal.list.key?('USR1')
+    path = File.join(@dir, 'days.arrow')
+    days = 2_457_540...2_457_540 + 20_000
+    @t.rise_set_arrow(path, days, 51.5, -0.1, 30, 100)
+    want = File.binread(path)
+    old = trap('USR1') {}
+    done = false
+    kill = Thread.new { (Process.kill('USR1', Process.pid); sleep 0.002) until done }
+    assert_equal(20_000, @t.rise_set_arrow(path, days, 51.5, -0.1, 30, 100))
+    assert_equal(want, File.binread(path))
+  ensure
+    done = true
+    kill.join if kill
+    trap('USR1', old) if old
+  end
+
+  def test_errors
+    path = File.join(@dir, 'x.arrow')
+    assert_raise(ArgumentError) { @t.rise_set_arrow(path, 2_457_540..2_457_541, 0, 0, 1) }
+    assert_raise(ArgumentError) { @t.alt_az_arrow(path, 2_457_540, 1, 5, 0, 0, 5, 0) }
+    assert_raise(Errno::ENOENT) do
+      @t.alt_az_arrow(File.join(@dir, 'no', 'x.arrow'), 2_457_540, 1, 5, 0, 0, 5)
+    end
+  end
+end
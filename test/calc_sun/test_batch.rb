@@ -0,0 +1,112 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+begin
+  require 'numo/narray'
+rescue LoadError
+  nil
+end
+
+# doc
+class TestBatch < Test::Unit::TestCase # MiniTest::Test
+  def setup
+    @t = CalcSun.new(:raw)
+    @ajds = (0...40).map { |i| 2_452_930 + 0.37 * i }
+    @lats = (0...40).map { |i| -55.0 + 2.7 * i }
+    @lons = (0...40).map { |i| -180.0 + 9.0 * i }
+  end
+
+  def each_sample
+    @ajds.each_index { |i| yield @ajds[i], @lats[i], @lons[i], i }
+  end
+
+  def test_packed_strings
+    ajds = @ajds.pack('d*')
+    lats = @lats.pack('d*')
+    lons = @lons.pack('d*')
+    alts = @t.altitude_batch(ajds, lats, lons)
+    azs = @t.azimuth_batch(ajds, lats, lons)
+    decs = @t.declination_batch(ajds)
+    rts = @t.rise_set_batch(ajds, lats, lons)
+    assert_equal([1, 40], alts.shape)
+    assert_equal([3, 40], rts.shape)
+    each_sample do |ajd, lat, lon, i|
+      assert_equal(@t.altitude(ajd, lat, lon), alts[0, i])
+      assert_equal(@t.azimuth(ajd, lat, lon), azs[0, i])
+      assert_equal(@t.declination(ajd), decs[0, i])
+      assert_equal(@t.rise_jd(ajd, lat, lon), rts[0, i])
+      assert_equal(@t.noon_jd(ajd, lat, lon), rts[1, i])
+      assert_equal(@t.set_jd(ajd, lat, lon), rts[2, i])
+    end
+  end
+
+  def test_broadcast_and_mixed
+    lat = 39.742476
+    [@ajds.pack('d*'), @ajds].each do |ajds|
+      alts = @t.altitude_batch(ajds, lat, @lons)
+      each_sample do |ajd, _lat, lon, i|
+        assert_equal(@t.altitude(ajd, lat, lon), alts[0, i])
+      end
+    end
+    one = @t.altitude_batch([@ajds[3]].pack('d'), @lats, [@lons[3]])
+    assert_equal([1, 40], one.shape)
+    assert_equal(@t.altitude(@ajds[3], @lats[5], @lons[3]), one[0, 5])
+    assert_equal([1, 1], @t.declination_batch(@ajds[0]).shape)
+    assert_equal([1, 0], @t.declination_batch([]).shape)
+  end
+
+  def test_shared_strings
+    lats = @lats.pack('d*')
+    want = @t.altitude_batch(@ajds, @lats, @lats).to_a
+    assert_equal(want, @t.altitude_batch(@ajds, lats, lats).to_a)
+    assert_equal(want, @t.altitude_batch(@ajds, lats.freeze, lats).to_a)
+    # one column read by several threads at once
+    ajds = @ajds.pack('d*')
+    rts = @t.rise_set_batch(ajds, 51.5, -0.1).to_a
+    4.times.map do
+      Thread.new { 50.times.map { @t.rise_set_batch(ajds, 51.5, -0.1).to_a } }
+    end.each { |th| th.value.each { |r| assert_equal(rts, r) } }
+  end
+
+  def test_rounding_follows_precision
+    t = CalcSun.new(:round12)
+    decs = t.declination_batch(@ajds.pack('d*'))
+    @ajds.each_with_index { |ajd, i| assert_equal(t.declination(ajd), decs[0, i]) }
+  end
+
+  def test_memory_view_input
+    decs = @t.declination_batch(@ajds)
+    alts = @t.altitude_batch(@ajds, decs, @lons)
+    ref = @t.altitude_batch(@ajds, decs.to_a[0], @lons)
+    assert_equal(ref.to_a, alts.to_a)
+    err = assert_raise(ArgumentError) do
+      @t.altitude_batch(@ajds, @t.rise_set_batch(@ajds, 40.0, 0.0), 0.0)
+    end
+    assert_match(/more than one row/, err.message)
+  end
+
+  def test_numo
+    omit('numo-narray not installed') unless defined?(Numo::DFloat)
+    ajds = Numo::DFloat.cast(@ajds + @ajds)
+    strided = ajds[(0...80).step(2)]
+    alts = @t.altitude_batch(strided, Numo::DFloat.cast(@lats), @lons)
+    each_sample do |_ajd, lat, lon, i|
+      assert_equal(@t.altitude(@ajds[2 * i % 40], lat, lon), alts[0, i])
+    end
+  end
+
+  def test_errors
+    assert_raise(ArgumentError) { @t.declination_batch('x' * 12) }
+    assert_raise(ArgumentError) { @t.altitude_batch(@ajds, @lats[0, 5], 0.0) }
+    s = @ajds.pack('d*')
+    assert_raise(TypeError) { @t.altitude_batch(s, 40.0, :x) }
+    # the String is let go again after the raise
+    s << 'more'
+    assert_equal(@ajds.size * 8 + 4, s.bytesize)
+  end
+end
@@ -0,0 +1,60 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+begin
+  require 'fiddle'
+rescue LoadError
+  nil
+end
+
+# doc
+class TestBuffer < Test::Unit::TestCase # MiniTest::Test
+  def setup
+    @t = CalcSun.new(:raw)
+    @ajds = (0...50).map { |i| 2_452_930 + 0.37 * i }
+    @lats = (0...50).map { |i| -60.0 + 2.4 * i }
+    @lons = (0...50).map { |i| -180.0 + 7.2 * i }
+  end
+
+  def test_matches_arrays
+    [5.0, 0.05].each do |tol|
+      buf = @t.alt_az_buffer(@ajds, @lats, @lons, tol)
+      assert_equal([2, 50], buf.shape)
+      assert_equal(2 * 50 * 8, buf.bytesize)
+      assert_equal(@t.alt_az_within(@ajds, @lats, @lons, tol), buf.to_a)
+      assert_equal(buf.to_a[1][49], buf[1, -1])
+    end
+    buf = @t.rise_set_buffer(@ajds, @lats, 10.0, 300)
+    assert_equal([3, 50], buf.shape)
+    assert_equal(@t.rise_set_within(@ajds, @lats, 10.0, 300), buf.to_a)
+    assert_raise(IndexError) { buf[3, 0] }
+    assert_predicate(buf, :frozen?)
+  end
+
+  def test_polar_nan
+    buf = @t.rise_set_buffer([2_457_560.0], [80.0], [0.0], 300)
+    assert_true(buf[0, 0].nan?)
+    assert_equal([[nil], buf.to_a[1], [nil]], buf.to_a)
+  end
+
+  def test_memory_view
+    omit('no Fiddle::MemoryView') unless defined?(Fiddle::MemoryView)
+    buf = @t.alt_az_buffer(@ajds, @lats, @lons, 5.0)
+    Fiddle::MemoryView.export(buf) do |view|
+      assert_equal('d', view.format)
+      assert_equal(8, view.item_size)
+      assert_equal(2, view.ndim)
+      assert_equal([2, 50], view.shape)
+      assert_equal([50 * 8, 8], view.strides)
+      assert_true(view.readonly?)
+      assert_equal(buf[1, 7], view[1, 7])
+      azs = view.to_s.unpack('d*')[50, 50]
+      assert_equal(buf.to_a[1], azs)
+    end
+  end
+end
@@ -455,3 +455,103 @@ class TestSunTimes < Test::Unit::TestCase # MiniTest::Test
     )
   end
 end
+
+#
+class TestInputForms < Test::Unit::TestCase # MiniTest::Test
+  def setup
+    @t = CalcSun.new
+    @gm = Time.new(2003, 10, 17, 12, 30, 30, '-07:00').getgm
+    @time = @gm.to_datetime
+    @ajd = @time.ajd # 2_452_930.312847222
+    @lat = 39.742476
+    @lon = -105.1786
+  end
+
+  def test_time
+    assert_in_delta(@ajd.to_f, @t.ajd(@gm), 1e-9)
+    assert_equal(2_452_930.0, @t.jd(@gm))
+    assert_in_delta(
+      @t.altitude(@ajd, @lat, @lon),
+      @t.altitude(@gm, @lat, @lon),
+      1e-6
+    )
+  end
+
+  def test_datetime
+    assert_equal(
+      @t.declination(@ajd),
+      @t.declination(@time)
+    )
+  end
+
+  def test_epoch2jd
+    jd, fr = @t.epoch2jd(@gm.to_i)
+    assert_equal(2_452_930.0, jd)
+    assert_in_delta((@ajd - jd.to_i).to_f, fr, 1e-15)
+  end
+
+  def test_two_part
+    pair = @t.epoch2jd(@gm.to_i)
+    assert_in_delta(@ajd.to_f, @t.ajd(pair), 1e-9)
+    assert_equal(
+      @t.t_rise(@ajd, @lat, @lon),
+      @t.t_rise(pair, @lat, @lon)
+    )
+    assert_in_delta(
+      @t.azimuth(@ajd, @lat, @lon),
+      @t.azimuth(pair, @lat, @lon),
+      1e-6
+    )
+  end
+
+  def test_bad_pair
+    assert_raise(ArgumentError) { @t.mean_anomaly([1.0]) }
+  end
+end
+
+#
+class TestPrecision < Test::Unit::TestCase # MiniTest::Test
+  def setup
+    @t = CalcSun.new
+    @raw = CalcSun.new(:raw)
+    @r12 = CalcSun.new(:round12)
+    @time = Time.new(2003, 10, 17, 12, 30, 30, '-07:00').getgm.to_datetime
+    @ajd = @time.ajd # 2_452_930.312847222
+    @lat = 39.742476
+    @lon = -105.1786
+  end
+
+  def test_default
+    assert_equal(:legacy, @t.precision)
+    assert_equal(:raw, @raw.precision)
+  end
+
+  def test_setter
+    @t.precision = :raw
+    assert_equal(@raw.altitude(@ajd, @lat, @lon), @t.altitude(@ajd, @lat, @lon))
+    assert_raise(ArgumentError) { @t.precision = :bogus }
+    assert_raise(ArgumentError) { CalcSun.new(:bogus) }
+  end
+
+  def test_raw_close_to_legacy
+    assert_in_delta(
+      @t.mean_anomaly(@ajd), @raw.mean_anomaly(@ajd), 1e-5
+    )
+    assert_in_delta(
+      @t.altitude(@ajd, @lat, @lon), @raw.altitude(@ajd, @lat, @lon), 1e-4
+    )
+    assert_in_delta(
+      @t.set_jd(@ajd, @lat, @lon), @raw.set_jd(@ajd, @lat, @lon), 1e-6
+    )
+  end
+
+  def test_round12
+    %i[mean_anomaly declination eot gmst].each do |m|
+      assert_equal(
+        (@raw.send(m, @ajd) * 1e12).round / 1e12,
+        @r12.send(m, @ajd)
+      )
+    end
+    assert_equal(@raw.rise_jd(@ajd, @lat, @lon), @r12.rise_jd(@ajd, @lat, @lon))
+  end
+end
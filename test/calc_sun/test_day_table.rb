@@ -0,0 +1,50 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+
+# doc
+class TestDayTable < Test::Unit::TestCase # MiniTest::Test
+  def setup
+    @t = CalcSun.new(:raw)
+  end
+
+  def test_fills_on_first_touch
+    ajd = 2_451_545 + 300_000.5 # a day nothing else touches
+    before = CalcSun.day_table_size
+    rise = @t.rise_jd(ajd, 40.0, -105.0)
+    grown = CalcSun.day_table_size
+    assert_operator(grown, :>, before)
+    assert_equal(rise, @t.rise_jd(ajd + 0.25, 40.0, -105.0))
+    @t.set_jd(ajd + 1, 40.0, -105.0)
+    assert_equal(grown, CalcSun.day_table_size)
+  end
+
+  def test_outside_the_table
+    ajd = 2_451_545 + 600_000 # past the table, about 1640 years on
+    before = CalcSun.day_table_size
+    assert_in_delta(0.5, @t.noon_jd(ajd, 0.0, 0.0) - ajd + 0.5, 0.1)
+    assert_equal(before, CalcSun.day_table_size)
+  end
+
+  def test_whole_days
+    ajd = 2_451_545 + 10_000
+    @t.rise_jd(ajd, 0.0, 0.0)
+    assert_in_delta(@t.right_ascension(ajd + 1e-9), @t.right_ascension(ajd), 1e-9)
+    assert_in_delta(@t.declination(ajd + 1e-9), @t.declination(ajd), 1e-9)
+    assert_in_delta(@t.eot(ajd + 1e-9), @t.eot(ajd), 1e-9)
+  end
+
+  def test_threads_agree
+    ajds = (0...400).map { |i| 2_451_545 + 200_000 + i * 37 + 0.3 }
+    serial = ajds.map { |a| @t.set_jd(a, 51.5, -0.1) }
+    threads = (0...4).map do
+      Thread.new { CalcSun.new(:raw).rise_set_batch(ajds, 51.5, -0.1).to_a[2] }
+    end
+    threads.each { |th| assert_equal(serial, th.value) }
+  end
+end
@@ -0,0 +1,82 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+
+require 'date'
+require 'tempfile'
+# doc
+class TestDeltaT < Test::Unit::TestCase # MiniTest::Test
+  def setup
+    @t = CalcSun.new
+  end
+
+  def teardown
+    CalcSun.unload_iers
+  end
+
+  def ajd(y, m, d)
+    Date.new(y, m, d).ajd.to_f
+  end
+
+  # finals2000A fixed columns, UT1-UTC in 59-68
+  def finals_line(date, dut1)
+    mjd = date.jd - 2_400_001
+    format('%02d%02d%02d %8.2f I %9.6f%9.6f %9.6f%9.6f  I%10.7f',
+           date.year % 100, date.month, date.day, mjd,
+           0.1, 0.0, 0.3, 0.0, dut1)
+  end
+
+  def test_model
+    assert_in_delta(63.83, @t.delta_t(ajd(2000, 1, 1)), 0.01)
+    assert_in_delta(29.15, @t.delta_t(ajd(1950, 1, 1)), 0.01)
+    assert_in_delta(1574.2, @t.delta_t(ajd(1000, 1, 1)), 1.0)
+    assert_in_delta(120.0, @t.delta_t(ajd(1600, 1, 1)), 0.1)
+    # no step where the observed values meet the polynomials
+    assert_in_delta(@t.delta_t(ajd(2024, 12, 31)),
+                    @t.delta_t(ajd(2025, 1, 2)), 0.01)
+    assert_in_delta(@t.delta_t(ajd(1899, 12, 31)),
+                    @t.delta_t(ajd(1900, 1, 2)), 0.1)
+  end
+
+  def test_batch_and_input_forms
+    days = [ajd(1800, 6, 1), ajd(1975, 3, 1), ajd(2030, 1, 1)]
+    assert_equal(days.map { |d| @t.delta_t(d) }, @t.delta_t(days))
+    assert_equal(@t.delta_t(ajd(2003, 10, 17)),
+                 @t.delta_t(Time.utc(2003, 10, 17)))
+    assert_equal(0.0, @t.dut1(ajd(2017, 1, 1)))
+  end
+
+  def test_iers_file
+    first = Date.new(2016, 12, 29)
+    dut1 = [0.5937, 0.5928, 0.5920, -0.4088, -0.4097]
+    f = Tempfile.new('finals')
+    dut1.each_with_index { |v, i| f.puts(finals_line(first + i, v)) }
+    f.close
+    assert_equal(5, CalcSun.load_iers(f.path))
+    assert_in_delta(0.5928, @t.dut1(ajd(2016, 12, 30)), 1e-9)
+    assert_in_delta(-0.4088, @t.dut1(ajd(2017, 1, 1)), 1e-9)
+    # TT - UT1 = 32.184 + (TAI - UTC) - DUT1, smooth over the leap second
+    assert_in_delta(32.184 + 36 - 0.5920, @t.delta_t(ajd(2016, 12, 31)), 1e-9)
+    assert_in_delta(32.184 + 37 + 0.4088, @t.delta_t(ajd(2017, 1, 1)), 1e-9)
+    assert_in_delta(68.5924, @t.delta_t(ajd(2016, 12, 31) + 0.5), 1e-9)
+    CalcSun.unload_iers
+    assert_equal(0.0, @t.dut1(ajd(2016, 12, 30)))
+  ensure
+    f.unlink if f
+  end
+
+  def test_iers_errors
+    assert_raise(Errno::ENOENT) { CalcSun.load_iers('/nonexistent/finals') }
+    f = Tempfile.new('finals')
+    f.puts('not a finals file')
+    f.close
+    assert_raise(ArgumentError) { CalcSun.load_iers(f.path) }
+  ensure
+    f.unlink if f
+  end
+end
@@ -0,0 +1,91 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+
+# doc
+class TestEngine < Test::Unit::TestCase # MiniTest::Test
+  def setup
+    @t = CalcSun.new(:raw)
+    @lats = [39.742476, -33.9, 51.5, 0.0, -55.0, 60.0]
+    @lons = [-105.1786, 151.2, -0.1, 179.5, -68.3, 25.0]
+    @jd = 2_452_930 # 2003-10-17
+  end
+
+  # seconds apart on the 24 hour clock
+  def seconds_off(ajd, ref)
+    x = (ajd - ref).abs % 1
+    [x, 1 - x].min * 86_400
+  end
+
+  def test_engine_for
+    assert_equal(:fast, CalcSun.engine_for(:position, 5.0))
+    assert_equal(:sunriset, CalcSun.engine_for(:position, 0.05))
+    assert_equal(:spa, CalcSun.engine_for(:position, 0.001))
+    assert_equal(:sunriset, CalcSun.engine_for(:rise_set, 300))
+    assert_equal(:chain, CalcSun.engine_for(:rise_set, 200))
+    assert_equal(:spa, CalcSun.engine_for(:rise_set, 10))
+    assert_raise(ArgumentError) { CalcSun.engine_for(:position, 0.0001) }
+    assert_raise(ArgumentError) { CalcSun.engine_for(:rise_set, 1) }
+    assert_raise(ArgumentError) { CalcSun.engine_for(:altitude, 1) }
+    quantities = CalcSun.engines.map(&:first).uniq
+    assert_equal(%i[position rise_set], quantities)
+  end
+
+  def test_alt_az_within
+    ajds = @lats.each_index.map { |i| @jd + 0.37 * i }
+    ref_alts, ref_azs = @t.alt_az_within(ajds, @lats, @lons, 0.0003)
+    [5.0, 0.05, 0.001].each do |tol|
+      alts, azs = @t.alt_az_within(ajds, @lats, @lons, tol)
+      ajds.each_index do |i|
+        daz = (azs[i] - ref_azs[i]).abs
+        daz = [daz, 360 - daz].min * Math.cos(ref_alts[i] * Math::PI / 180)
+        assert_in_delta(ref_alts[i], alts[i], tol)
+        assert_operator(daz, :<=, tol)
+      end
+    end
+  end
+
+  def test_rise_set_within
+    ajds = @lats.each_index.map { |i| @jd + 40 * i }
+    [300, 200, 10].each do |tol|
+      rises, transits, sets = @t.rise_set_within(ajds, @lats, @lons, tol)
+      refs = @t.rise_set_within(ajds, @lats, @lons, 3)
+      ajds.each_index do |i|
+        assert_operator(seconds_off(rises[i], refs[0][i]), :<=, tol)
+        assert_operator(seconds_off(transits[i], refs[1][i]), :<=, tol)
+        assert_operator(seconds_off(sets[i], refs[2][i]), :<=, tol)
+        assert_operator(rises[i], :<, transits[i])
+        assert_operator(transits[i], :<, sets[i])
+      end
+    end
+  end
+
+  def test_rise_set_against_spa_rts
+    # SPA's table gives the hours of the UT date; sets after
+    # 0h UT, as in California, are solved again, not wrapped
+    ajds = (0...10).map { |i| @jd + 7 * i }
+    lat = 35.0
+    lon = -120.0
+    rises, transits, sets = @t.rise_set_within(ajds, lat, lon, 3)
+    ajds.each_with_index do |ajd, i|
+      r, t, s = @t.spa_rts_table(ajd, 1, lat, lon)[0]
+      assert_operator(s, :<, t)
+      assert_in_delta(r, (rises[i] - ajd + 0.5) * 24, 1e-6)
+      assert_in_delta(t, (transits[i] - ajd + 0.5) * 24, 1e-6)
+      assert_in_delta(s + 24, (sets[i] - ajd + 0.5) * 24, 180.0 / 3600)
+    end
+  end
+
+  def test_polar
+    ajd = 2_457_560.0 # 2016-06-20
+    [300, 10].each do |tol|
+      rises, _t, sets = @t.rise_set_within([ajd], [80.0], [0.0], tol)
+      assert_equal([[nil], [nil]], [rises, sets])
+    end
+  end
+end
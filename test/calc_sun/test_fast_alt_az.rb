@@ -0,0 +1,60 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+
+# doc
+class TestFastAltAz < Test::Unit::TestCase # MiniTest::Test
+  def setup
+    @t = CalcSun.new(:raw)
+    @ajds = (0...500).map { |i| 2_415_020.5 + i * 146.13 + i * 0.0417 }
+    @lats = (0...500).map { |i| -84.0 + (i * 37 % 169) }
+    @lons = (0...500).map { |i| -180.0 + (i * 53 % 360) }
+  end
+
+  def test_matches_double_chain
+    alts, azs = @t.fast_alt_az(@ajds, @lats, @lons)
+    assert_equal(@ajds.size, alts.size)
+    assert_equal(@ajds.size, azs.size)
+    @ajds.each_with_index do |ajd, i|
+      alt = @t.altitude(ajd, @lats[i], @lons[i])
+      assert_in_delta(alt, alts[i], 0.0003)
+      next if alt.abs > 85.0
+      az = @t.azimuth(ajd, @lats[i], @lons[i])
+      daz = (az - azs[i]).abs
+      assert_operator([daz, 360.0 - daz].min, :<, 0.0015)
+    end
+  end
+
+  def test_double_tiers
+    [[1e-9, 3e-8, 5e-7], [:full, 2e-9, 1e-7]].each do |tier, dalt, daz|
+      alts, azs = @t.fast_alt_az(@ajds, @lats, @lons, tier)
+      @ajds.each_with_index do |ajd, i|
+        alt = @t.altitude(ajd, @lats[i], @lons[i])
+        assert_in_delta(alt, alts[i], dalt)
+        next if alt.abs > 85.0
+        d = (@t.azimuth(ajd, @lats[i], @lons[i]) - azs[i]).abs
+        assert_operator([d, 360.0 - d].min, :<, daz)
+      end
+    end
+    assert_equal(@t.fast_alt_az(@ajds, @lats, @lons, :full),
+                 @t.fast_alt_az(@ajds, @lats, @lons, 1e-12))
+    assert_raise(ArgumentError) { @t.fast_alt_az(@ajds, 0.0, 0.0, 0) }
+  end
+
+  def test_scalar_lat_lon
+    alts, azs = @t.fast_alt_az(@ajds, 41.95, -88.75)
+    alts2, azs2 = @t.fast_alt_az(@ajds, [41.95] * 500, [-88.75] * 500)
+    assert_equal(alts2, alts)
+    assert_equal(azs2, azs)
+  end
+
+  def test_length_mismatch
+    assert_raise(ArgumentError) { @t.fast_alt_az(@ajds, [0.0], 0.0) }
+    assert_equal([[], []], @t.fast_alt_az([], 0.0, 0.0))
+  end
+end
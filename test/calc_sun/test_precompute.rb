@@ -0,0 +1,98 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+
+# doc
+class TestPrecompute < Test::Unit::TestCase # MiniTest::Test
+  JD = 2_460_311 # 2024-01-01
+
+  def setup
+    @sites = [[39.742476, -105.1786], [-33.9, 151.2], [69.6, 18.9],
+              [0.0, 179.5]]
+    @ref = CalcSun.new(:raw)
+  end
+
+  # NaN where the Sun does not rise or set
+  def assert_same_jd(expect, actual)
+    return assert_true(actual.nan?) if expect.nan?
+    assert_equal(expect, actual)
+  end
+
+  def test_matches_chain
+    cs = CalcSun.new(:raw)
+    pre = cs.precompute_async(@sites, JD..JD + 99, 2)
+    assert_instance_of(CalcSun::Precompute, pre)
+    # the first lookups wait for their slice only
+    @sites.each do |lat, lon|
+      [0, 40, 99].each do |k|
+        ajd = JD + k + 0.3
+        assert_same_jd(@ref.rise_jd(ajd, lat, lon), cs.rise_jd(ajd, lat, lon))
+        assert_same_jd(@ref.noon_jd(ajd, lat, lon), cs.noon_jd(ajd, lat, lon))
+        assert_same_jd(@ref.set_jd(ajd, lat, lon), cs.set_jd(ajd, lat, lon))
+      end
+    end
+    assert_same(pre, pre.wait)
+    assert_true(pre.ready?)
+    assert_equal(1.0, pre.progress)
+    lat, lon = @sites[0]
+    assert_equal(@ref.noon(JD + 5, lat, lon), cs.noon(JD + 5, lat, lon))
+  end
+
+  def test_misses_fall_back
+    cs = CalcSun.new(:raw)
+    cs.precompute_async(@sites, JD...JD + 10).wait
+    lat, lon = @sites[1]
+    # a day past the exclusive end, a site not given
+    assert_equal(@ref.rise_jd(JD + 10, lat, lon), cs.rise_jd(JD + 10, lat, lon))
+    assert_equal(@ref.rise_jd(JD, 10.0, 20.0), cs.rise_jd(JD, 10.0, 20.0))
+    # another precision does not read the table
+    cs.precision = :legacy
+    legacy = CalcSun.new(:legacy)
+    assert_equal(legacy.set_jd(JD + 3, lat, lon), cs.set_jd(JD + 3, lat, lon))
+  end
+
+  def test_arguments
+    cs = CalcSun.new(:raw)
+    assert_raise(TypeError) { cs.precompute_async(@sites, JD) }
+    assert_raise(ArgumentError) { cs.precompute_async(@sites, JD...JD) }
+    assert_raise(ArgumentError) { cs.precompute_async([[1.0]], JD..JD) }
+    assert_raise(ArgumentError) { cs.precompute_async([[1.0, 2.0]] * 1000, JD..JD + 1e15) }
+  end
+
+  def test_release
+    cs = CalcSun.new(:raw)
+    lat, lon = @sites[0]
+    pre = cs.precompute_async(@sites, JD..JD + 99)
+    kept = cs.precompute_async(@sites, JD + 100..JD + 199)
+    assert_nil(pre.release)
+    assert_nil(pre.release)
+    assert_equal([kept], cs.instance_variable_get(:@precomputed))
+    assert_raise(ArgumentError) { pre.ready? }
+    assert_raise(ArgumentError) { pre.wait }
+    assert_same_jd(@ref.rise_jd(JD + 3, lat, lon), cs.rise_jd(JD + 3, lat, lon))
+    assert_same_jd(@ref.rise_jd(JD + 103, lat, lon), cs.rise_jd(JD + 103, lat, lon))
+    assert_true(kept.wait.ready?)
+  end
+
+  def test_release_while_waited_on
+    cs = CalcSun.new(:raw)
+    pre = cs.precompute_async(@sites * 50, JD..JD + 365, 1)
+    waiter = Thread.new { pre.wait }
+    Thread.pass until waiter.status == 'sleep' || !waiter.alive?
+    pre.release
+    assert_same(pre, waiter.value)
+    assert_nil(cs.instance_variable_get(:@precomputed).first)
+  end
+
+  def test_wait_from_thread
+    cs = CalcSun.new(:raw)
+    pre = cs.precompute_async(@sites * 50, JD..JD + 365, 1)
+    waiter = Thread.new { pre.wait.ready? }
+    assert_true(waiter.value)
+  end
+end
@@ -0,0 +1,127 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+require 'tmpdir'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+
+# doc
+class TestProfileStore < Test::Unit::TestCase # MiniTest::Test
+  SITES = [[39.7425, -105.1786], [51.5, -0.1], [-33.9, 151.2], [78.2, 15.6],
+           [51.50001, -0.1]].freeze
+
+  def setup
+    @dir = Dir.mktmpdir('calc_sun')
+    @path = File.join(@dir, 'profiles.bin')
+    @t = CalcSun.new(:raw)
+    @jd = 2_460_311 # 2024-01-01
+    @range = @jd..@jd + 365
+  end
+
+  def teardown
+    FileUtils.remove_entry(@dir)
+  end
+
+  def test_write_and_read
+    assert_equal(4, @t.write_profiles(@path, SITES, @range, 1e-4, 2))
+    store = CalcSun::ProfileStore.new(@path)
+    assert_equal(4, store.size)
+    assert_equal(366, store.days)
+    assert_equal(@jd, store.first_ajd)
+    assert_equal(:raw, store.precision)
+    assert_equal(1e-4, store.quantum)
+    assert_equal(0o666 & ~File.umask, File.stat(@path).mode & 0o777)
+    assert_equal(SITES[0..3].sort, store.sites.map { |s| s.map { |v| v.round(4) } }.sort)
+    [0, 100, 365].each do |k|
+      ajd = @jd + k + 0.25
+      got = store.day(ajd, 39.7425, -105.1786)
+      rise = @t.rise_jd(ajd, 39.7425, -105.1786)
+      noon = @t.noon_jd(ajd, 39.7425, -105.1786)
+      assert_in_delta(rise, got[0], 1e-9)
+      assert_in_delta(noon, got[1], 1e-9)
+      assert_in_delta(@t.set_jd(ajd, 39.7425, -105.1786), got[2], 1e-9)
+      assert_in_delta(@t.daylight_time(ajd, 39.7425), got[3], 1e-6)
+      assert_in_delta(@t.altitude(noon, 39.7425, -105.1786), got[4], 1e-6)
+    end
+    assert_nil(store.day(@jd - 1, 39.7425, -105.1786))
+    assert_nil(store.day(@jd, 10.0, 10.0))
+  end
+
+  def test_polar_days
+    @t.write_profiles(@path, SITES, @range)
+    store = CalcSun::ProfileStore.new(@path)
+    night = store.day(@jd + 10, 78.2, 15.6)
+    day = store.day(@jd + 172, 78.2, 15.6)
+    assert_equal([nil, nil, 0.0], [night[0], night[2], night[3]])
+    assert_equal([nil, nil, 24.0], [day[0], day[2], day[3]])
+    assert_operator(night[4], :<, 0)
+  end
+
+  def test_polar_night_with_refraction_at_noon
+    # the centre of the Sun a little above -0.8333 at noon
+    # while the chain still finds no rise
+    @t.write_profiles(@path, [[69.65, 18.96]], @jd..@jd + 10)
+    day = CalcSun::ProfileStore.new(@path).day(@jd + 3, 69.65, 18.96)
+    assert_nil(day[0])
+    assert_operator(day[4], :>, -0.8333)
+    assert_equal(0.0, day[3])
+  end
+
+  def test_trapped_signal_goes_on
+    omit('no SIGUSR1') unless Signal.list.key?('USR1')
+    sites = (0...200).map { |i| [-60.0 + i * 0.6, i * 1.5] }
+    @t.write_profiles(@path, sites, @range, 1e-4, 2)
+    want = File.binread(@path)
+    old = trap('USR1') {}
+    done = false
+    kill = Thread.new { (Process.kill('USR1', Process.pid); sleep 0.002) until done }
+    assert_equal(200, @t.write_profiles(@path, sites, @range, 1e-4, 2))
+    assert_equal(want, File.binread(@path))
+    assert_equal([@path], Dir.glob(File.join(@dir, '*')))
+  ensure
+    done = true
+    kill.join if kill
+    trap('USR1', old) if old
+  end
+
+  def test_profile_buffer
+    @t.write_profiles(@path, SITES, @range)
+    store = CalcSun::ProfileStore.new(@path)
+    buf = store.profile(51.5, -0.1)
+    assert_equal([5, 366], buf.shape)
+    assert_equal(store.day(@jd + 40, 51.5, -0.1), buf.to_a.map { |r| r[40] })
+    assert_nil(store.profile(0.0, 0.0))
+  end
+
+  def test_read_through
+    @t.write_profiles(@path, SITES, @range)
+    store = CalcSun::ProfileStore.new(@path)
+    plain = CalcSun.new(:raw)
+    @t.profile_store = store
+    assert_same(store, @t.profile_store)
+    ajd = @jd + 200
+    assert_equal(store.day(ajd, -33.9, 151.2)[0], @t.rise_jd(ajd, -33.9, 151.2))
+    assert_in_delta(plain.set_jd(ajd, -33.9, 151.2), @t.set_jd(ajd, -33.9, 151.2), 1e-9)
+    buf = @t.rise_set_batch([ajd, ajd + 1], -33.9, 151.2)
+    assert_equal(store.day(ajd + 1, -33.9, 151.2)[1], buf[1, 1])
+    # outside the range, or of another precision: the chain
+    assert_equal(plain.rise_jd(@jd + 400, -33.9, 151.2), @t.rise_jd(@jd + 400, -33.9, 151.2))
+    legacy = CalcSun.new
+    legacy.profile_store = store
+    assert_equal(CalcSun.new.rise_jd(ajd, -33.9, 151.2), legacy.rise_jd(ajd, -33.9, 151.2))
+    @t.profile_store = nil
+    assert_nil(@t.profile_store)
+  end
+
+  def test_errors
+    assert_raise(ArgumentError) { @t.write_profiles(@path, SITES, @range, 0.0) }
+    assert_raise(ArgumentError) { @t.write_profiles(@path, [[1.0]], @range) }
+    assert_raise(Errno::ENOENT) { CalcSun::ProfileStore.new(@path) }
+    File.binwrite(@path, "\0" * 128)
+    assert_raise(ArgumentError) { CalcSun::ProfileStore.new(@path) }
+    assert_raise(TypeError) { @t.profile_store = Object.new }
+  end
+end
@@ -0,0 +1,76 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+require 'sidereal_time'
+require 'tempfile'
+
+# doc
+class TestRactor < Test::Unit::TestCase # MiniTest::Test
+  ZONEINFO = ENV['TZDIR'] || '/usr/share/zoneinfo'
+
+  def setup
+    omit('no Ractor') unless defined?(Ractor)
+    Warning[:experimental] = false
+    @lat = 39.742476
+    @lon = -105.1786
+    @ajd = 2_452_930.312847222
+  end
+
+  def test_methods_in_ractors
+    expect = CalcSun.new(:raw).altitude(@ajd, @lat, @lon)
+    ractors = (0...4).map do |i|
+      Ractor.new(@ajd, @lat, @lon, i) do |ajd, lat, lon, k|
+        sun = CalcSun.new(:raw)
+        alts, = sun.alt_az_within([ajd] * 8, lat, lon, 0.001)
+        [sun.altitude(ajd, lat, lon), alts.first, k]
+      end
+    end
+    ractors.each do |r|
+      alt, spa_alt, = r.take
+      assert_equal(expect, alt)
+      assert_in_delta(expect, spa_alt, 3.5)
+    end
+    lmst = Ractor.new(@ajd) { |ajd| SideTime.new.lmst(ajd, -105.1786) }
+    assert_equal(SideTime.new.lmst(@ajd, -105.1786), lmst.take)
+  end
+
+  def test_shared_surface
+    s = CalcSun::RiseSurface.new(2_460_311, 3, 1.0, 1.0)
+    assert_predicate(s, :frozen?)
+    assert_true(Ractor.shareable?(s))
+    expect = s.rise_set([2_460_312], 45.0, 10.0)
+    r = Ractor.new(s) { |t| t.rise_set([2_460_312], 45.0, 10.0) }
+    assert_equal(expect, r.take)
+  end
+
+  def test_shared_zone
+    omit('no zoneinfo') unless File.exist?(File.join(ZONEINFO, 'Europe/Oslo'))
+    oslo = CalcSun::Zone['Europe/Oslo']
+    assert_true(Ractor.shareable?(oslo))
+    r = Ractor.new { CalcSun::Zone['Europe/Oslo'] }
+    assert_same(oslo, r.take)
+  end
+
+  def test_iers_table_shared
+    f = Tempfile.new('finals')
+    (0...3).each do |i|
+      mjd = 57_750 + i
+      f.puts(format('170101 %8.2f I %9.6f%9.6f %9.6f%9.6f  I%10.7f',
+                    mjd, 0.1, 0.0, 0.3, 0.0, 0.59 - 0.001 * i))
+    end
+    f.close
+    CalcSun.load_iers(f.path)
+    ajd = 2_457_751.0
+    expect = CalcSun.new.dut1(ajd)
+    assert_not_equal(0.0, expect)
+    assert_equal(expect, Ractor.new(ajd) { |d| CalcSun.new.dut1(d) }.take)
+  ensure
+    CalcSun.unload_iers
+    f.unlink if f
+  end
+end
@@ -0,0 +1,57 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+
+require 'date'
+# doc
+class TestRiseSurface < Test::Unit::TestCase # MiniTest::Test
+  JD = Date.new(2024, 1, 1).jd
+
+  def setup
+    @t = CalcSun.new(:raw)
+    @s = CalcSun::RiseSurface.new(JD, 366, 0.5, 1.0)
+  end
+
+  def test_against_chain
+    rng = Random.new(11)
+    jds = Array.new(3000) { JD + rng.rand(366) }
+    lats = Array.new(3000) { rng.rand(-89.9..89.9) }
+    lons = Array.new(3000) { rng.rand(-180.0..180.0) }
+    rises, transits, sets = @s.rise_set(jds, lats, lons)
+    assert(@s.max_error <= 1.0)
+    jds.each_index do |i|
+      r = @t.rise_jd(jds[i], lats[i], lons[i])
+      assert_in_delta(@t.noon_jd(jds[i], lats[i], lons[i]), transits[i], 1e-9)
+      if r.nan?
+        assert_nil(rises[i])
+        assert_nil(sets[i])
+      else
+        assert_in_delta(r, rises[i], 1.001 / 86_400)
+        assert_in_delta(@t.set_jd(jds[i], lats[i], lons[i]), sets[i],
+                        1.001 / 86_400)
+      end
+    end
+  end
+
+  def test_polar_and_outside
+    assert(@s.flagged > 0)
+    # midsummer at Svalbard, and a day the surface does not hold
+    rises, transits, sets = @s.rise_set([JD + 172, JD + 400], [78.2, 60.2],
+                                        15.6)
+    assert_equal([nil, nil], [rises[0], sets[0]])
+    assert_in_delta(@t.noon_jd(JD + 172, 78.2, 15.6), transits[0], 1e-9)
+    assert_equal(@t.rise_jd(JD + 400, 60.2, 15.6), rises[1])
+  end
+
+  def test_arguments
+    assert_raise(ArgumentError) { CalcSun::RiseSurface.new(JD, 0) }
+    assert_raise(ArgumentError) { CalcSun::RiseSurface.new(JD, 1, 0) }
+    assert_raise(ArgumentError) { @s.rise_set([JD, JD], [1, 2, 3], 0) }
+    assert_equal([[], [], []], @s.rise_set([], 0, 0))
+  end
+end
@@ -0,0 +1,103 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+
+# doc
+class TestSharedCache < Test::Unit::TestCase # MiniTest::Test
+  def setup
+    @name = "/calc_sun_test_#{Process.pid}"
+    @cache = CalcSun::SharedCache.new(@name, 4096)
+    @t = CalcSun.new(:raw)
+    @plain = CalcSun.new(:raw)
+    @jd = 2_452_930 # 2003-10-17
+  end
+
+  def teardown
+    CalcSun::SharedCache.unlink(@name)
+  rescue Errno::ENOENT
+    nil
+  end
+
+  def test_values_of_grid_point
+    assert_equal(4096, @cache.slots)
+    assert_equal(1e-4, @cache.quantum)
+    @t.shared_cache = @cache
+    assert_same(@cache, @t.shared_cache)
+    assert_nil(@cache.cached(@jd, 39.7425, -105.1786, :raw))
+    rise = @t.rise_jd(@jd, 39.7425, -105.1786)
+    assert_equal(@plain.rise_jd(@jd, 39.7425, -105.1786), rise)
+    got = @cache.cached(@jd + 0.3, 39.74251, -105.17859, :raw)
+    assert_equal([rise, @t.noon_jd(@jd, 39.7425, -105.1786),
+                  @t.set_jd(@jd, 39.7425, -105.1786)], got)
+    assert_nil(@cache.cached(@jd, 39.7425, -105.1786, :legacy))
+    # off the grid: the grid point's values, within a second
+    assert_in_delta(@plain.set_jd(@jd, 39.74256, 0.0),
+                    @t.set_jd(@jd, 39.74256, 0.0), 1.0 / 86_400)
+    @t.shared_cache = nil
+    assert_nil(@t.shared_cache)
+  end
+
+  def test_rise_set_batch
+    @t.shared_cache = @cache
+    ajds = (0...20).map { |i| @jd + i }
+    buf = @t.rise_set_batch(ajds, 51.5, -0.1)
+    assert_equal(@plain.rise_set_batch(ajds, 51.5, -0.1).to_a, buf.to_a)
+    ajds.each { |ajd| assert_not_nil(@cache.cached(ajd, 51.5, -0.1, :raw)) }
+  end
+
+  def test_across_processes
+    omit('no fork') unless Process.respond_to?(:fork)
+    pid = fork do
+      t = CalcSun.new(:raw)
+      t.shared_cache = CalcSun::SharedCache.new(@name, 16)
+      t.noon_jd(@jd, -33.9, 151.2)
+      exit!(0)
+    end
+    Process.wait(pid)
+    assert_equal(0, $?.exitstatus)
+    other = CalcSun::SharedCache.new(@name, 16)
+    assert_equal(4096, other.slots)
+    assert_equal([@plain.rise_jd(@jd, -33.9, 151.2), @plain.noon_jd(@jd, -33.9, 151.2),
+                  @plain.set_jd(@jd, -33.9, 151.2)],
+                 other.cached(@jd, -33.9, 151.2, :raw))
+  end
+
+  def test_eviction
+    name = "#{@name}_small"
+    small = CalcSun::SharedCache.new(name, 8)
+    @t.shared_cache = small
+    (0...50).each do |i|
+      assert_equal(@plain.set_jd(@jd + i, 10.0, 20.0), @t.set_jd(@jd + i, 10.0, 20.0))
+    end
+    assert_not_nil(small.cached(@jd + 49, 10.0, 20.0, :raw))
+  ensure
+    CalcSun::SharedCache.unlink(name)
+  end
+
+  def test_off_the_grid
+    name = "#{@name}_fine"
+    fine = CalcSun::SharedCache.new(name, 16, 1e-7)
+    @t.shared_cache = fine
+    # 300 / 1e-7 is past int32_t: computed, never cached
+    assert_equal(@plain.rise_jd(@jd, 10.0, 300.0), @t.rise_jd(@jd, 10.0, 300.0))
+    assert_nil(fine.cached(@jd, 10.0, 300.0, :raw))
+    assert_nil(fine.cached(@jd, 10.0, 300.0 - 2**32 * 1e-7, :raw))
+    assert_nil(fine.cached(@jd, Float::NAN, 20.0, :raw))
+    assert_nil(fine.cached(1e10 + 2_451_545, 10.0, 20.0, :raw))
+  ensure
+    CalcSun::SharedCache.unlink(name)
+  end
+
+  def test_errors
+    assert_raise(ArgumentError) { CalcSun::SharedCache.new("#{@name}_q", 16, 0.0) }
+    assert_raise(ArgumentError) { CalcSun::SharedCache.new(@name, 0) }
+    assert_raise(TypeError) { @t.shared_cache = Object.new }
+    CalcSun::SharedCache.unlink(@name)
+    assert_raise(Errno::ENOENT) { CalcSun::SharedCache.unlink(@name) }
+  end
+end
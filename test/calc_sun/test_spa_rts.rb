@@ -0,0 +1,67 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+
+require 'date'
+# doc
+class TestSpaRts < Test::Unit::TestCase # MiniTest::Test
+  def setup
+    @t = CalcSun.new(:raw)
+    @lat = 39.742476
+    @lon = -105.1786
+  end
+
+  def hours(ajd)
+    (ajd + 0.5 - (ajd + 0.5).floor) * 24.0
+  end
+
+  def test_window_matches_single_days
+    jd = Date.new(2024, 1, 1).jd
+    table = @t.spa_rts_table(jd, 60, @lat, @lon)
+    assert_equal(60, table.size)
+    [0, 17, 59].each do |i|
+      single = @t.spa_rts_table(jd + i, 1, @lat, @lon)[0]
+      table[i].zip(single).each { |a, b| assert_in_delta(b, a, 1e-7) }
+    end
+  end
+
+  def test_near_chain
+    jd = Date.new(2003, 10, 17).jd
+    rise, transit, set = @t.spa_rts_table(jd, 1, @lat, @lon)[0]
+    # NREL's published example, 06:12:43 and 17:20:19 local (-7)
+    assert_in_delta(6.212067 + 7, rise, 1e-4)
+    assert_in_delta(17.338667 + 7 - 24, set, 1e-4)
+    assert_in_delta(hours(@t.noon_jd(jd, @lat, @lon)), transit, 0.02)
+    assert_in_delta(hours(@t.rise_jd(jd, @lat, @lon)), rise, 0.05)
+  end
+
+  def test_polar_and_delta_t
+    jd = Date.new(2024, 6, 21).jd
+    assert_equal([[nil, nil, nil]], @t.spa_rts_table(jd, 1, 78.2, 15.6))
+    auto = @t.spa_rts_table(jd, 1, @lat, @lon)[0]
+    fixed = @t.spa_rts_table(jd, 1, @lat, @lon, @t.delta_t(jd - 0.5))[0]
+    assert_equal(auto, fixed)
+    assert_raise(ArgumentError) { @t.spa_rts_table(jd, 1, 91, 0) }
+    assert_equal([], @t.spa_rts_table(jd, 0, @lat, @lon))
+  end
+
+  def test_spa_alt_az
+    ajd = DateTime.new(2003, 10, 17, 19, 30, 30).ajd.to_f
+    alts, azs = @t.spa_alt_az(ajd, [@lat], [@lon], [1830.14])
+    # NREL's example, e0 39.872048 under zenith 50.11162
+    assert_in_delta(39.872048, alts[0], 1e-4)
+    assert_in_delta(194.34024, azs[0], 1e-3)
+    lats = (-8..8).map { |i| i * 10.0 }
+    alts, azs = @t.spa_alt_az(ajd, lats, @lon)
+    assert_equal(17, alts.size)
+    one = @t.spa_alt_az(ajd, [lats[12]], [@lon], [0])
+    assert_equal([[alts[12]], [azs[12]]], one)
+    assert_in_delta(@t.altitude(ajd, lats[12], @lon), alts[12], 0.2)
+    assert_raise(ArgumentError) { @t.spa_alt_az(ajd, lats, [1, 2]) }
+  end
+end
@@ -0,0 +1,118 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+
+# doc
+class TestSunInverse < Test::Unit::TestCase # MiniTest::Test
+  SITES = [[51.5, -0.1], [69.6, 18.9], [-33.9, 151.2], [5.0, 100.0]].freeze
+
+  def setup
+    @t = CalcSun.new(:raw)
+    @jd = 2_460_494.5 # 2024-07-01 00:00 UT
+  end
+
+  def off(az, target)
+    (az - target + 540) % 360 - 180
+  end
+
+  def test_altitude_time
+    SITES.each do |lat, lon|
+      tr = @t.noon_jd(@jd, lat, lon)
+      up = @t.altitude_time(@jd, lat, lon, 10.0)
+      down = @t.altitude_time(@jd, lat, lon, 10.0, :setting)
+      assert_in_delta(10.0, @t.altitude(up, lat, lon), 1e-6)
+      assert_in_delta(10.0, @t.altitude(down, lat, lon), 1e-6)
+      assert_operator(@t.altitude(up + 1e-3, lat, lon), :>, 10.0)
+      assert_operator(@t.altitude(down + 1e-3, lat, lon), :<, 10.0)
+      assert_operator(up, :<, tr)
+      assert_operator(down, :>, tr)
+    end
+    # the span sun_intervals finds by sampling
+    tr = @t.noon_jd(@jd, 51.5, -0.1)
+    from, to = @t.sun_intervals([[51.5, -0.1]], tr - 0.5..tr + 0.5, 10.0)[0][0]
+    assert_in_delta(from, @t.altitude_time(@jd, 51.5, -0.1, 10.0), 1e-6)
+    assert_in_delta(to, @t.altitude_time(@jd, 51.5, -0.1, 10.0, :setting), 1e-6)
+  end
+
+  def test_altitude_not_reached
+    assert_nil(@t.altitude_time(@jd, 51.5, -0.1, 70.0))
+    # midnight Sun at Tromso, polar night half a year on
+    assert_nil(@t.altitude_time(@jd, 69.6, 18.9, -6.0, :setting))
+    assert_nil(@t.altitude_time(@jd + 183, 69.6, 18.9, 0.0))
+    assert_raise(ArgumentError) { @t.altitude_time(@jd, 51.5, -0.1, 0.0, :noon) }
+  end
+
+  def test_azimuth_time
+    SITES.each do |lat, lon|
+      tr = @t.noon_jd(@jd, lat, lon)
+      [45.0, 135.0, 200.0, 300.0].each do |az|
+        t = @t.azimuth_time(@jd, lat, lon, az)
+        # by sampling every 30 seconds through the day
+        xs = (0..2880).map { |i| tr - 0.5 + i / 2880.0 }
+        us = xs.map { |x| off(@t.azimuth(x, lat, lon), az) }
+        i = (0...2880).find { |k| (us[k] < 0) != (us[k + 1] < 0) && (us[k] - us[k + 1]).abs < 180 }
+        if i.nil?
+          assert_nil(t)
+        else
+          assert_in_delta(xs[i], t, 1.0 / 2880 + 1e-6)
+          assert_in_delta(0.0, off(@t.azimuth(t, lat, lon), az), 1e-5)
+        end
+      end
+    end
+  end
+
+  def test_azimuth_twice_in_the_tropics
+    # the Sun north of the zenith at 5 N swings out to 69.2
+    # in the morning and back, never reaching 75
+    tr = @t.noon_jd(@jd, 5.0, 100.0)
+    first = @t.azimuth_time(@jd, 5.0, 100.0, 68.5)
+    assert_in_delta(68.5, @t.azimuth(first, 5.0, 100.0), 1e-6)
+    assert_operator(first, :<, tr - 0.25)
+    assert_operator(@t.azimuth(first + 0.05, 5.0, 100.0), :>, 68.5)
+    assert_nil(@t.azimuth_time(@jd, 5.0, 100.0, 75.0))
+  end
+
+  def test_max_altitude
+    SITES.each do |lat, lon|
+      t, alt = @t.max_altitude(@jd, lat, lon)
+      assert_in_delta(@t.altitude(t, lat, lon), alt, 1e-9)
+      assert_in_delta(@t.noon_jd(@jd, lat, lon), t, 10.0 / 1440)
+      [-1e-3, 1e-3].each do |e|
+        assert_operator(@t.altitude(t + e, lat, lon), :<, alt)
+      end
+    end
+  end
+
+  def test_batch_matches_single
+    ajds = (0...20).map { |i| @jd + i * 7 }
+    lats = (0...20).map { |i| -60.0 + i * 6.3 }
+    lons = (0...20).map { |i| -170.0 + i * 17.0 }
+    up = @t.altitude_time_batch(ajds.pack('d*'), lats, lons, 5.0).to_a[0]
+    down = @t.altitude_time_batch(ajds, lats, lons, 5.0, :setting).to_a[0]
+    az = @t.azimuth_time_batch(ajds, lats, lons, 135.0).to_a[0]
+    peak = @t.max_altitude_batch(ajds, lats, lons).to_a
+    ajds.each_index do |i|
+      [[up, @t.altitude_time(ajds[i], lats[i], lons[i], 5.0)],
+       [down, @t.altitude_time(ajds[i], lats[i], lons[i], 5.0, :setting)],
+       [az, @t.azimuth_time(ajds[i], lats[i], lons[i], 135.0)]].each do |col, one|
+        assert_equal(one, col[i])
+      end
+      assert_equal(@t.max_altitude(ajds[i], lats[i], lons[i]), [peak[0][i], peak[1][i]])
+    end
+    # one site over many days
+    days = @t.max_altitude_batch(ajds, 51.5, -0.1)
+    assert_equal([2, 20], days.shape)
+  end
+
+  def test_legacy
+    t = CalcSun.new
+    up = t.altitude_time(@jd, 51.5, -0.1, 10.0)
+    assert_in_delta(10.0, t.altitude(up, 51.5, -0.1), 1e-3)
+    assert_in_delta(@t.altitude_time(@jd, 51.5, -0.1, 10.0), up, 1e-5)
+  end
+end
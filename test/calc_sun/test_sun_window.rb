@@ -0,0 +1,110 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+
+# doc
+class TestSunWindow < Test::Unit::TestCase # MiniTest::Test
+  SITES = [[51.5, -0.1], [69.6, 18.9], [-33.9, 151.2]].freeze
+
+  def setup
+    @t = CalcSun.new(:raw)
+    @jd = 2_460_494.5 # 2024-07-01 00:00 UT
+  end
+
+  # spans by sampling every 30 seconds
+  def sampled(lat, lon, days, alt, az = nil)
+    spans = []
+    from = nil
+    (0..days * 2880).each do |i|
+      ajd = @jd + i / 2880.0
+      z = @t.azimuth(ajd, lat, lon)
+      ok = @t.altitude(ajd, lat, lon) >= alt &&
+           (az.nil? || (az.first <= az.last ? z.between?(az.first, az.last) : z >= az.first || z <= az.last))
+      if ok && !from
+        from = ajd
+      elsif !ok && from
+        spans << [from, ajd]
+        from = nil
+      end
+    end
+    spans << [from, @jd + days] if from
+    spans
+  end
+
+  def assert_spans(expected, got)
+    assert_equal(expected.size, got.size)
+    expected.zip(got).each do |(a, b), (c, d)|
+      assert_in_delta(a, c, 1.0 / 2880)
+      assert_in_delta(b, d, 1.0 / 2880)
+    end
+  end
+
+  def test_altitude
+    got = @t.sun_intervals(SITES, @jd..@jd + 3, 10.0)
+    assert_equal(3, got.size)
+    SITES.each_with_index do |(lat, lon), k|
+      assert_spans(sampled(lat, lon, 3, 10.0), got[k])
+    end
+    from, to = got[0][0]
+    assert_in_delta(10.0, @t.altitude(from, 51.5, -0.1), 1e-4)
+    assert_in_delta(10.0, @t.altitude(to, 51.5, -0.1), 1e-4)
+  end
+
+  def test_azimuth_window
+    got = @t.sun_intervals(SITES, @jd..@jd + 2, 5.0, 300..60)
+    SITES.each_with_index do |(lat, lon), k|
+      assert_spans(sampled(lat, lon, 2, 5.0, 300..60), got[k])
+    end
+    got = @t.sun_intervals([SITES[0]], @jd..@jd + 2, 20.0, 90..180)
+    assert_spans(sampled(51.5, -0.1, 2, 20.0, 90..180), got[0])
+  end
+
+  def test_polar_day_merged
+    got = @t.sun_intervals([[69.6, 18.9]], @jd..@jd + 5, -6.0)
+    assert_equal([[@jd, @jd + 5]], got[0])
+    assert_equal([[]], @t.sun_intervals([[69.6, 18.9]], @jd + 180..@jd + 185, 0.0))
+  end
+
+  def test_transit_not_missed
+    # the noon peak tops 59.5 degrees for minutes only
+    got = @t.sun_intervals([SITES[0]], @jd..@jd + 30, 59.5, nil, 1.0)
+    fine = @t.sun_intervals([SITES[0]], @jd..@jd + 30, 59.5)
+    assert_operator(got[0].size, :>, 0)
+    assert_spans(fine[0], got[0])
+  end
+
+  def test_transits_minutes_apart
+    # on the date line noon_jd of 2460473 and 2460474 fall
+    # minutes apart, with a peak the day before between them
+    year = 2_460_311.0..2_460_676.0
+    got = @t.sun_intervals([[10.0, 180.0]], year, 20.0, nil, 1.0)
+    assert_equal(365, got[0].size)
+    assert_spans(@t.sun_intervals([[10.0, 180.0]], year, 20.0)[0], got[0])
+  end
+
+  def test_trapped_signal_goes_on
+    omit('no SIGUSR1') unless Signal.list.key?('USR1')
+    sites = SITES * 10
+    want = @t.sun_intervals(sites, @jd..@jd + 30, 10.0)
+    old = trap('USR1') {}
+    done = false
+    kill = Thread.new { (Process.kill('USR1', Process.pid); sleep 0.002) until done }
+    assert_equal(want, @t.sun_intervals(sites, @jd..@jd + 30, 10.0))
+  ensure
+    done = true
+    kill.join if kill
+    trap('USR1', old) if old
+  end
+
+  def test_errors
+    assert_raise(TypeError) { @t.sun_intervals(SITES, @jd, 0.0) }
+    assert_raise(ArgumentError) { @t.sun_intervals(SITES, @jd + 1..@jd, 0.0) }
+    assert_raise(ArgumentError) { @t.sun_intervals(SITES, @jd..@jd + 1, 0.0, nil, 0.0) }
+    assert_raise(ArgumentError) { @t.sun_intervals([[1.0]], @jd..@jd + 1, 0.0) }
+  end
+end
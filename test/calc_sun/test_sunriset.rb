@@ -0,0 +1,67 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+
+# doc
+class TestSunriset < Test::Unit::TestCase # MiniTest::Test
+  def setup
+    @t = CalcSun.new(:raw)
+    @lat = 39.742476
+    @lon = -105.1786
+    @jd = 2_452_930 # 2003-10-17
+  end
+
+  # hours apart on the 24 hour clock
+  def hours_off(h, ajd, start)
+    ((h - (ajd - start) * 24 + 12) % 24 - 12).abs
+  end
+
+  def test_rise_set_against_spa
+    # the chain's day of an ajd starts at the midnight before its noon
+    ajds = (0...30).map { |i| @jd + i * 12 }
+    rises, transits, sets, lens = @t.sunriset_rise_set(ajds, @lat, @lon)
+    ajds.each_with_index do |ajd, i|
+      r, t, s = @t.spa_rts_table(ajd, 1, @lat, @lon)[0]
+      assert_operator(hours_off(r, rises[i], ajd - 0.5), :<, 150.0 / 3600)
+      assert_operator(hours_off(t, transits[i], ajd - 0.5), :<, 30.0 / 3600)
+      assert_operator(hours_off(s, sets[i], ajd - 0.5), :<, 150.0 / 3600)
+      assert_in_delta((sets[i] - rises[i]) * 24, lens[i], 0.01)
+    end
+  end
+
+  def test_polar_and_twilight
+    ajd = 2_457_560.0 # 2016-06-20
+    rises, _t, sets, lens = @t.sunriset_rise_set([ajd, ajd], [80.0, -80.0], 0.0)
+    assert_equal([nil, nil], rises)
+    assert_equal([nil, nil], sets)
+    assert_equal([24.0, 0.0], lens)
+    civil = @t.sunriset_rise_set([ajd], @lat, @lon, -6.0, false)
+    rise = @t.sunriset_rise_set([ajd], @lat, @lon)
+    assert_operator(civil[0][0], :<, rise[0][0])
+    assert_operator(civil[2][0], :>, rise[2][0])
+  end
+
+  def test_alt_az_against_spa
+    ajds = (0...200).map { |i| 2_415_020.5 + i * 365.13 + i * 0.0417 }
+    lats = (0...200).map { |i| -60.0 + (i * 37 % 121) }
+    lons = (0...200).map { |i| -180.0 + (i * 53 % 360) }
+    alts, azs = @t.sunriset_alt_az(ajds, lats, lons)
+    ajds.each_with_index do |ajd, i|
+      e0, az = @t.spa_alt_az(ajd, [lats[i]], [lons[i]])
+      assert_in_delta(e0[0], alts[i], 0.03)
+      next if e0[0].abs > 80.0
+      d = (az[0] - azs[i]).abs
+      assert_operator([d, 360.0 - d].min, :<, 0.1)
+    end
+  end
+
+  def test_length_mismatch
+    assert_raise(ArgumentError) { @t.sunriset_alt_az([@jd], [0.0, 1.0], 0.0) }
+    assert_equal([[], [], [], []], @t.sunriset_rise_set([], 0.0, 0.0))
+  end
+end
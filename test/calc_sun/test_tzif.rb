@@ -0,0 +1,108 @@
+require 'rubygems'
+# gem 'minitest'
+# require 'minitest/autorun'
+
+require 'test/unit'
+lib = File.expand_path('../../../lib', __FILE__)
+$LOAD_PATH.unshift(lib) unless $LOAD_PATH.include?(lib)
+require 'calc_sun'
+
+require 'date'
+require 'tempfile'
+# doc
+class TestTzif < Test::Unit::TestCase # MiniTest::Test
+  ZONEINFO = ENV['TZDIR'] || '/usr/share/zoneinfo'
+
+  def setup
+    omit('no zoneinfo') unless File.exist?(File.join(ZONEINFO, 'America/Chicago'))
+    @t = CalcSun.new
+    @chi = CalcSun::Zone['America/Chicago']
+  end
+
+  def ajd(y, m, d, h = 0, mi = 0)
+    DateTime.new(y, m, d, h, mi).ajd.to_f
+  end
+
+  def test_offsets
+    assert_equal(-21_600, @chi.utc_offset(ajd(2024, 1, 15)))
+    assert_equal(-18_000, @chi.utc_offset(ajd(2024, 7, 15)))
+    # 2024-03-10 02:00 CST is 08:00 UT
+    assert_equal(-21_600, @chi.utc_offset(ajd(2024, 3, 10, 7, 59)))
+    assert_equal(-18_000, @chi.utc_offset(ajd(2024, 3, 10, 8, 0)))
+    assert(@chi.dst?(ajd(2024, 7, 15)))
+    assert(!@chi.dst?(ajd(2024, 1, 15)))
+    assert_equal('CDT', @chi.abbreviation(ajd(2024, 7, 15)))
+    assert_equal('CST', @chi.abbreviation(ajd(2024, 1, 15)))
+    # beyond the transitions, from the footer rule
+    assert_equal(-18_000, @chi.utc_offset(ajd(2300, 7, 15)))
+    syd = CalcSun::Zone['Australia/Sydney']
+    assert_equal(39_600, syd.utc_offset(ajd(2024, 1, 15)))
+    assert_equal(36_000, syd.utc_offset(ajd(2024, 7, 15)))
+  end
+
+  def test_batch_matches_scalar
+    ajds = (0...2000).map { |i| 2_451_545.0 + i * 3.7 }
+    assert_equal(ajds.map { |a| @chi.utc_offset(a) }, @chi.utc_offset(ajds))
+    assert_equal(ajds.map { |a| @chi.local(a) }, @chi.local(ajds))
+    shuffled = ajds.shuffle(random: Random.new(3))
+    assert_equal(shuffled.map { |a| @chi.utc_offset(a) },
+                 @chi.utc_offset(shuffled))
+    assert_in_delta(ajd(2024, 7, 15, 7), @chi.local(ajd(2024, 7, 15, 12)),
+                    1e-9)
+  end
+
+  def test_day_start
+    jd = Date.new(2024, 3, 10).jd
+    assert_in_delta(ajd(2024, 3, 10, 6), @chi.day_start(jd), 1e-9)
+    assert_in_delta(ajd(2024, 3, 11, 5), @chi.day_start(jd + 1), 1e-9)
+    # Sao Paulo 2018-11-04 skipped midnight, the day began at 01:00
+    sp = CalcSun::Zone['America/Sao_Paulo']
+    assert_in_delta(ajd(2018, 11, 4, 3), sp.day_start(Date.new(2018, 11, 4).jd),
+                    1e-9)
+  end
+
+  def test_local_day_table
+    jd = Date.new(2024, 3, 9).jd
+    rows = @t.local_day_table(@chi, jd, 3, 41.95, -87.65)
+    assert_equal(3, rows.size)
+    rows.each_with_index do |(d, rise, noon, set), i|
+      assert_equal(jd + i, d)
+      [rise, noon, set].each do |t|
+        assert(t >= d - 0.5 && t < d + 0.5, 'event outside its local date')
+      end
+      assert(rise < noon && noon < set)
+    end
+    # clocks went forward, noon an hour later on the wall
+    assert_in_delta(2 + 1.0 / 24, rows[2][2] - rows[0][2], 0.002)
+    ut = @t.rise_jd(Date.new(2024, 7, 1).jd, 41.95, -87.65)
+    row = @t.local_day_table(@chi, Date.new(2024, 7, 1).jd, 1, 41.95, -87.65)
+    assert_in_delta(ut - 5.0 / 24, row[0][1], 1e-9)
+  end
+
+  def test_local_day_table_polar
+    oslo = CalcSun::Zone['Europe/Oslo']
+    row = @t.local_day_table(oslo, Date.new(2024, 6, 21).jd, 1, 78.2, 15.6)
+    assert_nil(row[0][1])
+    assert_nil(row[0][3])
+    assert_not_nil(row[0][2])
+  end
+
+  def test_cache
+    assert_same(@chi, CalcSun::Zone['America/Chicago'])
+    assert_equal('America/Chicago', @chi.name)
+    assert_not_same(@chi, CalcSun::Zone.new('America/Chicago'))
+  end
+
+  def test_errors
+    assert_raise(Errno::ENOENT) { CalcSun::Zone.new('No/Such_Zone') }
+    assert_raise(ArgumentError) { CalcSun::Zone.new('../etc/passwd') }
+    Tempfile.open('tz') do |f|
+      f.write('not a zone')
+      f.flush
+      assert_raise(ArgumentError) { CalcSun::Zone.new(f.path) }
+    end
+    assert_raise(TypeError) do
+      @t.local_day_table(Object.new, 2_451_545, 1, 0, 0)
+    end
+  end
+end
@@ -103,3 +103,44 @@ class TestSideTime < Test::Unit::TestCase
     )
   end
 end
+#
+class TestSideTimeBatch < Test::Unit::TestCase
+  def setup
+    @v = CalcSun.new
+    @t = SideTime.new
+    @t_ajd = 2_452_930.312847222
+    @t_lon = -105.1786
+    @ajds = Array.new(10) { |i| @t_ajd + i * 0.37 }
+  end
+
+  def test_gmst_ajd
+    assert_equal(
+      21.234372837376,
+      @t.gmst(@t_ajd)
+    )
+  end
+
+  def test_gmst_batch
+    @t.gmst_batch(@ajds).zip(@ajds).each do |g, ajd|
+      assert_in_delta(@t.gmst(ajd), g, 1e-5)
+    end
+    assert_equal(@t.gmst_batch(@ajds), @v.gmst_batch(@ajds))
+  end
+
+  def test_lmst_batch
+    lmst = @t.lmst_batch(@ajds, @t_lon)
+    lmst.zip(@t.gmst_batch(@ajds)).each do |l, g|
+      assert_in_delta((g + @t_lon / 15.0) % 24.0, l, 1e-9)
+    end
+    assert_equal(lmst, @v.lmst_batch(@ajds, [@t_lon] * @ajds.size))
+  end
+
+  def test_gmst_steps
+    step = 1.0 / 86_400.0
+    ajds = Array.new(1000) { |i| @t_ajd + i * step }
+    # the ajd Floats themselves only resolve about 40 microseconds
+    @t.gmst_steps(@t_ajd, step, 1000).zip(@t.gmst_batch(ajds)).each do |s, g|
+      assert_in_delta(g, s, 2e-8)
+    end
+  end
+end